@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/indentation.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/byte_stream.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/nxoc_parser.hpp>
+
+#include <array>
+#include <vector>
+
+namespace inexor::vulkan_renderer {
+
+namespace {
+
+/// The indentations of the given number of cubes with varying uids.
+std::vector<octree::Indentation> create_indentations(const std::size_t cube_count) {
+    std::vector<octree::Indentation> indentations;
+    indentations.reserve(cube_count * octree::Cube::EDGES);
+    for (std::size_t idx = 0; idx < cube_count * octree::Cube::EDGES; idx++) {
+        indentations.emplace_back(static_cast<std::uint8_t>((idx * 7) % octree::Indentation::UID_COUNT));
+    }
+    return indentations;
+}
+
+/// A world in which every leaf on the given depth is a Type::NORMAL cube.
+std::shared_ptr<octree::Cube> create_indented_world(const std::size_t depth) {
+    auto world = std::make_shared<octree::Cube>();
+    std::vector<std::shared_ptr<octree::Cube>> level{world};
+    for (std::size_t current = 0; current < depth; current++) {
+        std::vector<std::shared_ptr<octree::Cube>> next;
+        for (const auto &cube : level) {
+            cube->set_type(octree::Cube::Type::OCTANT);
+            next.insert(next.end(), cube->children().begin(), cube->children().end());
+        }
+        level = std::move(next);
+    }
+    std::uint8_t uid = 0;
+    for (const auto &cube : level) {
+        cube->set_type(octree::Cube::Type::NORMAL);
+        for (std::size_t edge = 0; edge < octree::Cube::EDGES; edge++) {
+            cube->set_indent(static_cast<std::uint8_t>(edge), octree::Indentation(uid));
+            uid = static_cast<std::uint8_t>((uid + 7) % octree::Indentation::UID_COUNT);
+        }
+    }
+    return world;
+}
+
+} // namespace
+
+/// Decode the indentations of many cubes one cube at a time.
+void IndentationDecodePerCube(benchmark::State &state) {
+    const auto cube_count = static_cast<std::size_t>(state.range(0));
+    serialization::ByteStreamWriter writer;
+    writer.write_indentations(create_indentations(cube_count));
+    for (auto _ : state) {
+        serialization::ByteStreamReader reader(writer);
+        for (std::size_t cube = 0; cube < cube_count; cube++) {
+            benchmark::DoNotOptimize(reader.read<std::array<octree::Indentation, octree::Cube::EDGES>>());
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * cube_count));
+}
+
+/// Decode the indentations of many cubes at once.
+void IndentationDecodeBulk(benchmark::State &state) {
+    const auto cube_count = static_cast<std::size_t>(state.range(0));
+    serialization::ByteStreamWriter writer;
+    writer.write_indentations(create_indentations(cube_count));
+    std::vector<octree::Indentation> indentations(cube_count * octree::Cube::EDGES);
+    for (auto _ : state) {
+        serialization::ByteStreamReader reader(writer);
+        reader.read_indentations(indentations);
+        benchmark::DoNotOptimize(indentations.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * cube_count));
+}
+
+/// Encode the indentations of many cubes at once.
+void IndentationEncodeBulk(benchmark::State &state) {
+    const auto cube_count = static_cast<std::size_t>(state.range(0));
+    const auto indentations = create_indentations(cube_count);
+    for (auto _ : state) {
+        serialization::ByteStreamWriter writer;
+        writer.write_indentations(indentations);
+        benchmark::DoNotOptimize(writer.data().data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * cube_count));
+}
+
+/// Decode a version 0 octree in which every leaf is a Type::NORMAL cube.
+void NXOCDecodeIndented(benchmark::State &state) {
+    const auto world = create_indented_world(static_cast<std::size_t>(state.range(0)));
+    serialization::NXOCParser parser;
+    const auto stream = parser.serialize(world, 0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.deserialize(stream));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * stream.size()));
+}
+
+BENCHMARK(IndentationDecodePerCube)->Arg(100000);
+BENCHMARK(IndentationDecodeBulk)->Arg(100000);
+BENCHMARK(IndentationEncodeBulk)->Arg(100000);
+BENCHMARK(NXOCDecodeIndented)->DenseRange(3, 5)->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
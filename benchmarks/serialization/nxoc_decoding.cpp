@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/byte_stream.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/nxoc_parser.hpp>
+
+namespace inexor::vulkan_renderer {
+
+/// Decode a version 0 octree, which is always decoded on one thread.
+void NXOCDecodeV0(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    const auto stream = parser.serialize(world, 0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.deserialize(stream));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * stream.size()));
+}
+
+/// Decode a version 1 octree with the given number of threads.
+void NXOCDecodeV1(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser(static_cast<std::size_t>(state.range(1)));
+    const auto stream = parser.serialize(world, 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.deserialize(stream));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * stream.size()));
+}
+
+/// Decode a compressed version 2 octree, the counters compare its size to version 0.
+void NXOCDecodeV2(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    const auto stream = parser.serialize(world, 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.deserialize(stream));
+    }
+    state.counters["bytes"] = static_cast<double>(stream.size());
+    state.counters["v0_bytes"] = static_cast<double>(parser.serialize(world, 0).size());
+}
+
+/// Decode only the region around one corner of a version 1 octree.
+void NXOCDecodeV1Region(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    const auto stream = parser.serialize(world, 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.deserialize_region(stream, {0.0f, 0.0f, 0.0f}, 1.0f));
+    }
+}
+
+BENCHMARK(NXOCDecodeV0)->DenseRange(4, 6)->Unit(benchmark::kMillisecond);
+// A thread count of 0 uses all hardware threads.
+BENCHMARK(NXOCDecodeV1)->ArgsProduct({{4, 5, 6}, {1, 0}})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(NXOCDecodeV2)->DenseRange(4, 6)->Unit(benchmark::kMillisecond);
+BENCHMARK(NXOCDecodeV1Region)->DenseRange(4, 6)->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/byte_stream.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/nxoc_parser.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace inexor::vulkan_renderer {
+
+namespace {
+
+/// A sink which only counts the bytes, to measure the serialization without the file system.
+class CountingSink : public serialization::ByteSink {
+public:
+    std::size_t size{0};
+
+    void write(const std::span<const std::uint8_t> data) override {
+        size += data.size();
+    }
+};
+
+std::filesystem::path benchmark_file_path(const std::uint32_t max_depth) {
+    return std::filesystem::temp_directory_path() / ("inexor_benchmark_encoding_" + std::to_string(max_depth) + ".nxoc");
+}
+
+} // namespace
+
+/// Serialize a random world into memory.
+void NXOCEncodeMemory(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.serialize(world, 1));
+    }
+}
+
+/// Serialize a random world through the fixed size buffer of a sink.
+void NXOCEncodeSink(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    for (auto _ : state) {
+        CountingSink sink;
+        parser.serialize(world, 1, sink);
+        benchmark::DoNotOptimize(sink.size);
+    }
+}
+
+/// Serialize a random world into memory and write the whole buffer into a file.
+void NXOCSaveMemory(benchmark::State &state) {
+    const auto max_depth = static_cast<std::uint32_t>(state.range(0));
+    const auto world = octree::create_random_world(max_depth, {0.0f, 0.0f, 0.0f}, 42);
+    const auto path = benchmark_file_path(max_depth);
+    serialization::NXOCParser parser;
+    for (auto _ : state) {
+        const auto stream = parser.serialize(world, 1);
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(stream.data().data()), // NOLINT
+                   static_cast<std::streamsize>(stream.size()));
+    }
+    std::filesystem::remove(path);
+}
+
+/// Serialize a random world directly into a file.
+void NXOCSaveSink(benchmark::State &state) {
+    const auto max_depth = static_cast<std::uint32_t>(state.range(0));
+    const auto world = octree::create_random_world(max_depth, {0.0f, 0.0f, 0.0f}, 42);
+    const auto path = benchmark_file_path(max_depth);
+    serialization::NXOCParser parser;
+    for (auto _ : state) {
+        serialization::FileByteSink sink(path);
+        parser.serialize(world, 1, sink);
+    }
+    std::filesystem::remove(path);
+}
+
+/// Write a random world directly into a sink without building it first.
+void NXOCEncodeRandomWorld(benchmark::State &state) {
+    serialization::NXOCParser parser;
+    for (auto _ : state) {
+        CountingSink sink;
+        parser.serialize_random_world(static_cast<std::uint32_t>(state.range(0)), 42, 1, sink);
+        benchmark::DoNotOptimize(sink.size);
+    }
+}
+
+BENCHMARK(NXOCEncodeMemory)->DenseRange(3, 5)->Unit(benchmark::kMillisecond);
+BENCHMARK(NXOCEncodeSink)->DenseRange(3, 5)->Unit(benchmark::kMillisecond);
+BENCHMARK(NXOCSaveMemory)->DenseRange(3, 5)->Unit(benchmark::kMillisecond);
+BENCHMARK(NXOCSaveSink)->DenseRange(3, 5)->Unit(benchmark::kMillisecond);
+BENCHMARK(NXOCEncodeRandomWorld)->Arg(5)->Arg(7)->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/byte_stream.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/nxoc_parser.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace inexor::vulkan_renderer {
+
+namespace {
+
+/// Write bytes to a file in the temporary directory.
+std::filesystem::path write_temporary_file(const std::string &name, const std::span<const std::uint8_t> data) {
+    const auto path = std::filesystem::temp_directory_path() / name;
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size())); // NOLINT
+    return path;
+}
+
+/// Serialize a random world into a file.
+std::filesystem::path write_world_file(const std::uint32_t max_depth) {
+    serialization::NXOCParser parser;
+    const auto stream = parser.serialize(octree::create_random_world(max_depth, {0.0f, 0.0f, 0.0f}, 42), 0);
+    return write_temporary_file("inexor_benchmark_world_" + std::to_string(max_depth) + ".nxoc", stream.data());
+}
+
+/// Write a file of the given size in megabytes. The content does not matter, as the file is only read byte by byte.
+std::filesystem::path write_filler_file(const std::size_t megabytes) {
+    std::vector<std::uint8_t> data(megabytes * 1024 * 1024);
+    for (std::size_t idx = 0; idx < data.size(); idx++) {
+        data[idx] = static_cast<std::uint8_t>(idx * 31);
+    }
+    return write_temporary_file("inexor_benchmark_filler_" + std::to_string(megabytes) + ".bin", data);
+}
+
+/// Read a file like ByteStream did before it used memory mapping.
+serialization::ByteStream read_file_copy(const std::filesystem::path &path) {
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    return serialization::ByteStream(
+        std::vector<std::uint8_t>{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()});
+}
+
+/// Read every byte of a stream through ByteStreamReader.
+std::uint32_t read_all_bytes(const serialization::ByteStream &stream) {
+    serialization::ByteStreamReader reader(stream);
+    std::uint32_t sum = 0;
+    while (reader.remaining() > 0) {
+        sum += reader.read<std::uint8_t>();
+    }
+    return sum;
+}
+
+} // namespace
+
+/// Load a file into a vector and read all bytes of it.
+void FileReadCopy(benchmark::State &state) {
+    const auto path = write_filler_file(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(read_all_bytes(read_file_copy(path)));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * std::filesystem::file_size(path)));
+    std::filesystem::remove(path);
+}
+
+/// Map a file into memory and read all bytes of it.
+void FileReadMapped(benchmark::State &state) {
+    const auto path = write_filler_file(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(read_all_bytes(serialization::ByteStream(path)));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * std::filesystem::file_size(path)));
+    std::filesystem::remove(path);
+}
+
+/// Load an octree file into a vector and deserialize it.
+void NXOCLoadCopy(benchmark::State &state) {
+    const auto path = write_world_file(static_cast<std::uint32_t>(state.range(0)));
+    serialization::NXOCParser parser;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.deserialize(read_file_copy(path)));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * std::filesystem::file_size(path)));
+    std::filesystem::remove(path);
+}
+
+/// Map an octree file into memory and deserialize it.
+void NXOCLoadMapped(benchmark::State &state) {
+    const auto path = write_world_file(static_cast<std::uint32_t>(state.range(0)));
+    serialization::NXOCParser parser;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.deserialize(serialization::ByteStream(path)));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * std::filesystem::file_size(path)));
+    std::filesystem::remove(path);
+}
+
+// The file sizes are given in megabytes. Deserializing maps of that size would need many gigabytes for the cubes, so
+// the whole octree is only deserialized for smaller worlds.
+BENCHMARK(FileReadCopy)->Arg(10)->Arg(50)->Arg(100)->Arg(500)->Unit(benchmark::kMillisecond);
+BENCHMARK(FileReadMapped)->Arg(10)->Arg(50)->Arg(100)->Arg(500)->Unit(benchmark::kMillisecond);
+BENCHMARK(NXOCLoadCopy)->DenseRange(4, 5)->Unit(benchmark::kMillisecond);
+BENCHMARK(NXOCLoadMapped)->DenseRange(4, 5)->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/collision_query.hpp>
+#include <inexor/vulkan-renderer/octree/compact_octree.hpp>
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+
+#include <functional>
+
+namespace inexor::vulkan_renderer {
+
+namespace {
+
+/// Estimate the heap memory of a cube tree: the cube, the control block of std::make_shared and the polygon cache.
+std::size_t estimate_memory_usage(const octree::Cube &root) {
+    std::size_t bytes = 0;
+    std::function<void(const octree::Cube &)> walk = [&](const octree::Cube &cube) {
+        bytes += sizeof(octree::Cube) + 2 * sizeof(long);
+        if (cube.type() == octree::Cube::Type::OCTANT) {
+            for (const auto &child : cube.children()) {
+                walk(*child);
+            }
+        }
+    };
+    walk(root);
+    // Every geometry cube holds a vector of 12 polygons in its own control block.
+    bytes += root.count_geometry_cubes() *
+             (sizeof(std::vector<octree::Polygon>) + 2 * sizeof(long) + octree::Cube::EDGES * sizeof(octree::Polygon));
+    return bytes;
+}
+
+} // namespace
+
+void CubeCountGeometry(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(world->count_geometry_cubes());
+    }
+    state.counters["bytes"] = static_cast<double>(estimate_memory_usage(*world));
+}
+
+void CompactOctreeCountGeometry(benchmark::State &state) {
+    const auto cubes = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const octree::CompactOctree world(*cubes);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(world.count_geometry_cubes());
+    }
+    state.counters["bytes"] = static_cast<double>(world.memory_usage());
+}
+
+void CubePolygons(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    // Make sure all polygon caches are valid, so only the traversal and the copy into one array are measured.
+    benchmark::DoNotOptimize(world->polygons(true));
+    std::vector<octree::Polygon> polygons;
+    polygons.reserve(world->count_geometry_cubes() * octree::Cube::EDGES);
+    for (auto _ : state) {
+        polygons.clear();
+        for (const auto &polygon_cache : world->polygons()) {
+            polygons.insert(polygons.end(), polygon_cache->begin(), polygon_cache->end());
+        }
+        benchmark::DoNotOptimize(polygons.data());
+    }
+}
+
+void CompactOctreePolygons(benchmark::State &state) {
+    const auto cubes = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const octree::CompactOctree world(*cubes);
+    std::vector<octree::Polygon> polygons;
+    polygons.reserve(world.count_geometry_cubes() * octree::Cube::EDGES);
+    for (auto _ : state) {
+        polygons.clear();
+        world.polygons(polygons);
+        benchmark::DoNotOptimize(polygons.data());
+    }
+}
+
+void CubeCollisionDeep(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const glm::vec3 cam_pos{-1.0f, 1.1f, 1.3f};
+    const glm::vec3 cam_direction{1.0f, 0.1f, 0.2f};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ray_cube_collision_check(*world, cam_pos, cam_direction));
+    }
+}
+
+void CompactOctreeCollision(benchmark::State &state) {
+    const auto cubes = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const octree::CompactOctree world(*cubes);
+    const glm::vec3 cam_pos{-1.0f, 1.1f, 1.3f};
+    const glm::vec3 cam_direction{1.0f, 0.1f, 0.2f};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ray_cube_collision_check(world, cam_pos, cam_direction));
+    }
+}
+
+BENCHMARK(CubeCountGeometry)->DenseRange(4, 6)->Unit(benchmark::kMillisecond);
+BENCHMARK(CompactOctreeCountGeometry)->DenseRange(4, 6)->Unit(benchmark::kMillisecond);
+BENCHMARK(CubePolygons)->DenseRange(4, 6)->Unit(benchmark::kMillisecond);
+BENCHMARK(CompactOctreePolygons)->DenseRange(4, 6)->Unit(benchmark::kMillisecond);
+BENCHMARK(CubeCollisionDeep)->DenseRange(4, 6)->Unit(benchmark::kMicrosecond);
+BENCHMARK(CompactOctreeCollision)->DenseRange(4, 6)->Unit(benchmark::kMicrosecond);
+
+} // namespace inexor::vulkan_renderer
@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+
+namespace inexor::vulkan_renderer {
+
+/// Clone a random world with up to date polygon caches, the argument is the depth of the world.
+void CubeClone(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    static_cast<void>(world->polygons(true));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(world->clone());
+    }
+}
+
+/// Rotate a random world by 90 degrees around an axis, the argument is the depth of the world.
+void CubeRotate(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    for (auto _ : state) {
+        world->rotate(octree::Cube::RotationAxis::Y, 1);
+    }
+    static_cast<void>(world->take_dirty_cubes());
+}
+
+BENCHMARK(CubeClone)->Arg(5)->Unit(benchmark::kMillisecond);
+BENCHMARK(CubeRotate)->Arg(5)->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
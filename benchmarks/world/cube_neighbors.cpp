@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+
+#include <array>
+#include <functional>
+#include <vector>
+
+namespace inexor::vulkan_renderer {
+
+namespace {
+
+/// Collect the leaves of a world in depth first order.
+std::vector<octree::Cube *> collect_leaves(const octree::Cube &world) {
+    std::vector<octree::Cube *> leaves;
+    std::function<void(const octree::Cube &)> walk = [&](const octree::Cube &cube) {
+        for (const auto &child : cube.children()) {
+            if (child->type() == octree::Cube::Type::OCTANT) {
+                walk(*child);
+            } else {
+                leaves.push_back(child.get());
+            }
+        }
+    };
+    walk(world);
+    return leaves;
+}
+
+constexpr std::array<octree::Cube::NeighborAxis, 3> AXES{octree::Cube::NeighborAxis::X, octree::Cube::NeighborAxis::Y,
+                                                         octree::Cube::NeighborAxis::Z};
+constexpr std::array<octree::Cube::NeighborDirection, 2> DIRECTIONS{octree::Cube::NeighborDirection::POSITIVE,
+                                                                    octree::Cube::NeighborDirection::NEGATIVE};
+
+} // namespace
+
+/// Get all 6 face neighbors of every leaf of a random world, the argument is the depth of the world.
+void CubeNeighbors(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const auto leaves = collect_leaves(*world);
+    for (auto _ : state) {
+        for (auto *leaf : leaves) {
+            for (const auto axis : AXES) {
+                for (const auto direction : DIRECTIONS) {
+                    benchmark::DoNotOptimize(leaf->neighbor(axis, direction));
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * leaves.size() * 6));
+}
+
+/// Same as CubeNeighbors, but without taking a reference to the neighbors.
+void CubeFindNeighbors(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const auto leaves = collect_leaves(*world);
+    for (auto _ : state) {
+        for (const auto *leaf : leaves) {
+            for (const auto axis : AXES) {
+                for (const auto direction : DIRECTIONS) {
+                    benchmark::DoNotOptimize(leaf->find_neighbor(axis, direction));
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * leaves.size() * 6));
+}
+
+BENCHMARK(CubeNeighbors)->Arg(6)->Unit(benchmark::kMillisecond);
+BENCHMARK(CubeFindNeighbors)->Arg(6)->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+
+namespace inexor::vulkan_renderer {
+
+namespace {
+
+void invalidate_all(const octree::Cube &cube) {
+    cube.invalidate_polygon_cache();
+    if (cube.type() == octree::Cube::Type::OCTANT) {
+        for (const auto &child : cube.children()) {
+            invalidate_all(*child);
+        }
+    }
+}
+
+} // namespace
+
+void CubePolygonRebuild(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    for (auto _ : state) {
+        state.PauseTiming();
+        invalidate_all(*world);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(world->polygons(true));
+    }
+}
+
+void CubeParallelPolygonRebuild(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    for (auto _ : state) {
+        state.PauseTiming();
+        invalidate_all(*world);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(world->parallel_polygons(true, 2, static_cast<std::size_t>(state.range(1))));
+    }
+}
+
+/// Edit a single cube and collect all polygons of the world again.
+void CubeEditFullUpdate(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    benchmark::DoNotOptimize(world->polygons(true));
+    auto cube = world;
+    while (cube->type() == octree::Cube::Type::OCTANT) {
+        cube = cube->children()[3];
+    }
+    for (auto _ : state) {
+        cube->set_type(cube->type() == octree::Cube::Type::SOLID ? octree::Cube::Type::EMPTY
+                                                                  : octree::Cube::Type::SOLID);
+        benchmark::DoNotOptimize(world->polygons(true));
+    }
+}
+
+/// Edit a single cube and only collect the polygons of the changed cubes.
+void CubeEditIncrementalUpdate(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    benchmark::DoNotOptimize(world->take_dirty_cubes());
+    auto cube = world;
+    while (cube->type() == octree::Cube::Type::OCTANT) {
+        cube = cube->children()[3];
+    }
+    for (auto _ : state) {
+        cube->set_type(cube->type() == octree::Cube::Type::SOLID ? octree::Cube::Type::EMPTY
+                                                                  : octree::Cube::Type::SOLID);
+        for (const auto &dirty_cube : world->take_dirty_cubes()) {
+            benchmark::DoNotOptimize(dirty_cube->polygons(true));
+        }
+    }
+}
+
+BENCHMARK(CubePolygonRebuild)->DenseRange(5, 6)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(CubeParallelPolygonRebuild)
+    ->ArgsProduct({{5, 6}, benchmark::CreateRange(1, 16, 2)})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(CubeEditFullUpdate)->DenseRange(5, 6)->Unit(benchmark::kMicrosecond);
+BENCHMARK(CubeEditIncrementalUpdate)->DenseRange(5, 6)->Unit(benchmark::kMicrosecond);
+
+} // namespace inexor::vulkan_renderer
@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/chunk_manager.hpp>
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/tools/frustum.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace inexor::vulkan_renderer {
+
+/// Cull the chunks of a world from a camera in its center, which looks along the x axis. The argument is the chunk
+/// level.
+void FrustumCulling(benchmark::State &state) {
+    const auto world = octree::create_random_world(5, {0.0f, 0.0f, 0.0f}, 42);
+    octree::ChunkManager manager({world}, {.chunk_level = static_cast<std::size_t>(state.range(0)),
+                                           .slot_count = 4096,
+                                           .max_loads_per_update = 4096});
+    const glm::vec3 camera_position = world->center();
+    static_cast<void>(manager.update(camera_position));
+    const tools::Frustum frustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+                                 glm::lookAt(camera_position, camera_position + glm::vec3(1.0f, 0.0f, 0.0f),
+                                             glm::vec3(0.0f, 1.0f, 0.0f)));
+    octree::CullingResult result;
+    for (auto _ : state) {
+        result = manager.cull(frustum);
+        benchmark::DoNotOptimize(result.draw_ranges.data());
+    }
+    state.counters["visible"] = static_cast<double>(result.visible_chunks);
+    state.counters["culled"] = static_cast<double>(result.culled_chunks);
+    state.counters["tested"] = static_cast<double>(result.tested_boxes);
+}
+
+BENCHMARK(FrustumCulling)->DenseRange(1, 4);
+
+} // namespace inexor::vulkan_renderer
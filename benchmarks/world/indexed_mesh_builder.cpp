@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/indexed_mesh_builder.hpp>
+#include <inexor/vulkan-renderer/octree/mesh_extraction.hpp>
+
+#include <glm/gtx/hash.hpp>
+
+#include <unordered_map>
+
+namespace inexor::vulkan_renderer {
+
+/// Deduplicate the vertices of all polygons with std::unordered_map, like the example app did before.
+void UnorderedMapIndexing(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const auto polygons = octree::extract_mesh(*world, {.cull_hidden_faces = false}).polygons;
+    for (auto _ : state) {
+        std::vector<glm::vec3> vertices;
+        std::vector<std::uint32_t> indices;
+        std::unordered_map<glm::vec3, std::uint32_t> vertex_map;
+        for (const auto &polygon : polygons) {
+            for (const auto &vertex : polygon) {
+                if (vertex_map.count(vertex) == 0) {
+                    vertex_map.emplace(vertex, static_cast<std::uint32_t>(vertex_map.size()));
+                    vertices.push_back(vertex);
+                }
+                indices.push_back(vertex_map.at(vertex));
+            }
+        }
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.counters["vertices"] = static_cast<double>(polygons.size() * 3);
+}
+
+/// Deduplicate the vertices of all polygons with IndexedMeshBuilder.
+void IndexedMeshBuilderPolygons(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const auto polygons = octree::extract_mesh(*world, {.cull_hidden_faces = false}).polygons;
+    for (auto _ : state) {
+        octree::IndexedMeshBuilder builder;
+        for (const auto &polygon : polygons) {
+            builder.add_triangle(polygon);
+        }
+        benchmark::DoNotOptimize(builder.build());
+    }
+    state.counters["vertices"] = static_cast<double>(polygons.size() * 3);
+}
+
+/// Extract the indexed mesh directly from the octree.
+void IndexedMeshExtraction(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    octree::IndexedMeshBuilder builder;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(octree::extract_mesh(*world, builder, {.cull_hidden_faces = false}));
+        benchmark::DoNotOptimize(builder.build());
+    }
+}
+
+BENCHMARK(UnorderedMapIndexing)->DenseRange(4, 5)->Unit(benchmark::kMillisecond);
+BENCHMARK(IndexedMeshBuilderPolygons)->DenseRange(4, 5)->Unit(benchmark::kMillisecond);
+BENCHMARK(IndexedMeshExtraction)->DenseRange(4, 5)->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
@@ -0,0 +1,21 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/memory_statistics.hpp>
+
+namespace inexor::vulkan_renderer {
+
+/// Collect the memory statistics of a random world with up to date polygon caches, the argument is the depth of the
+/// world.
+void CollectMemoryStatistics(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    static_cast<void>(world->polygons(true));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(octree::collect_memory_statistics(*world));
+    }
+    state.counters["cubes"] = static_cast<double>(octree::collect_memory_statistics(*world).cubes());
+}
+
+BENCHMARK(CollectMemoryStatistics)->Arg(2)->Arg(5)->Unit(benchmark::kMicrosecond);
+
+} // namespace inexor::vulkan_renderer
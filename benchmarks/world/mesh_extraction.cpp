@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/mesh_extraction.hpp>
+
+#include <functional>
+
+namespace inexor::vulkan_renderer {
+
+void MeshExtraction(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const octree::MeshExtractionSettings settings{.cull_hidden_faces = state.range(1) != 0,
+                                                  .merge_coplanar_faces = state.range(2) != 0};
+    octree::MeshStatistics statistics;
+    for (auto _ : state) {
+        auto mesh = octree::extract_mesh(*world, settings);
+        statistics = mesh.statistics;
+        benchmark::DoNotOptimize(mesh.polygons.data());
+    }
+    state.counters["emitted"] = static_cast<double>(statistics.emitted_triangles);
+    state.counters["culled"] = static_cast<double>(statistics.culled_triangles);
+    state.counters["merged"] = static_cast<double>(statistics.merged_triangles);
+}
+
+/// A flat floor is the best case for merging faces.
+void MeshExtractionFloor(benchmark::State &state) {
+    const auto depth = static_cast<std::uint32_t>(state.range(0));
+    const auto world = std::make_shared<octree::Cube>(static_cast<float>(1u << depth), glm::vec3{0.0f, 0.0f, 0.0f});
+    // Subdivide the bottom layer down to cubes of size 1 and fill it.
+    std::function<void(const std::shared_ptr<octree::Cube> &, std::uint32_t)> fill_floor = [&](const auto &cube,
+                                                                                               const auto level) {
+        if (level == depth) {
+            cube->set_type(octree::Cube::Type::SOLID);
+            return;
+        }
+        cube->set_type(octree::Cube::Type::OCTANT);
+        for (const std::size_t idx : {0, 1, 4, 5}) {
+            fill_floor(cube->children()[idx], level + 1);
+        }
+    };
+    fill_floor(world, 0);
+
+    const octree::MeshExtractionSettings settings{.merge_coplanar_faces = state.range(1) != 0};
+    octree::MeshStatistics statistics;
+    for (auto _ : state) {
+        auto mesh = octree::extract_mesh(*world, settings);
+        statistics = mesh.statistics;
+        benchmark::DoNotOptimize(mesh.polygons.data());
+    }
+    state.counters["emitted"] = static_cast<double>(statistics.emitted_triangles);
+    state.counters["merged"] = static_cast<double>(statistics.merged_triangles);
+}
+
+/// Extract a world with the octants on a level collapsed, the arguments are the depth of the world and the level.
+void MeshExtractionLod(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    // Random worlds are less than half filled on average, so a lower fill ratio keeps some of their geometry.
+    const octree::MeshExtractionSettings settings{.max_depth = static_cast<std::size_t>(state.range(1)),
+                                                  .solid_fill_ratio = 0.25f};
+    octree::MeshStatistics statistics;
+    for (auto _ : state) {
+        auto mesh = octree::extract_mesh(*world, settings);
+        statistics = mesh.statistics;
+        benchmark::DoNotOptimize(mesh.polygons.data());
+    }
+    state.counters["emitted"] = static_cast<double>(statistics.emitted_triangles);
+    state.counters["collapsed"] = static_cast<double>(statistics.collapsed_octants);
+}
+
+BENCHMARK(MeshExtraction)->ArgsProduct({{4, 5}, {0, 1}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(MeshExtractionFloor)->ArgsProduct({{5, 7}, {0, 1}})->Unit(benchmark::kMillisecond);
+BENCHMARK(MeshExtractionLod)->ArgsProduct({{5}, {3, 4, 5}})->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
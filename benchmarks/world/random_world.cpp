@@ -0,0 +1,17 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+
+namespace inexor::vulkan_renderer {
+
+/// Build a random world, the argument is the maximum depth of the world.
+void CreateRandomWorld(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42));
+    }
+}
+
+BENCHMARK(CreateRandomWorld)->DenseRange(4, 6)->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
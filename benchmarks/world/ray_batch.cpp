@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/ray_query.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace inexor::vulkan_renderer {
+
+namespace {
+
+/// Rays from random points around the world towards random points in it, like the rays of light or audio probes.
+octree::RayBatch create_random_rays(const octree::Cube &world, const std::size_t count) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    auto random_offset = [&]() {
+        return glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+    };
+    octree::RayBatch rays;
+    rays.reserve(count);
+    for (std::size_t ray = 0; ray < count; ray++) {
+        const glm::vec3 origin = world.center() + random_offset() * world.size();
+        const glm::vec3 target = world.center() + random_offset() * (0.5f * world.size());
+        rays.add(origin, target - origin);
+    }
+    return rays;
+}
+
+/// A grid of rays from a camera outside of the world towards the world, like the rays of a picking or a visibility
+/// query.
+octree::RayBatch create_camera_rays(const octree::Cube &world, const std::size_t count) {
+    const glm::vec3 camera_position = world.position() - glm::vec3(0.5f * world.size(), -1.0f, 0.5f * world.size());
+    const auto resolution = static_cast<std::size_t>(std::sqrt(static_cast<double>(count)));
+    octree::RayBatch rays;
+    rays.reserve(resolution * resolution);
+    for (std::size_t y = 0; y < resolution; y++) {
+        for (std::size_t x = 0; x < resolution; x++) {
+            const glm::vec3 target =
+                world.position() + glm::vec3(static_cast<float>(x) + 0.5f, 0.5f * static_cast<float>(resolution),
+                                             static_cast<float>(y) + 0.5f) *
+                                       (world.size() / static_cast<float>(resolution));
+            rays.add(camera_position, target - camera_position);
+        }
+    }
+    return rays;
+}
+
+/// The rays of a benchmark, the second argument selects random rays (0) or camera rays (1).
+octree::RayBatch create_rays(const octree::Cube &world, const benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    return state.range(1) == 0 ? create_random_rays(world, count) : create_camera_rays(world, count);
+}
+
+} // namespace
+
+/// Cast every ray of a batch on its own.
+void RayBatchScalar(benchmark::State &state) {
+    const auto world = octree::create_random_world(5, {0.0f, 0.0f, 0.0f}, 42);
+    const auto rays = create_rays(*world, state);
+    const octree::RayQuery query(*world);
+    for (auto _ : state) {
+        for (std::size_t ray = 0; ray < rays.size(); ray++) {
+            benchmark::DoNotOptimize(query.cast({rays.origin_x[ray], rays.origin_y[ray], rays.origin_z[ray]},
+                                                {rays.direction_x[ray], rays.direction_y[ray], rays.direction_z[ray]}));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rays.size()));
+}
+
+/// Cast a batch in packets, the third argument is the number of threads.
+void RayBatchCast(benchmark::State &state) {
+    const auto world = octree::create_random_world(5, {0.0f, 0.0f, 0.0f}, 42);
+    const auto rays = create_rays(*world, state);
+    const octree::RayQuery query(*world);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            query.cast(rays, std::numeric_limits<float>::max(), static_cast<std::size_t>(state.range(2))));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rays.size()));
+}
+
+BENCHMARK(RayBatchScalar)->ArgsProduct({{1000, 100000}, {0, 1}});
+BENCHMARK(RayBatchCast)->ArgsProduct({{1000, 100000}, {0, 1}, {1, 0}});
+
+} // namespace inexor::vulkan_renderer
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/collision_query.hpp>
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/ray_query.hpp>
+
+#include <vector>
+
+namespace inexor::vulkan_renderer {
+
+namespace {
+
+/// A fan of rays from a camera outside of the world towards the world.
+std::vector<glm::vec3> create_ray_directions(const octree::Cube &world, const glm::vec3 &camera_position) {
+    std::vector<glm::vec3> directions;
+    constexpr int RESOLUTION{16};
+    for (int y = 0; y < RESOLUTION; y++) {
+        for (int x = 0; x < RESOLUTION; x++) {
+            const glm::vec3 target = world.position() + glm::vec3(static_cast<float>(x) + 0.5f, 0.5f * world.size(),
+                                                                  static_cast<float>(y) + 0.5f) *
+                                                            (world.size() / RESOLUTION);
+            directions.push_back(target - camera_position);
+        }
+    }
+    return directions;
+}
+
+} // namespace
+
+/// Pick the first cube along a ray with the octree traversal.
+void RayQueryCast(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const glm::vec3 camera_position{-10.0f, 1.0f, -10.0f};
+    const auto directions = create_ray_directions(*world, camera_position);
+    const octree::RayQuery query(*world);
+    for (auto _ : state) {
+        for (const auto &direction : directions) {
+            benchmark::DoNotOptimize(query.cast(camera_position, direction));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * directions.size()));
+}
+
+/// Pick the first cube along a ray and calculate the selected face, corner and edge, like the octree editor does.
+void RayCubeCollisionCheck(benchmark::State &state) {
+    const auto world = octree::create_random_world(static_cast<std::uint32_t>(state.range(0)), {0.0f, 0.0f, 0.0f}, 42);
+    const glm::vec3 camera_position{-10.0f, 1.0f, -10.0f};
+    const auto directions = create_ray_directions(*world, camera_position);
+    for (auto _ : state) {
+        for (const auto &direction : directions) {
+            benchmark::DoNotOptimize(octree::ray_cube_collision_check(*world, camera_position, direction));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * directions.size()));
+}
+
+BENCHMARK(RayQueryCast)->DenseRange(3, 6);
+BENCHMARK(RayCubeCollisionCheck)->DenseRange(3, 6);
+
+} // namespace inexor::vulkan_renderer
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/shape_query.hpp>
+
+#include <array>
+#include <random>
+#include <vector>
+
+namespace inexor::vulkan_renderer {
+
+namespace {
+
+/// The position and the movement of an entity during one frame.
+struct Entity {
+    glm::vec3 position;
+    glm::vec3 motion;
+};
+
+/// Entities at random positions in the world, which move about a quarter of a cube of the finest level per frame.
+std::vector<Entity> create_entities(const octree::Cube &world, const std::size_t count) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    auto random_offset = [&]() {
+        return glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+    };
+    std::vector<Entity> entities(count);
+    for (auto &entity : entities) {
+        entity.position = world.center() + random_offset() * (0.5f * world.size());
+        entity.motion = random_offset() * (world.size() / 128.0f);
+    }
+    return entities;
+}
+
+constexpr float ENTITY_RADIUS{0.05f};
+
+} // namespace
+
+/// Test the bounding box of every entity for overlaps, the argument is the number of entities.
+void OverlapBox(benchmark::State &state) {
+    const auto world = octree::create_random_world(5, {0.0f, 0.0f, 0.0f}, 42);
+    const auto entities = create_entities(*world, static_cast<std::size_t>(state.range(0)));
+    const octree::ShapeQuery query(*world);
+    std::array<octree::ShapeContact, 16> contacts;
+    const glm::vec3 extent(ENTITY_RADIUS, 2.0f * ENTITY_RADIUS, ENTITY_RADIUS);
+    for (auto _ : state) {
+        for (const auto &entity : entities) {
+            benchmark::DoNotOptimize(query.overlap_box({entity.position - extent, entity.position + extent}, contacts));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * entities.size()));
+}
+
+/// Test the bounding sphere of every entity for overlaps, the argument is the number of entities.
+void OverlapSphere(benchmark::State &state) {
+    const auto world = octree::create_random_world(5, {0.0f, 0.0f, 0.0f}, 42);
+    const auto entities = create_entities(*world, static_cast<std::size_t>(state.range(0)));
+    const octree::ShapeQuery query(*world);
+    std::array<octree::ShapeContact, 16> contacts;
+    for (auto _ : state) {
+        for (const auto &entity : entities) {
+            benchmark::DoNotOptimize(query.overlap_sphere(entity.position, ENTITY_RADIUS, contacts));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * entities.size()));
+}
+
+/// Sweep the bounding sphere of every entity along its movement of one frame, the argument is the number of entities.
+void SweepSphere(benchmark::State &state) {
+    const auto world = octree::create_random_world(5, {0.0f, 0.0f, 0.0f}, 42);
+    const auto entities = create_entities(*world, static_cast<std::size_t>(state.range(0)));
+    const octree::ShapeQuery query(*world);
+    for (auto _ : state) {
+        for (const auto &entity : entities) {
+            benchmark::DoNotOptimize(query.sweep_sphere(entity.position, ENTITY_RADIUS, entity.motion));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * entities.size()));
+}
+
+BENCHMARK(OverlapBox)->Arg(256);
+BENCHMARK(OverlapSphere)->Arg(256);
+BENCHMARK(SweepSphere)->Arg(256);
+
+} // namespace inexor::vulkan_renderer
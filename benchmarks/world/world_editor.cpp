@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/world_editor.hpp>
+
+namespace inexor::vulkan_renderer {
+
+/// Fill a box with solid cubes of the finest level of a depth 5 world and undo it again. The argument is the edge
+/// length of the box relative to the world in percent.
+void WorldEditorFill(benchmark::State &state) {
+    const auto world = octree::create_random_world(5, {0.0f, 0.0f, 0.0f}, 42);
+    octree::WorldEditor editor(world);
+    const float extent = world->size() * static_cast<float>(state.range(0)) / 100.0f;
+    const glm::vec3 min = world->center() - 0.5f * extent + 0.01f;
+    octree::EditStatistics statistics;
+    for (auto _ : state) {
+        statistics = editor.fill({min, min + extent}, 6, octree::Cube::Type::SOLID);
+        benchmark::DoNotOptimize(editor.undo());
+    }
+    static_cast<void>(world->take_dirty_cubes());
+    state.counters["written_cubes"] = static_cast<double>(statistics.written_cubes);
+    state.counters["journal_bytes"] = static_cast<double>(statistics.journal_bytes);
+}
+
+/// Paste a depth 4 region into a depth 5 world and undo it again.
+void WorldEditorPaste(benchmark::State &state) {
+    const auto world = octree::create_random_world(5, {0.0f, 0.0f, 0.0f}, 42);
+    const auto source = octree::create_random_world(3, {0.0f, 0.0f, 0.0f}, 7);
+    octree::WorldEditor editor(world);
+    octree::EditStatistics statistics;
+    for (auto _ : state) {
+        statistics = editor.paste(*source, octree::LocationalCode().child(3).child(5));
+        benchmark::DoNotOptimize(editor.undo());
+    }
+    static_cast<void>(world->take_dirty_cubes());
+    state.counters["written_cubes"] = static_cast<double>(statistics.written_cubes);
+    state.counters["journal_bytes"] = static_cast<double>(statistics.journal_bytes);
+}
+
+BENCHMARK(WorldEditorFill)->Arg(10)->Arg(50)->Arg(90)->Unit(benchmark::kMillisecond);
+BENCHMARK(WorldEditorPaste)->Unit(benchmark::kMillisecond);
+
+} // namespace inexor::vulkan_renderer
@@ -4,13 +4,18 @@
 #include "inexor/vulkan-renderer/input/input.hpp"
 #include "inexor/vulkan-renderer/input/keyboard_mouse_data.hpp"
 #include "inexor/vulkan-renderer/meta/meta.hpp"
+#include "inexor/vulkan-renderer/octree/chunk_manager.hpp"
 #include "inexor/vulkan-renderer/octree/collision.hpp"
-#include "inexor/vulkan-renderer/octree/collision_query.hpp"
 #include "inexor/vulkan-renderer/octree/cube.hpp"
+#include "inexor/vulkan-renderer/octree/memory_statistics.hpp"
+#include "inexor/vulkan-renderer/octree/mesh_extraction.hpp"
+#include "inexor/vulkan-renderer/octree/ray_query.hpp"
+#include "inexor/vulkan-renderer/octree/vertex_quantization.hpp"
 #include "inexor/vulkan-renderer/tools/camera.hpp"
 #include "inexor/vulkan-renderer/tools/device_info.hpp"
 #include "inexor/vulkan-renderer/tools/enumerate.hpp"
 #include "inexor/vulkan-renderer/tools/exception.hpp"
+#include "inexor/vulkan-renderer/tools/frustum.hpp"
 #include "inexor/vulkan-renderer/tools/random.hpp"
 #include "inexor/vulkan-renderer/wrapper/instance.hpp"
 
@@ -22,6 +27,8 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <limits>
 #include <string_view>
 #include <toml++/toml.hpp>
 
@@ -152,47 +159,79 @@ VkBool32 ExampleApp::validation_layer_debug_messenger_callback(const VkDebugUtil
 void ExampleApp::load_octree_geometry(bool initialize) {
     spdlog::trace("Creating octree geometry");
 
-    // 4: 23 012 | 5: 184352 | 6: 1474162 | 7: 11792978 cubes, DO NOT USE 7!
+    // 4: 23 012 | 5: 184352 | 6: 1474162 | 7: 11792978 cubes, for depth 7 and more write the world into a file with
+    // NXOCParser::serialize_random_world instead of building it here.
     m_worlds.clear();
     using octree::create_random_world;
     m_worlds.push_back(create_random_world(2, {0.0f, 0.0f, 0.0f}, initialize ? std::optional(42) : std::nullopt));
     m_worlds.push_back(create_random_world(2, {10.0f, 0.0f, 0.0f}, initialize ? std::optional(60) : std::nullopt));
 
-    using tools::generate_random_number;
-    m_octree_vertices.clear();
+    // All worlds share one quantization grid, which is fine enough for the smallest cube of all worlds.
+    glm::vec3 grid_origin = m_worlds.front()->position();
+    float grid_step = std::numeric_limits<float>::max();
     for (const auto &world : m_worlds) {
-        for (const auto &polygons : world->polygons(true)) {
-            for (const auto &triangle : *polygons) {
-                for (const auto &vertex : triangle) {
-                    glm::vec3 color = {
-                        generate_random_number(0.0f, 1.0f),
-                        generate_random_number(0.0f, 1.0f),
-                        generate_random_number(0.0f, 1.0f),
-                    };
-                    m_octree_vertices.emplace_back(vertex, color);
-                }
-            }
+        grid_origin = glm::min(grid_origin, world->position());
+        grid_step = std::min(grid_step, octree::QuantizationGrid::from_octree(*world).step());
+    }
+    m_quantization_grid = octree::QuantizationGrid(grid_origin, grid_step);
+    for (const auto &world : m_worlds) {
+        const auto bounding_box = world->bounding_box();
+        if (!m_quantization_grid.fits(bounding_box[0], bounding_box[1])) {
+            throw InexorException("Error: Octree geometry is too large for 16 bit vertex positions!");
         }
     }
+
+    m_chunk_manager = std::make_unique<octree::ChunkManager>(
+        m_worlds, octree::ChunkSettings{.vertex_size = sizeof(OctreeGpuVertex),
+                                        .mesh_settings = {.merge_coplanar_faces = true, .thread_count = 0},
+                                        .lod_distances = {16.0f, 32.0f}});
+    // The buffers of the slots are created in setup_render_graph, so the number of slots must not change afterwards.
+    if (m_octree_chunk_slots.size() != m_chunk_manager->slot_count()) {
+        m_octree_chunk_slots.resize(m_chunk_manager->slot_count());
+    }
+    // The chunks of the new worlds are assigned to the slots from scratch, so the old slot contents must be dropped.
+    for (auto &slot : m_octree_chunk_slots) {
+        slot.vertices.clear();
+        slot.indices.clear();
+        slot.vertices_changed = true;
+        slot.indices_changed = true;
+    }
+    m_mesh_statistics = {};
+    m_memory_statistics_age = std::numeric_limits<float>::max();
 }
 
-void ExampleApp::generate_octree_indices() {
-    auto old_vertices = std::move(m_octree_vertices);
-    m_octree_indices.clear();
-    m_octree_vertices.clear();
-    std::unordered_map<OctreeGpuVertex, std::uint32_t> vertex_map;
-    for (auto &vertex : old_vertices) {
-        // TODO: Use std::unordered_map::contains() when we switch to C++ 20.
-        if (vertex_map.count(vertex) == 0) {
-            assert(vertex_map.size() < std::numeric_limits<std::uint32_t>::max() && "Octree too big!");
-            vertex_map.emplace(vertex, static_cast<std::uint32_t>(vertex_map.size()));
-            m_octree_vertices.push_back(vertex);
+void ExampleApp::cull_octree_chunks() {
+    m_culling_result =
+        m_chunk_manager->cull(tools::Frustum(m_camera->perspective_matrix() * m_camera->view_matrix()));
+}
+
+void ExampleApp::update_octree_chunks() {
+    using tools::generate_random_number;
+    const auto changed_slots = m_chunk_manager->update(m_camera->position());
+    for (const auto slot_index : changed_slots) {
+        auto &slot = m_octree_chunk_slots[slot_index];
+        slot.vertices.clear();
+        slot.indices.clear();
+        if (const auto *chunk = m_chunk_manager->chunk_in_slot(slot_index)) {
+            slot.vertices.reserve(chunk->mesh.vertices.size());
+            for (const auto &vertex : chunk->mesh.vertices) {
+                glm::vec3 color = {
+                    generate_random_number(0.0f, 1.0f),
+                    generate_random_number(0.0f, 1.0f),
+                    generate_random_number(0.0f, 1.0f),
+                };
+                slot.vertices.emplace_back(m_quantization_grid.quantize(vertex), color);
+            }
+            slot.indices = chunk->mesh.indices;
         }
-        m_octree_indices.push_back(vertex_map.at(vertex));
+        slot.vertices_changed = true;
+        slot.indices_changed = true;
+    }
+    if (!changed_slots.empty()) {
+        m_mesh_statistics = m_chunk_manager->statistics();
+        spdlog::trace("Updated {} octree chunk slots, {} bytes of octree meshes loaded", changed_slots.size(),
+                      m_chunk_manager->memory_usage());
     }
-    spdlog::trace("Reduced octree by {} vertices (from {} to {})", old_vertices.size() - m_octree_vertices.size(),
-                  old_vertices.size(), m_octree_vertices.size());
-    spdlog::trace("Total indices {} ", m_octree_indices.size());
 }
 
 void ExampleApp::setup_window_and_input_callbacks() {
@@ -391,7 +430,6 @@ ExampleApp::ExampleApp(int argc, char **argv) {
 
     load_shaders();
     load_octree_geometry(true);
-    generate_octree_indices();
 
     m_window->show();
 
@@ -461,21 +499,32 @@ void ExampleApp::setup_render_graph() {
         "depth buffer", vulkan_renderer::render_graph::TextureUsage::DEPTH_ATTACHMENT, VK_FORMAT_D32_SFLOAT_S8_UINT,
         m_swapchain2->extent().width, m_swapchain2->extent().height);
 
-    m_index_buffer2 =
-        m_render_graph2->add_buffer("index buffer", vulkan_renderer::render_graph::BufferType::INDEX_BUFFER, [&]() {
-            // @TODO Ideally we would not need the if check?
-            if (!m_octree_indices.empty()) {
-                m_index_buffer2.lock()->request_update(m_octree_indices);
-            }
-        });
-
-    m_vertex_buffer2 =
-        m_render_graph2->add_buffer("vertex buffer", vulkan_renderer::render_graph::BufferType::VERTEX_BUFFER, [&]() {
-            // @TODO Ideally we would not need the if check?
-            if (!m_octree_vertices.empty()) {
-                m_vertex_buffer2.lock()->request_update(m_octree_vertices);
-            }
-        });
+    for (std::size_t slot_index = 0; slot_index < m_octree_chunk_slots.size(); slot_index++) {
+        auto &slot = m_octree_chunk_slots[slot_index];
+        // The buffers have been created again, so they need the data of the slot again.
+        slot.vertices_changed = true;
+        slot.indices_changed = true;
+
+        // Only the buffers of slots which have been changed by the chunk manager are uploaded again. Empty slots are
+        // not drawn, so the old contents of their buffers do not matter.
+        slot.index_buffer = m_render_graph2->add_buffer(
+            "index buffer " + std::to_string(slot_index), vulkan_renderer::render_graph::BufferType::INDEX_BUFFER,
+            [&slot]() {
+                if (slot.indices_changed) {
+                    slot.indices_changed = false;
+                    slot.index_buffer.lock()->request_update(slot.indices);
+                }
+            });
+
+        slot.vertex_buffer = m_render_graph2->add_buffer(
+            "vertex buffer " + std::to_string(slot_index), vulkan_renderer::render_graph::BufferType::VERTEX_BUFFER,
+            [&slot]() {
+                if (slot.vertices_changed) {
+                    slot.vertices_changed = false;
+                    slot.vertex_buffer.lock()->request_update(slot.vertices);
+                }
+            });
+    }
 
     // Descriptor management for the model/view/projection uniform buffer
     m_render_graph2->add_resource_descriptor(
@@ -506,6 +555,8 @@ void ExampleApp::setup_render_graph() {
                                                     m_ubo.view = m_camera->view_matrix();
                                                     m_ubo.proj = m_camera->perspective_matrix();
                                                     m_ubo.proj[1][1] *= -1;
+                                                    m_ubo.quantization = glm::vec4(m_quantization_grid.origin(),
+                                                                                   m_quantization_grid.step());
                                                     // Request rendergraph to do an update of the uniform buffer
                                                     m_mvp_matrix2.lock()->request_update(m_ubo);
                                                 });
@@ -521,7 +572,7 @@ void ExampleApp::setup_render_graph() {
                                  .add_shader(m_fragment_shader2)
                                  .set_vertex_input_bindings({{
                                      .binding = 0,
-                                     .stride = sizeof(OctreeVertex),
+                                     .stride = sizeof(OctreeGpuVertex),
                                      .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
                                  }})
                                  // NOTE: Instead of making these set methods fancy, we just explicitely pass the data
@@ -529,13 +580,13 @@ void ExampleApp::setup_render_graph() {
                                  .set_vertex_input_attributes({
                                      {
                                          .location = 0,
-                                         .format = VK_FORMAT_R32G32B32_SFLOAT,
-                                         .offset = offsetof(OctreeVertex, position),
+                                         .format = VK_FORMAT_R16G16B16A16_UINT,
+                                         .offset = offsetof(OctreeGpuVertex, position),
                                      },
                                      {
                                          .location = 1,
-                                         .format = VK_FORMAT_R32G32B32_SFLOAT,
-                                         .offset = offsetof(OctreeVertex, color),
+                                         .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                         .offset = offsetof(OctreeGpuVertex, color),
                                      },
                                  })
                                  // @TODO: Default this implicitely?
@@ -565,22 +616,26 @@ void ExampleApp::setup_render_graph() {
 
     // @TODO We don't have to turn add_graphics_pass into accepting a lambda, but we could to make the API more
     // consistent. We could immediately invoke the lambda to execute it on the spot...
+    auto &graphics_pass_builder = m_render_graph2->get_graphics_pass_builder();
+    for (const auto &slot : m_octree_chunk_slots) {
+        static_cast<void>(graphics_pass_builder.reads_from(slot.vertex_buffer).reads_from(slot.index_buffer));
+    }
     m_graphics_pass2 = m_render_graph2->add_graphics_pass(
-        m_render_graph2->get_graphics_pass_builder()
-            .writes_to(m_swapchain2, VkClearValue{0.0f, 0.0f, 0.0f})
+        graphics_pass_builder.writes_to(m_swapchain2, VkClearValue{0.0f, 0.0f, 0.0f})
             .writes_to(m_depth_buffer2)
-            .reads_from(m_vertex_buffer2)
-            .writes_to(m_index_buffer2)
-            .reads_from(m_index_buffer2)
             .set_on_record([&](const CommandBuffer &cmd_buf) {
                 // @TODO Explain in the docs how object lifetime is important in here!
                 cmd_buf
                     .bind_pipeline(m_octree_pipeline2)
                     // @TODO Associate pipeline layout with descriptor sets internally!
-                    .bind_descriptor_set(m_descriptor_set2, m_octree_pipeline2)
-                    .bind_vertex_buffer(m_vertex_buffer2)
-                    .bind_index_buffer(m_index_buffer2)
-                    .draw_indexed(static_cast<std::uint32_t>(m_octree_indices.size()));
+                    .bind_descriptor_set(m_descriptor_set2, m_octree_pipeline2);
+                // Only the chunks which are inside of the view frustum are drawn.
+                for (const auto &range : m_culling_result.draw_ranges) {
+                    const auto &slot = m_octree_chunk_slots[range.slot];
+                    cmd_buf.bind_vertex_buffer(slot.vertex_buffer)
+                        .bind_index_buffer(slot.index_buffer)
+                        .draw_indexed(range.index_count, 1, range.first_index);
+                }
             })
             .build("Octree", vulkan_renderer::render_graph::DebugLabelColor::GREEN));
 }
@@ -620,6 +675,32 @@ void ExampleApp::update_imgui_overlay() {
     ImGui::Text("Yaw: %.2f pitch: %.2f roll: %.2f", m_camera->yaw(), m_camera->pitch(), m_camera->roll());
     const auto cam_fov = m_camera->fov();
     ImGui::Text("Field of view: %d", static_cast<std::uint32_t>(cam_fov));
+    ImGui::Text("Octree triangles: %zu (%zu culled, %zu merged)", m_mesh_statistics.emitted_triangles,
+                m_mesh_statistics.culled_triangles, m_mesh_statistics.merged_triangles);
+    ImGui::Text("Octants collapsed by level of detail: %zu", m_mesh_statistics.collapsed_octants);
+    ImGui::Text("Visible triangles: %zu (%zu/%zu chunks)", m_culling_result.visible_triangles,
+                m_culling_result.visible_chunks, m_culling_result.visible_chunks + m_culling_result.culled_chunks);
+    ImGui::Text("Frustum culling: %.3f ms (%zu boxes tested)", m_culling_result.cpu_time.count(),
+                m_culling_result.tested_boxes);
+    // This runs before update_octree_chunks takes the dirty cubes, so edits of this frame are still visible here.
+    m_memory_statistics_age += m_time_passed;
+    if (m_memory_statistics_age >= MEMORY_STATISTICS_INTERVAL ||
+        std::any_of(m_worlds.begin(), m_worlds.end(), [](const auto &world) { return world->is_dirty(); })) {
+        m_memory_statistics = {};
+        for (const auto &world : m_worlds) {
+            m_memory_statistics += vulkan_renderer::octree::collect_memory_statistics(*world);
+        }
+        m_memory_statistics_age = 0.0f;
+    }
+    const auto &memory = m_memory_statistics;
+    constexpr float MIB{1024.0f * 1024.0f};
+    ImGui::Text("Octree memory: %.2f MiB (%zu cubes, %zu levels)", static_cast<float>(memory.total_bytes()) / MIB,
+                memory.cubes(), memory.cubes_per_level.size());
+    ImGui::Text("Nodes: %.2f MiB (%.2f MiB unused indentations)", static_cast<float>(memory.node_bytes) / MIB,
+                static_cast<float>(memory.unused_indentation_bytes) / MIB);
+    ImGui::Text("Polygon caches: %.2f MiB (%zu caches, %zu invalid)",
+                static_cast<float>(memory.polygon_cache_bytes) / MIB, memory.polygon_caches,
+                memory.invalid_polygon_caches);
     ImGui::PushItemWidth(150.0f * m_imgui_overlay->scale());
     ImGui::PopItemWidth();
     ImGui::End();
@@ -659,24 +740,28 @@ void ExampleApp::process_input() {
 }
 
 void ExampleApp::check_octree_collisions() {
-    // Check for collision between camera ray and every octree
+    // Check for collision between camera ray and every octree, the nearest hit of all octrees is selected.
+    std::optional<octree::RayHit> nearest_hit;
     for (const auto &world : m_worlds) {
-        const auto collision = ray_cube_collision_check(*world, m_camera->position(), m_camera->front());
-
-        if (collision) {
-            const auto intersection = collision.value().intersection();
-            const auto face_normal = collision.value().face();
-            const auto corner = collision.value().corner();
-            const auto edge = collision.value().edge();
-
-            spdlog::trace("pos {} {} {} | face {} {} {} | corner {} {} {} | edge {} {} {}", intersection.x,
-                          intersection.y, intersection.z, face_normal.x, face_normal.y, face_normal.z, corner.x,
-                          corner.y, corner.z, edge.x, edge.y, edge.z);
-
-            // Break after one collision.
-            break;
+        const float max_distance = nearest_hit ? nearest_hit->t : std::numeric_limits<float>::max();
+        const auto hit = octree::RayQuery(*world).cast(m_camera->position(), m_camera->front(), max_distance);
+        if (hit && (!nearest_hit || hit->t < nearest_hit->t)) {
+            nearest_hit = hit;
         }
     }
+    if (!nearest_hit) {
+        return;
+    }
+
+    const octree::RayCubeCollision<octree::Cube> collision(*nearest_hit->cube, m_camera->position(), m_camera->front());
+    const auto intersection = collision.intersection();
+    const auto face_normal = collision.face();
+    const auto corner = collision.corner();
+    const auto edge = collision.edge();
+
+    spdlog::trace("pos {} {} {} | face {} {} {} | corner {} {} {} | edge {} {} {}", intersection.x, intersection.y,
+                  intersection.z, face_normal.x, face_normal.y, face_normal.z, corner.x, corner.y, corner.z, edge.x,
+                  edge.y, edge.z);
 }
 
 void ExampleApp::run() {
@@ -689,11 +774,12 @@ void ExampleApp::run() {
         if (m_fps_limiter.is_next_frame_allowed()) {
             m_input->update_gamepad_data();
             update_imgui_overlay();
+            update_octree_chunks();
+            cull_octree_chunks();
             render_frame();
             process_input();
             if (m_input->kbm_data().was_key_pressed_once(GLFW_KEY_N)) {
                 load_octree_geometry(false);
-                generate_octree_indices();
             }
             m_camera->update(m_time_passed);
             m_time_passed = m_stopwatch.time_step();
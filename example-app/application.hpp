@@ -3,8 +3,14 @@
 #include "renderer.hpp"
 
 #include "inexor/vulkan-renderer/input/input.hpp"
+#include "inexor/vulkan-renderer/octree/chunk_manager.hpp"
+#include "inexor/vulkan-renderer/octree/memory_statistics.hpp"
+#include "inexor/vulkan-renderer/octree/mesh_extraction.hpp"
+#include "inexor/vulkan-renderer/octree/vertex_quantization.hpp"
 #include "standard_ubo.hpp"
 
+#include <limits>
+
 namespace inexor::vulkan_renderer::octree {
 // Forward declaration
 class Cube;
@@ -53,6 +59,21 @@ private:
 
     /// Inexor engine supports a variable number of octrees.
     std::vector<std::shared_ptr<Cube>> m_worlds;
+    /// Streams the chunks of all octrees in and out depending on the camera position.
+    std::unique_ptr<vulkan_renderer::octree::ChunkManager> m_chunk_manager;
+    /// Statistics of the mesh extraction of all loaded octree chunks.
+    vulkan_renderer::octree::MeshStatistics m_mesh_statistics;
+    /// The grid on which the octree vertex positions are stored.
+    vulkan_renderer::octree::QuantizationGrid m_quantization_grid;
+    /// The octree chunks which are visible from the camera in the current frame.
+    vulkan_renderer::octree::CullingResult m_culling_result;
+    /// The memory usage of all octrees shown in the overlay. Collecting it walks every cube, so it is only done again
+    /// when a world has been edited or after MEMORY_STATISTICS_INTERVAL, as the polygon caches are filled lazily.
+    vulkan_renderer::octree::MemoryStatistics m_memory_statistics;
+    /// The seconds since m_memory_statistics has been collected.
+    float m_memory_statistics_age{std::numeric_limits<float>::max()};
+    /// The seconds after which m_memory_statistics is collected again even if no world has been edited.
+    static constexpr float MEMORY_STATISTICS_INTERVAL{1.0f};
 
     /// @brief Load the configuration of the renderer from a TOML configuration file.
     /// @brief file_name The TOML configuration file.
@@ -62,11 +83,14 @@ private:
     /// @param initialize Initialize worlds with a fixed seed, which is useful for benchmarking and testing
     void load_octree_geometry(bool initialize);
     void setup_window_and_input_callbacks();
+    /// Let the chunk manager load and evict octree chunks and prepare the vertex data of every slot which has changed.
+    void update_octree_chunks();
+    /// Cull the loaded octree chunks against the view frustum of the camera, only the visible ones are drawn.
+    void cull_octree_chunks();
     void update_imgui_overlay();
     /// Use the camera's position and view direction vector to check for ray-octree collisions with all octrees.
     void check_octree_collisions();
     void process_input();
-    void generate_octree_indices();
     void initialize_spdlog();
     void recreate_swapchain();
     void render_frame();
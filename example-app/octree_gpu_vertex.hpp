@@ -1,33 +1,37 @@
 #pragma once
 
-#include <glm/gtx/hash.hpp>
 #include <glm/vec3.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
 namespace inexor::example_app {
 
+/// A packed octree vertex, 12 bytes instead of 24 bytes for two glm::vec3.
+/// The position is stored as 16 bit coordinates on the quantization grid of the octree, see
+/// octree::QuantizationGrid. The shader dequantizes it with the grid origin and step from the uniform buffer.
 struct OctreeGpuVertex {
-    glm::vec3 position;
-    glm::vec3 color;
-
-    OctreeGpuVertex(glm::vec3 position, glm::vec3 color) : position(position), color(color) {}
+    /// The quantized position, the fourth component is unused and only there to keep the attribute 8 byte aligned.
+    std::array<std::uint16_t, 4> position;
+    /// The color as normalized RGBA8.
+    std::array<std::uint8_t, 4> color;
+
+    OctreeGpuVertex(const std::array<std::uint16_t, 3> &position, const glm::vec3 &color)
+        : position{position[0], position[1], position[2], 0}, color{pack_unorm(color.x), pack_unorm(color.y),
+                                                                    pack_unorm(color.z), 255} {}
+
+    /// Convert a value in the range [0, 1] to an 8 bit normalized value.
+    static std::uint8_t pack_unorm(const float value) {
+        return static_cast<std::uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
 };
 
+static_assert(sizeof(OctreeGpuVertex) == 12);
+
 // inline to suppress clang-tidy warning.
 inline bool operator==(const OctreeGpuVertex &lhs, const OctreeGpuVertex &rhs) {
     return lhs.position == rhs.position && lhs.color == rhs.color;
 }
 
 } // namespace inexor::example_app
-
-namespace std {
-
-template <>
-struct hash<inexor::example_app::OctreeGpuVertex> {
-    std::size_t operator()(const inexor::example_app::OctreeGpuVertex &vertex) const {
-        const auto h1 = std::hash<glm::vec3>{}(vertex.position);
-        const auto h2 = std::hash<glm::vec3>{}(vertex.color);
-        return h1 ^ h2;
-    }
-};
-
-} // namespace std
@@ -67,10 +67,15 @@ using inexor::vulkan_renderer::wrapper::windows::WindowSurface;
 
 namespace inexor::example_app {
 
-/// Octree vertex struct
-struct OctreeVertex {
-    glm::vec3 position;
-    glm::vec3 color;
+/// The GPU buffers and vertex data of one slot of the octree chunk manager.
+struct OctreeChunkSlot {
+    std::weak_ptr<vulkan_renderer::render_graph::Buffer> vertex_buffer;
+    std::weak_ptr<vulkan_renderer::render_graph::Buffer> index_buffer;
+    std::vector<OctreeGpuVertex> vertices;
+    std::vector<std::uint32_t> indices;
+    /// The buffers are only updated if the chunk manager changed the slot.
+    bool vertices_changed{false};
+    bool indices_changed{false};
 };
 
 /// The base class of the Inexor vulkan-renderer example app.
@@ -85,8 +90,6 @@ protected:
 
     // RENDERGRAPH2
     std::shared_ptr<vulkan_renderer::render_graph::RenderGraph> m_render_graph2;
-    std::weak_ptr<vulkan_renderer::render_graph::Buffer> m_vertex_buffer2;
-    std::weak_ptr<vulkan_renderer::render_graph::Buffer> m_index_buffer2;
     std::weak_ptr<vulkan_renderer::render_graph::Texture> m_back_buffer2;
     std::weak_ptr<vulkan_renderer::render_graph::Texture> m_depth_buffer2;
     std::weak_ptr<vulkan_renderer::render_graph::GraphicsPass> m_graphics_pass2;
@@ -106,8 +109,8 @@ protected:
     // The rendergraph will be able to handle an arbitrary number of windows and swapchains.
 
     std::unique_ptr<Window> m_window;
-    std::vector<OctreeGpuVertex> m_octree_vertices;
-    std::vector<std::uint32_t> m_octree_indices;
+    /// Every loaded octree chunk is drawn from its own pair of vertex and index buffers.
+    std::vector<OctreeChunkSlot> m_octree_chunk_slots;
     std::vector<Shader> m_shaders;
     bool m_vsync_enabled{false};
     std::unique_ptr<Camera> m_camera;
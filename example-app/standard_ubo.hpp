@@ -11,6 +11,8 @@ struct UniformBufferObject {
     glm::mat4 model;
     glm::mat4 view;
     glm::mat4 proj;
+    /// The origin (xyz) and step (w) of the quantization grid of the octree vertices.
+    glm::vec4 quantization;
 };
 
 } // namespace inexor::vulkan_renderer
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+#include "inexor/vulkan-renderer/octree/indexed_mesh_builder.hpp"
+#include "inexor/vulkan-renderer/octree/mesh_extraction.hpp"
+#include "inexor/vulkan-renderer/tools/frustum.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace inexor::vulkan_renderer::octree {
+
+/// Options which control how worlds are split into chunks and which chunks are kept in memory.
+struct ChunkSettings {
+    /// The number of octree levels below the root of a world at which the world is split into chunks. A world is split
+    /// into at most 8^chunk_level chunks, cubes above that level which are not Type::OCTANT become a chunk on their
+    /// own.
+    std::size_t chunk_level{2};
+    /// Chunks whose bounding box is farther away from the camera than this are not loaded.
+    float load_distance{64.0f};
+    /// The maximum number of bytes of all loaded chunk meshes.
+    std::size_t memory_budget{64 * 1024 * 1024};
+    /// The number of bytes of one vertex in the buffers into which the meshes are uploaded, which is used to compute
+    /// the memory usage of a mesh. The vertices of an IndexedMesh are usually converted, e.g. quantized, before upload.
+    std::size_t vertex_size{sizeof(glm::vec3)};
+    /// The number of slots into which the meshes of loaded chunks are put, usually one pair of GPU buffers per slot.
+    /// Chunks with an empty mesh do not need a slot.
+    std::size_t slot_count{64};
+    /// The maximum number of chunks which are meshed in one call of ChunkManager::update, which limits the time an
+    /// update takes when the camera moves fast.
+    std::size_t max_loads_per_update{8};
+    /// The settings which are used to mesh a chunk.
+    MeshExtractionSettings mesh_settings{};
+    /// The distances from which chunks are meshed with less detail, in ascending order. A chunk which is farther away
+    /// than lod_distances[i] gets the level of detail i + 1, for which the octants i + 1 levels above the deepest level
+    /// of the chunk are collapsed, see MeshExtractionSettings::max_depth. Level 0 is the full detail.
+    std::vector<float> lod_distances{};
+};
+
+/// A part of a world which is meshed, loaded and evicted independently.
+struct Chunk {
+    /// The cube which holds the geometry of the chunk.
+    std::shared_ptr<Cube> cube;
+    /// The index of the world the chunk belongs to.
+    std::size_t world{0};
+    std::array<glm::vec3, 2> bounding_box{};
+    /// The mesh of the chunk, only valid if the chunk is loaded.
+    IndexedMesh mesh;
+    /// The extraction statistics of the mesh, only valid if the chunk is loaded.
+    MeshStatistics statistics;
+    bool loaded{false};
+    /// The level of detail of the mesh, see ChunkSettings::lod_distances. Only valid if the chunk is loaded.
+    std::size_t lod{0};
+    /// The slot which holds the mesh, chunks which are not loaded or which have an empty mesh do not have a slot.
+    std::optional<std::size_t> slot;
+    /// The number of bytes of the last mesh of the chunk, which is used to check the memory budget before the chunk is
+    /// meshed again. std::nullopt if the chunk has never been meshed or has been edited since.
+    std::optional<std::size_t> last_memory_usage;
+
+    /// The number of bytes of the mesh once it is uploaded.
+    /// @param vertex_size The number of bytes of one uploaded vertex, see ChunkSettings::vertex_size
+    [[nodiscard]] std::size_t memory_usage(const std::size_t vertex_size) const noexcept {
+        return mesh.vertices.size() * vertex_size + mesh.indices.size() * sizeof(std::uint32_t);
+    }
+};
+
+/// A range of the index buffer of a slot which has to be drawn.
+struct DrawRange {
+    std::size_t slot{0};
+    std::uint32_t first_index{0};
+    std::uint32_t index_count{0};
+};
+
+/// The loaded chunks which are visible from a camera.
+struct CullingResult {
+    /// One range per visible chunk which has a slot.
+    std::vector<DrawRange> draw_ranges;
+    /// The number of chunks with a slot which are inside of the frustum.
+    std::size_t visible_chunks{0};
+    /// The number of chunks with a slot which are outside of the frustum.
+    std::size_t culled_chunks{0};
+    /// The number of triangles of all draw ranges.
+    std::size_t visible_triangles{0};
+    /// The number of bounding boxes which have been tested against the frustum.
+    std::size_t tested_boxes{0};
+    /// The time it took to cull the chunks.
+    std::chrono::duration<float, std::milli> cpu_time{0.0f};
+};
+
+/// Splits worlds into chunks and streams the chunk meshes in and out depending on the camera position.
+/// The chunks which are closest to the camera are loaded first until the load distance, the memory budget or the
+/// number of slots is exhausted. Every loaded chunk with geometry is assigned to a slot, so the renderer only has to
+/// upload the slots which have changed. Edits to the worlds are picked up through Cube::take_dirty_cubes(), only the
+/// chunks which contain an edited cube are meshed again. Chunks which are far away from the camera are meshed with less
+/// detail, a loaded chunk is meshed again when it crosses one of the level of detail distances.
+/// @note Faces on the border of a chunk are never culled, as every chunk is meshed on its own.
+class ChunkManager {
+private:
+    std::vector<std::shared_ptr<Cube>> m_worlds;
+    ChunkSettings m_settings;
+    std::vector<Chunk> m_chunks;
+    /// Maps the cube of every chunk to its index in m_chunks.
+    std::unordered_map<const Cube *, std::size_t> m_chunk_lookup;
+    /// The chunk index of every slot.
+    std::vector<std::optional<std::size_t>> m_slots;
+    std::size_t m_memory_usage{0};
+
+    /// Add the chunks of a cube and all of its children.
+    void collect_chunks(std::size_t world, const std::shared_ptr<Cube> &cube, std::size_t level);
+
+    /// Add the draw ranges of the visible chunks of a cube and all of its children.
+    /// @param plane_mask The frustum planes the cube has to be tested against, see tools::Frustum::test
+    void cull(const Cube &cube, const tools::Frustum &frustum, std::uint8_t plane_mask, CullingResult &result) const;
+
+    /// Find the chunk which contains a cube by descending from the root of its world.
+    /// @return The chunk index, or std::nullopt if the cube is above the chunk level
+    [[nodiscard]] std::optional<std::size_t> find_chunk(const Cube &world, const Cube &cube) const;
+
+    /// Take the edits of all worlds and mesh the loaded chunks which contain an edited cube again.
+    void apply_edits(std::vector<std::size_t> &changed_slots);
+
+    /// Mesh a chunk.
+    /// @param lod The level of detail of the mesh
+    void load(Chunk &chunk, std::size_t lod);
+
+    /// Split a world into chunks again, which is required if a cube above the chunk level has been edited.
+    void partition_world(std::size_t world, std::vector<std::size_t> &changed_slots);
+
+    /// The level of detail of a chunk at a distance from the camera.
+    [[nodiscard]] std::size_t lod(float distance) const;
+
+    /// Rebuild m_chunk_lookup and m_slots after chunks have been added or removed.
+    void rebuild_lookup();
+
+    /// Release the mesh and the slot of a chunk.
+    void unload(Chunk &chunk, std::vector<std::size_t> &changed_slots);
+
+public:
+    /// Split worlds into chunks, no chunk is loaded until update() is called.
+    /// @param worlds The worlds, they must stay the same for the lifetime of the chunk manager
+    /// @param settings The chunk settings
+    /// @exception std::invalid_argument The slot count is zero or a world is nullptr
+    explicit ChunkManager(std::vector<std::shared_ptr<Cube>> worlds, ChunkSettings settings = {});
+
+    /// Find the loaded chunks which are inside of the view frustum of a camera.
+    /// The worlds are culled hierarchically: the octants above the chunks are tested first, so the chunks of an octant
+    /// outside of the frustum are skipped together, and the chunks of an octant inside of it are not tested at all.
+    /// @param frustum The view frustum of the camera
+    /// @return The draw ranges of the visible chunks with the culling statistics
+    [[nodiscard]] CullingResult cull(const tools::Frustum &frustum) const;
+
+    /// Get the chunk which is assigned to a slot.
+    /// @param slot The slot index
+    /// @return The chunk, or nullptr if the slot is unused
+    [[nodiscard]] const Chunk *chunk_in_slot(std::size_t slot) const;
+
+    [[nodiscard]] const std::vector<Chunk> &chunks() const noexcept {
+        return m_chunks;
+    }
+
+    /// The number of bytes of all loaded chunk meshes, which is never larger than the memory budget.
+    [[nodiscard]] std::size_t memory_usage() const noexcept {
+        return m_memory_usage;
+    }
+
+    [[nodiscard]] const ChunkSettings &settings() const noexcept {
+        return m_settings;
+    }
+
+    [[nodiscard]] std::size_t slot_count() const noexcept {
+        return m_slots.size();
+    }
+
+    /// The sum of the extraction statistics of all loaded chunks.
+    [[nodiscard]] MeshStatistics statistics() const;
+
+    /// Apply the edits of all worlds, then load the chunks closest to the camera and evict the chunks which are too far
+    /// away or do not fit into the memory budget anymore. Loaded chunks whose level of detail has changed are meshed
+    /// again, which counts towards ChunkSettings::max_loads_per_update.
+    /// @param camera_position The position of the camera
+    /// @return The sorted indices of the slots whose chunk or mesh has changed
+    [[nodiscard]] std::vector<std::size_t> update(const glm::vec3 &camera_position);
+};
+
+} // namespace inexor::vulkan_renderer::octree
@@ -1,20 +1,14 @@
 #pragma once
 
 #include "inexor/vulkan-renderer/octree/collision.hpp"
+#include "inexor/vulkan-renderer/octree/compact_octree.hpp"
 
 #include <glm/vec3.hpp>
 
 #include <array>
 #include <optional>
 
-// Forward declaration
 namespace inexor::vulkan_renderer::octree {
-class Cube;
-} // namespace inexor::vulkan_renderer::octree
-
-namespace inexor::vulkan_renderer::octree {
-
-// TODO: Implement PointCubeCollision
 
 /// @brief ``True`` of the ray build from the two vectors collides with the cube's bounding box.
 /// @note There is no such function as glm::intersectRayBox.
@@ -22,19 +16,34 @@ namespace inexor::vulkan_renderer::octree {
 /// @param pos The start position of the ray.
 /// @param dir The direction of the ray.
 /// @return ``True`` if the ray collides with the octree cube's bounding box.
-[[nodiscard]] bool ray_box_collision(std::array<glm::vec3, 2> &box_bounds, glm::vec3 &pos, glm::vec3 &dir);
+[[nodiscard]] bool ray_box_collision(const std::array<glm::vec3, 2> &box_bounds, const glm::vec3 &pos,
+                                     const glm::vec3 &dir);
 
 /// @brief Check for a collision between a camera ray and octree geometry.
+/// @note This uses RayQuery, which finds the first cube along the ray. Use RayQuery directly to cast many rays or if
+/// only the hit cube and its distance are needed.
 /// @param cube The cube to check collisions with.
 /// @param pos The camera position.
 /// @param dir The camera view direction.
 /// @param max_depth The maximum subcube iteration depth. If this depth is reached and the cube is an octant, it
 /// will be treated as if it was a solid cube. This is the foundation for the implementation of grid size in octree
 /// editor.
-/// @note This does not account yet for octree indentation!
+/// @note Type::NORMAL cubes are hit where the ray hits their indented geometry, but the selected face, corner and edge
+/// are still the ones of their bounding box.
 /// @return A std::optional which contains the collision data (if any found).
 [[nodiscard]] std::optional<RayCubeCollision<Cube>>
 ray_cube_collision_check(const Cube &cube, glm::vec3 pos, glm::vec3 dir,
                          std::optional<std::uint32_t> max_depth = std::nullopt);
 
+/// @brief Check for a collision between a camera ray and the geometry of a compact octree.
+/// @note This follows the same rules as the overload for Cube, but does not allocate any memory.
+/// @param octree The octree to check collisions with.
+/// @param pos The camera position.
+/// @param dir The camera view direction.
+/// @param max_depth The maximum subcube iteration depth, see the overload for Cube.
+/// @return The index of the node which was hit (if any found).
+[[nodiscard]] std::optional<CompactOctree::NodeIndex>
+ray_cube_collision_check(const CompactOctree &octree, glm::vec3 pos, glm::vec3 dir,
+                         std::optional<std::uint32_t> max_depth = std::nullopt);
+
 } // namespace inexor::vulkan_renderer::octree
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+#include "inexor/vulkan-renderer/octree/indentation.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace inexor::vulkan_renderer::octree {
+
+/// A pointer-free representation of an octree which stores all nodes in contiguous arrays.
+/// The children of an octant are always stored as one block of 8 consecutive nodes, so a node only needs to know the
+/// index of its first child. Indentations are kept in a separate table which only has entries for Type::NORMAL nodes.
+/// In contrast to Cube, no per-node heap allocation takes place and traversals do not touch any reference counts.
+/// @note The positions and sizes of the nodes are not stored, they are calculated while traversing the tree.
+class CompactOctree {
+public:
+    /// The index of a node in the node arrays.
+    using NodeIndex = std::uint32_t;
+    /// The root node is always stored first.
+    static constexpr NodeIndex ROOT{0};
+    /// Returned if a node does not exist.
+    static constexpr NodeIndex INVALID_NODE{std::numeric_limits<NodeIndex>::max()};
+
+private:
+    float m_size{32};
+    glm::vec3 m_position{0.0f, 0.0f, 0.0f};
+
+    /// The Cube::Type of every node.
+    std::vector<std::uint8_t> m_types;
+    /// The parent of every node, INVALID_NODE for the root.
+    std::vector<NodeIndex> m_parents;
+    /// Index of the first child for Type::OCTANT, index into m_indentations for Type::NORMAL, unused otherwise.
+    std::vector<NodeIndex> m_links;
+    /// Indentations of all Type::NORMAL nodes.
+    std::vector<std::array<Indentation, Cube::EDGES>> m_indentations;
+
+    /// Append a node of the given type and return its index.
+    NodeIndex append_node(Cube::Type type, NodeIndex parent);
+    /// Copy a cube and all of its children into the node at the given index.
+    void convert(const Cube &cube, NodeIndex node);
+    /// Append all polygons of the node and its children.
+    void collect_polygons(NodeIndex node, const glm::vec3 &position, float size, std::vector<Polygon> &polygons) const;
+
+public:
+    /// Create an octree which only contains an empty root.
+    CompactOctree();
+    /// Convert a cube and all of its children into the compact representation.
+    explicit CompactOctree(const Cube &cube);
+
+    /// Get the bounding box of a node.
+    [[nodiscard]] std::array<glm::vec3, 2> bounding_box(NodeIndex node) const;
+
+    /// Get a child of an octant.
+    /// @param node The octant
+    /// @param idx The index of the child in the octant
+    [[nodiscard]] NodeIndex child(NodeIndex node, std::size_t idx) const;
+
+    /// Count the number of Type::SOLID and Type::NORMAL nodes.
+    [[nodiscard]] std::size_t count_geometry_cubes() const noexcept;
+
+    /// At which child level the node is.
+    /// root = 0
+    [[nodiscard]] std::size_t grid_level(NodeIndex node) const;
+
+    /// Get the indentations of a Type::NORMAL node.
+    [[nodiscard]] const std::array<Indentation, Cube::EDGES> &indentations(NodeIndex node) const;
+
+    /// Index of the node in its parent octant, undefined for the root.
+    [[nodiscard]] std::uint8_t index_in_parent(NodeIndex node) const noexcept {
+        return static_cast<std::uint8_t>((node - 1) % Cube::SUB_CUBES);
+    }
+
+    /// The number of bytes which are used by the node arrays.
+    [[nodiscard]] std::size_t memory_usage() const noexcept;
+
+    /// Get the (face) neighbor of a node, see Cube::neighbor.
+    /// @param node The node to get the neighbor of
+    /// @param axis The axis on which to get the neighboring node
+    /// @param direction Whether to get the node which is above or below the node on the selected axis
+    /// @returns Same-sized neighbor if existent, else larger neighbor if exists, otherwise INVALID_NODE.
+    [[nodiscard]] NodeIndex neighbor(NodeIndex node, Cube::NeighborAxis axis, Cube::NeighborDirection direction) const;
+
+    /// Get the number of nodes.
+    [[nodiscard]] std::size_t node_count() const noexcept {
+        return m_types.size();
+    }
+
+    /// Get the parent of a node, INVALID_NODE for the root.
+    [[nodiscard]] NodeIndex parent(NodeIndex node) const {
+        return m_parents[node];
+    }
+
+    /// Collect the polygons of all geometry nodes into one continuous array.
+    [[nodiscard]] std::vector<Polygon> polygons() const;
+
+    /// Append the polygons of all geometry nodes to an existing array.
+    void polygons(std::vector<Polygon> &polygons) const;
+
+    [[nodiscard]] glm::vec3 position() const noexcept {
+        return m_position;
+    }
+
+    [[nodiscard]] float size() const noexcept {
+        return m_size;
+    }
+
+    /// Convert the octree back into a tree of cubes.
+    [[nodiscard]] std::shared_ptr<Cube> to_cube() const;
+
+    /// Get the type of a node.
+    [[nodiscard]] Cube::Type type(NodeIndex node) const {
+        return static_cast<Cube::Type>(m_types[node]);
+    }
+};
+
+} // namespace inexor::vulkan_renderer::octree
@@ -1,17 +1,21 @@
 #pragma once
 
 #include "inexor/vulkan-renderer/octree/indentation.hpp"
+#include "inexor/vulkan-renderer/octree/locational_code.hpp"
 
 #include <glm/vec3.hpp>
 
 #include <array>
 #include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
 // Forward declaration
 namespace inexor::vulkan_renderer::octree {
 class Cube;
+class WorldEditor;
+struct MemoryStatistics;
 } // namespace inexor::vulkan_renderer::octree
 
 // Forward declarations
@@ -20,6 +24,11 @@ class ByteStream;
 class NXOCParser;
 } // namespace inexor::vulkan_renderer::serialization
 
+// Forward declarations
+namespace inexor::vulkan_renderer::tools::allocators {
+class Arena;
+} // namespace inexor::vulkan_renderer::tools::allocators
+
 void swap(inexor::vulkan_renderer::octree::Cube &lhs, inexor::vulkan_renderer::octree::Cube &rhs) noexcept;
 
 namespace inexor::vulkan_renderer::octree {
@@ -27,11 +36,17 @@ namespace inexor::vulkan_renderer::octree {
 /// std::vector<Polygon> can probably replaced with an array.
 using Polygon = std::array<glm::vec3, 3>;
 
-using PolygonCache = std::shared_ptr<std::vector<Polygon>>;
+/// The polygons of a geometry cube. A cache is never changed after it has been created, a new one is created instead,
+/// so copies of a cube share the caches of the original.
+using PolygonCache = std::shared_ptr<const std::vector<Polygon>>;
 
 class Cube : public std::enable_shared_from_this<Cube> {
     friend void ::swap(Cube &lhs, Cube &rhs) noexcept;
     friend class serialization::NXOCParser;
+    friend class WorldEditor;
+    friend MemoryStatistics collect_memory_statistics(const Cube &cube);
+    friend std::shared_ptr<Cube> create_random_world(std::uint32_t max_depth, const glm::vec3 &position,
+                                                     std::optional<std::uint32_t> seed, std::size_t thread_count);
 
 public:
     /// Maximum of sub cubes (children)
@@ -62,11 +77,15 @@ private:
     float m_size{32};
     glm::vec3 m_position{0.0f, 0.0f, 0.0f};
 
-    /// Root cube is empty.
-    std::weak_ptr<Cube> m_parent;
+    /// The parent which owns this cube, nullptr for the root. Cubes which outlive their parent become a root.
+    Cube *m_parent{nullptr};
 
-    /// Index of this in m_parent.m_children; undefined behavior if root.
-    std::uint8_t m_index_in_parent{};
+    /// The arena of the clone this cube has been allocated in, nullptr if it has been allocated on its own. It belongs
+    /// to the memory of the cube rather than to its content, so it is neither swapped nor copied.
+    const tools::allocators::Arena *m_arena{nullptr};
+
+    /// The position in the tree, the child index of the last level is the index of this in m_parent->m_children.
+    LocationalCode m_code{};
 
     /// Indentations, should only be used if it is a geometry cube.
     std::array<Indentation, Cube::EDGES> m_indentations;
@@ -76,14 +95,40 @@ private:
     mutable PolygonCache m_polygon_cache;
     mutable bool m_polygon_cache_valid{false};
 
+    /// The cube itself has been edited since the last take_dirty_cubes().
+    bool m_dirty{false};
+    /// Any cube in the subtree (including this one) has been edited since the last take_dirty_cubes().
+    bool m_subtree_dirty{false};
+    /// Bounding box of all edited cubes in the subtree, only valid if m_subtree_dirty is set.
+    std::array<glm::vec3, 2> m_dirty_bounds{};
+
+    /// Change the type like set_type(), but without marking the cube as dirty. This is used to build a world from
+    /// scratch, which also allows to build disjoint subtrees on multiple threads.
+    void change_type(Type new_type);
+
+    /// Reset the dirty flags of this cube and all of its children.
+    void clear_dirty();
+    /// Append all topmost edited cubes of the subtree and reset their dirty flags.
+    void collect_dirty_cubes(std::vector<std::shared_ptr<Cube>> &cubes);
+
+    /// Append the polygon caches of this cube and all of its children in post-order.
+    void collect_polygons(std::vector<PolygonCache> &polygons, bool update_invalid) const;
+
+    /// Invalidate the polygon cache and mark this cube and all of its parents as dirty.
+    void mark_dirty();
+
+    /// Turn this cube into the root of its subtree, which is required if it outlives its parent.
+    void detach();
+
     /// Removes all children recursive.
     void remove_children();
 
-    /// Get the root to this cube.
-    [[nodiscard]] std::shared_ptr<Cube> root();
     /// Get the vertices of this cube. Use only on geometry cubes.
     [[nodiscard]] std::array<glm::vec3, 8> vertices() const noexcept;
 
+    /// Move the children to their position after they have been reordered, which also updates their locational codes.
+    void place_children();
+
     /// Optimized implementations of 90°, 180° and 270° rotations.
     template <int Rotations>
     void rotate(const RotationAxis::Type &axis);
@@ -94,11 +139,13 @@ public:
     /// Create an empty cube.
     Cube(float size, const glm::vec3 &position);
     /// Create an empty cube.
-    Cube(std::weak_ptr<Cube> parent, std::uint8_t index, float size, const glm::vec3 &position);
+    /// @param parent The parent which owns the cube
+    /// @param index The index of the cube in the children of its parent
+    Cube(Cube *parent, std::uint8_t index, float size, const glm::vec3 &position);
     /// Use clone() to create an independent copy of a cube.
     Cube(const Cube &rhs);
     Cube(Cube &&rhs) noexcept;
-    ~Cube() = default;
+    ~Cube();
 
     Cube &operator=(Cube other);
     Cube &operator=(Cube &&) noexcept;
@@ -109,6 +156,11 @@ public:
     /// Get child.
     std::shared_ptr<const Cube> operator[](std::size_t idx) const; // NOLINT
 
+    /// Get an ancestor of this cube.
+    /// @param level The level of the ancestor, see grid_level()
+    /// @return The ancestor, this cube if the level is its own level, or nullptr if the level is deeper
+    [[nodiscard]] const Cube *ancestor(std::size_t level) const noexcept;
+
     [[nodiscard]] std::array<glm::vec3, 2> bounding_box() const {
         return {m_position, {m_position.x + m_size, m_position.y + m_size, m_position.z + m_size}};
     }
@@ -121,30 +173,63 @@ public:
     [[nodiscard]] const std::array<std::shared_ptr<Cube>, Cube::SUB_CUBES> &children() const;
 
     /// Clone a cube, which has no relations to the current one or its children.
-    /// It will be a root cube.
+    /// It will be a root cube. All cubes of the clone are allocated in a single block of memory, which is freed once
+    /// all of them have been destroyed, and the polygon caches are shared with the original.
     [[nodiscard]] std::shared_ptr<Cube> clone() const;
 
     /// Count the number of Type::SOLID and Type::NORMAL cubes.
     [[nodiscard]] std::size_t count_geometry_cubes() const noexcept;
 
+    /// Find the smallest cube of this tree which contains the cube of a locational code.
+    /// The search starts at the deepest common ancestor of this cube and the code, so codes close to this cube are
+    /// found without visiting the root.
+    /// @param code The locational code, relative to the root of this tree
+    /// @return The cube of the code if it exists, otherwise the leaf which contains it
+    [[nodiscard]] const Cube *find(const LocationalCode &code) const noexcept;
+    [[nodiscard]] Cube *find(const LocationalCode &code) noexcept {
+        return const_cast<Cube *>(std::as_const(*this).find(code));
+    }
+
+    /// Same as neighbor(), but without taking a reference to the neighbor.
+    [[nodiscard]] const Cube *find_neighbor(NeighborAxis axis, NeighborDirection direction) const noexcept;
+
     /// At which child level this cube is.
     /// root cube = 0
-    [[nodiscard]] std::size_t grid_level() const noexcept;
+    [[nodiscard]] std::size_t grid_level() const noexcept {
+        return m_code.level();
+    }
 
     /// Indent a specific edge by steps.
     /// @param positive_direction Indent in  positive axis direction.
     void indent(std::uint8_t edge_id, bool positive_direction, std::uint8_t steps);
 
+    /// Get the bounding box of all cubes in this subtree which have been edited since the last take_dirty_cubes().
+    /// @return std::nullopt if nothing has been edited
+    [[nodiscard]] std::optional<std::array<glm::vec3, 2>> dirty_bounds() const noexcept;
+
     /// Get indentations.
     [[nodiscard]] std::array<Indentation, Cube::EDGES> indentations() const noexcept;
 
     /// Invalidate polygon cache.
     void invalidate_polygon_cache() const;
 
+    /// Has anything in this subtree been edited since the last take_dirty_cubes().
+    [[nodiscard]] bool is_dirty() const noexcept {
+        return m_subtree_dirty;
+    }
+
     /// Is the current cube root.
-    [[nodiscard]] bool is_root() const noexcept;
+    [[nodiscard]] bool is_root() const noexcept {
+        return m_parent == nullptr;
+    }
+
+    /// The position of this cube in its tree.
+    [[nodiscard]] const LocationalCode &locational_code() const noexcept {
+        return m_code;
+    }
 
-    /// Get the (face) neighbor of this cube by using a similar implementation to Samets "OT_GTEQ_FACE_NEIGHBOR(P,I)".
+    /// Get the (face) neighbor of this cube like Samets "OT_GTEQ_FACE_NEIGHBOR(P,I)", but instead of recording the path
+    /// to the common ancestor of the cube and its neighbor, the path to the neighbor is taken from its locational code.
     /// @brief Get the (face) neighbor of this cube.
     /// @param axis The axis on which to get the neighboring cube
     /// @param direction Whether to get the cube which is above or below this cube on the selected axis
@@ -155,6 +240,15 @@ public:
     /// Computer Vision, Graphics, and Image Processing. 46 (3), 367-386.
     [[nodiscard]] std::shared_ptr<Cube> neighbor(NeighborAxis axis, NeighborDirection direction);
 
+    /// Collect all the caches like polygons(), but process independent subtrees on multiple threads.
+    /// The tree is split into subtrees at the given depth, the result has the same order as the one of polygons().
+    /// @param update_invalid If true it will update invalid polygon caches.
+    /// @param split_depth The depth relative to this cube at which the tree is split into subtrees
+    /// @param thread_count The number of threads to use, tools::default_thread_count() if 0
+    /// @warning The tree must not be modified by other threads while this function is running.
+    [[nodiscard]] std::vector<PolygonCache> parallel_polygons(bool update_invalid = false, std::size_t split_depth = 2,
+                                                              std::size_t thread_count = 0) const;
+
     /// Recursive way to collect all the caches.
     /// @param update_invalid If true it will update invalid polygon caches.
     [[nodiscard]] std::vector<PolygonCache> polygons(bool update_invalid = false) const;
@@ -168,34 +262,80 @@ public:
     /// @param rotations Value does not need to be adjusted beforehand. (e.g. mod 4)
     void rotate(const RotationAxis::Type &axis, int rotations);
 
+    /// Get the root of the tree of this cube.
+    [[nodiscard]] const Cube &root() const noexcept;
+
     /// Set an indent by the edge id.
     void set_indent(std::uint8_t edge_id, Indentation indentation);
 
-    /// Set a new type.
+    /// Set a new type. Octants whose children become uniform are not collapsed, WorldEditor takes care of that.
+    /// @exception std::length_error The cube is subdivided, but it is already at LocationalCode::MAX_LEVEL
     void set_type(Type new_type);
 
     [[nodiscard]] float size() const noexcept {
         return m_size;
     }
 
+    /// Get all cubes of this subtree which have been edited since the last call and reset the dirty state.
+    /// Only the topmost edited cubes are returned: if an octant itself has been edited (e.g. subdivided or rotated),
+    /// its whole subtree has to be considered as changed. Only the edited branches of the tree are visited.
+    /// The cubes are returned in the same order as polygons() traverses the tree.
+    [[nodiscard]] std::vector<std::shared_ptr<Cube>> take_dirty_cubes();
+
+    /// Get the 12 triangles of a geometry cube as indices into its corner vertices.
+    /// For Type::NORMAL the diagonal of each side is chosen such that the side becomes convex.
+    /// @param type The cube type
+    /// @param indentations The indentations of the cube, only used for Type::NORMAL
+    [[nodiscard]] static std::array<std::array<std::uint8_t, 3>, Cube::EDGES>
+    triangle_corners(Type type, const std::array<Indentation, Cube::EDGES> &indentations) noexcept;
+
     /// Get type.
     [[nodiscard]] Type type() const noexcept;
 
     /// TODO: in special cases some polygons have no surface, if completely surrounded by others
     /// \warning Will update the cache even if it is considered as valid.
     void update_polygon_cache() const;
+
+    /// Get the vertices of a geometry cube (Type::SOLID or Type::NORMAL).
+    /// @param type The cube type
+    /// @param position The position of the cube
+    /// @param size The size of the cube
+    /// @param indentations The indentations of the cube, only used for Type::NORMAL
+    /// @return The 8 corner vertices in corner order
+    [[nodiscard]] static std::array<glm::vec3, 8> vertices(Type type, const glm::vec3 &position, float size,
+                                                         const std::array<Indentation, Cube::EDGES> &indentations);
 };
 
-/// @brief Construct a randomly generated cube world.
+/// The content of a leaf of a randomly generated cube world, see random_world_cube().
+struct RandomWorldCube {
+    Cube::Type type{Cube::Type::EMPTY};
+    /// The indentations, only used if the cube is Type::NORMAL.
+    std::array<Indentation, Cube::EDGES> indentations{};
+};
+
+/// Generate a leaf of a randomly generated cube world.
+/// The leaf only depends on the seed and its locational code, so the leaves can be generated in any order and on any
+/// thread. This is what create_random_world() uses for every leaf, which allows to write the same world directly into
+/// a stream, see serialization::NXOCParser::serialize_random_world().
 /// Using the following probabilities:
 /// empty: 30%
 /// solid: 30%
 /// normal: 40%
 /// The number of indentations are evenly distributed. Empty normal cubes are not generated.
+/// @param seed The seed of the world
+/// @param code The locational code of the leaf
+[[nodiscard]] RandomWorldCube random_world_cube(std::uint32_t seed, const LocationalCode &code) noexcept;
+
+/// @brief Construct a randomly generated cube world.
+/// All cubes up to the maximum depth are octants, their children are leaves generated by random_world_cube(). The world
+/// is the same for a seed, regardless of the number of threads which build it.
 /// @param max_depth The maximum of nested octants.
 /// @param position The position where the root cube is placed.
-/// @param seed The seed used for the random number generator.
+/// @param seed The seed used for the random number generator, a random seed if std::nullopt.
+/// @param thread_count The number of threads to build the world with, 0 uses tools::default_thread_count().
+/// @exception std::invalid_argument The maximum depth is not smaller than LocationalCode::MAX_LEVEL
 std::shared_ptr<octree::Cube> create_random_world(std::uint32_t max_depth, const glm::vec3 &position,
-                                                  std::optional<std::uint32_t> seed = std::nullopt);
+                                                  std::optional<std::uint32_t> seed = std::nullopt,
+                                                  std::size_t thread_count = 0);
 
 } // namespace inexor::vulkan_renderer::octree
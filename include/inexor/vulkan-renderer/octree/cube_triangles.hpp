@@ -0,0 +1,32 @@
+#pragma once
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// Helpers which are shared by the queries of octrees (RayQuery, ShapeQuery), they are not meant to be used elsewhere.
+namespace inexor::vulkan_renderer::octree::detail {
+
+/// The bit of every axis in the index of a child.
+inline constexpr std::array<std::uint8_t, 3> AXIS_BITS{4, 2, 1};
+
+/// Visit the triangles of a Type::NORMAL cube, which are the ones of its polygon cache. The cache itself is not used, as
+/// it is filled lazily, which would be a data race when running queries on multiple threads.
+/// @param vertices The corner vertices of the cube, see Cube::vertices
+/// @param indentations The indentations of the cube
+/// @param visitor Called with the index and the three corners of every triangle
+template <typename Visitor>
+void for_each_normal_cube_triangle(const std::array<glm::vec3, 8> &vertices,
+                                   const std::array<Indentation, Cube::EDGES> &indentations, Visitor &&visitor) {
+    const auto corners = Cube::triangle_corners(Cube::Type::NORMAL, indentations);
+    for (std::size_t triangle = 0; triangle < Cube::EDGES; triangle++) {
+        visitor(triangle, vertices[corners[triangle][0]], vertices[corners[triangle][1]],
+                vertices[corners[triangle][2]]);
+    }
+}
+
+} // namespace inexor::vulkan_renderer::octree::detail
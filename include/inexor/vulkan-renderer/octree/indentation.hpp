@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cassert>
 #include <cstdint>
 
 namespace inexor::vulkan_renderer::octree {
@@ -7,15 +9,31 @@ namespace inexor::vulkan_renderer::octree {
 class Indentation {
 public:
     static constexpr std::uint8_t MAX{8};
+    /// The number of distinct indentations, uid() is always smaller than this.
+    static constexpr std::uint8_t UID_COUNT{45};
 
 private:
+    /// The indentation of every uid. There is an entry for every 6 bit value, the ones from UID_COUNT on hold the
+    /// default indentation, see from_packed_uid().
+    static const std::array<Indentation, 64> UID_TABLE;
+
     std::uint8_t m_start{0};
     std::uint8_t m_end{Indentation::MAX};
 
 public:
     Indentation() = default;
-    Indentation(std::uint8_t start, std::uint8_t end) noexcept;
-    explicit Indentation(std::uint8_t uid) noexcept;
+    constexpr Indentation(const std::uint8_t start, const std::uint8_t end) noexcept : m_start(start), m_end(end) {}
+    /// Create the indentation with the given uid, which is a single table lookup.
+    explicit Indentation(const std::uint8_t uid) noexcept {
+        assert(uid < UID_COUNT);
+        *this = UID_TABLE[uid];
+    }
+    /// Get the indentation of a 6 bit uid from a packed stream without validating it, values from UID_COUNT on give
+    /// the default indentation. This allows to decode many uids without branches and to validate them afterwards.
+    [[nodiscard]] static const Indentation &from_packed_uid(const std::uint8_t uid) noexcept {
+        assert(uid < UID_TABLE.size());
+        return UID_TABLE[uid];
+    }
     bool operator==(const Indentation &rhs) const;
     bool operator!=(const Indentation &rhs) const;
 
@@ -49,7 +67,10 @@ public:
     /// Absolute value of start.
     [[nodiscard]] std::uint8_t start_abs() const noexcept;
 
-    [[nodiscard]] std::uint8_t uid() const;
+    /// A unique number in [0, UID_COUNT) which fits into 6 bits.
+    [[nodiscard]] std::uint8_t uid() const {
+        return static_cast<std::uint8_t>(10 * m_start + (m_end - m_start) - (m_start * m_start + m_start) / 2);
+    }
 };
 
 } // namespace inexor::vulkan_renderer::octree
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace inexor::vulkan_renderer::octree {
+
+/// A triangle mesh in which every distinct vertex position is only stored once.
+struct IndexedMesh {
+    std::vector<glm::vec3> vertices;
+    std::vector<std::uint32_t> indices;
+};
+
+/// Builds an IndexedMesh from triangles.
+/// Vertices are deduplicated with an open addressing hash table which stores indices into the vertex array, so every
+/// vertex position is only hashed once. Positions are compared bitwise, -0.0 and 0.0 are treated as equal.
+class IndexedMeshBuilder {
+public:
+    /// Marks an empty slot in the hash table.
+    static constexpr std::uint32_t INVALID_INDEX{std::numeric_limits<std::uint32_t>::max()};
+
+private:
+    IndexedMesh m_mesh;
+    /// Indices into the vertex array, the size is always a power of two.
+    std::vector<std::uint32_t> m_table;
+
+    /// Double the size of the hash table and insert all vertices again.
+    void grow_table();
+
+public:
+    /// Create a builder.
+    /// @param expected_vertices The number of distinct vertices to reserve memory for
+    explicit IndexedMeshBuilder(std::size_t expected_vertices = 0);
+
+    /// Add the triangles of a box, the corners are only looked up if they are used by a triangle.
+    /// @param corners The 8 corners of the box in the order of Cube::vertices
+    /// @param triangles The triangles to add as indices into the corners, see Cube::triangle_corners
+    void add_box_triangles(const std::array<glm::vec3, 8> &corners,
+                           std::span<const std::array<std::uint8_t, 3>> triangles);
+
+    /// Add the triangles of a geometry cube and all of its children.
+    void add_cube(const Cube &cube);
+
+    /// Add the triangles of another mesh, its vertices are deduplicated against the vertices added so far.
+    /// Adding the meshes of consecutive parts of a model gives the same mesh as adding all triangles to one builder.
+    void add_mesh(const IndexedMesh &mesh);
+
+    /// Add a triangle.
+    void add_triangle(const Polygon &polygon);
+
+    /// Get the index of a vertex position, the vertex is added if it does not exist yet.
+    [[nodiscard]] std::uint32_t add_vertex(const glm::vec3 &position);
+
+    /// Move the mesh out of the builder and reset the builder.
+    [[nodiscard]] IndexedMesh build();
+
+    [[nodiscard]] const IndexedMesh &mesh() const noexcept {
+        return m_mesh;
+    }
+};
+
+} // namespace inexor::vulkan_renderer::octree
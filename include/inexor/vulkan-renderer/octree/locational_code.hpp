@@ -0,0 +1,114 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace inexor::vulkan_renderer::octree {
+
+/// The position of a cube in an octree as a locational code (Morton key).
+/// The code is the sequence of child indices on the path from the root to the cube, 3 bits per level with the first
+/// child index in the highest bits. A leading 1 bit marks the level of the code, so the root is 1 and its children are
+/// 0b1000 to 0b1111. As the child indices have the bits x = 4, y = 2 and z = 1, the path bits interleave the integer
+/// coordinates of the cube on the grid of its level. This answers parent, ancestor and neighbor queries with a few bit
+/// operations instead of walking the tree.
+class LocationalCode {
+public:
+    /// The deepest level which fits into a 64 bit code.
+    static constexpr std::size_t MAX_LEVEL{21};
+
+private:
+    /// Every third bit starting at bit 0, which selects the z bits of the path.
+    static constexpr std::uint64_t Z_BITS{0x1249249249249249};
+
+    std::uint64_t m_code{1};
+
+    constexpr explicit LocationalCode(const std::uint64_t code) noexcept : m_code(code) {}
+
+    /// The path bits below the level marker.
+    [[nodiscard]] constexpr std::uint64_t path_mask() const noexcept {
+        return (std::uint64_t{1} << (3 * level())) - 1;
+    }
+
+public:
+    /// The code of the root.
+    constexpr LocationalCode() noexcept = default;
+
+    constexpr bool operator==(const LocationalCode &) const noexcept = default;
+
+    /// Get the code of an ancestor.
+    /// @param level The level of the ancestor, must not be greater than level()
+    [[nodiscard]] constexpr LocationalCode ancestor(const std::size_t level) const noexcept {
+        assert(level <= this->level());
+        return LocationalCode(m_code >> (3 * (this->level() - level)));
+    }
+
+    /// Get the code of a child.
+    /// @param index The child index, must be smaller than 8
+    /// @note The level of the code must be smaller than MAX_LEVEL.
+    [[nodiscard]] constexpr LocationalCode child(const std::size_t index) const noexcept {
+        assert(index < 8 && level() < MAX_LEVEL);
+        return LocationalCode((m_code << 3) | index);
+    }
+
+    /// The index of the cube in its parent, undefined for the root.
+    [[nodiscard]] constexpr std::uint8_t child_index() const noexcept {
+        return static_cast<std::uint8_t>(m_code & 7u);
+    }
+
+    /// The index of the ancestor at a level in its parent, which is the child to descend into from level - 1.
+    /// @param level The level of the ancestor, must be in the range [1, level()]
+    [[nodiscard]] constexpr std::uint8_t child_index(const std::size_t level) const noexcept {
+        assert(level >= 1 && level <= this->level());
+        return static_cast<std::uint8_t>((m_code >> (3 * (this->level() - level))) & 7u);
+    }
+
+    /// The level of the deepest common ancestor of two codes.
+    [[nodiscard]] static constexpr std::size_t common_level(const LocationalCode lhs,
+                                                            const LocationalCode rhs) noexcept {
+        const std::size_t level = lhs.level() < rhs.level() ? lhs.level() : rhs.level();
+        const std::uint64_t difference = lhs.ancestor(level).m_code ^ rhs.ancestor(level).m_code;
+        return level - (static_cast<std::size_t>(std::bit_width(difference)) + 2) / 3;
+    }
+
+    [[nodiscard]] constexpr bool is_root() const noexcept {
+        return m_code == 1;
+    }
+
+    /// The level in the tree, the root has level 0.
+    [[nodiscard]] constexpr std::size_t level() const noexcept {
+        return (static_cast<std::size_t>(std::bit_width(m_code)) - 1) / 3;
+    }
+
+    /// Get the code of the face neighbor of equal size.
+    /// The coordinate on the axis is incremented or decremented on the interleaved path bits directly: the bits of the
+    /// other axes are masked out (or set for incrementing), so the carry propagates through the bits of this axis only.
+    /// @param axis_bit The bit of the axis in a child index: 2 for x, 1 for y and 0 for z, see Cube::NeighborAxis
+    /// @param positive Whether to get the neighbor on the positive or the negative side of the axis
+    /// @return The code of the neighbor, or std::nullopt if the neighbor would be outside of the root
+    [[nodiscard]] constexpr std::optional<LocationalCode> neighbor(const std::size_t axis_bit,
+                                                                   const bool positive) const noexcept {
+        assert(axis_bit < 3);
+        const std::uint64_t axis_mask = (Z_BITS << axis_bit) & path_mask();
+        const std::uint64_t coordinate = m_code & axis_mask;
+        if (coordinate == (positive ? axis_mask : 0)) {
+            return std::nullopt;
+        }
+        const std::uint64_t moved = (positive ? (coordinate | ~axis_mask) + 1 : coordinate - 1) & axis_mask;
+        return LocationalCode((m_code & ~axis_mask) | moved);
+    }
+
+    /// Get the code of the parent, the root is its own parent.
+    [[nodiscard]] constexpr LocationalCode parent() const noexcept {
+        return is_root() ? *this : LocationalCode(m_code >> 3);
+    }
+
+    /// The raw code including the level marker bit.
+    [[nodiscard]] constexpr std::uint64_t value() const noexcept {
+        return m_code;
+    }
+};
+
+} // namespace inexor::vulkan_renderer::octree
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace inexor::vulkan_renderer::octree {
+
+/// The number of values of Cube::Type, which index the cube counts of MemoryStatistics.
+inline constexpr std::size_t CUBE_TYPE_COUNT{4};
+
+/// The memory which is used by an octree.
+/// The byte sizes are lower bounds of the heap memory which an octree keeps alive: they include the control blocks of
+/// std::make_shared and the whole block of memory of a clone, but neither the bookkeeping nor the rounding of the heap.
+struct MemoryStatistics {
+    /// The number of cubes per type, indexed by the value of Cube::Type.
+    std::array<std::size_t, CUBE_TYPE_COUNT> cubes_per_type{};
+    /// The number of cubes per level and type, the cube the statistics are collected for is on level 0.
+    std::vector<std::array<std::size_t, CUBE_TYPE_COUNT>> cubes_per_level;
+    /// The memory of the cubes and their shared_ptr control blocks. The cubes of a clone are counted with the block
+    /// they have been allocated in, which stays allocated until all of them have been destroyed.
+    std::size_t node_bytes{0};
+    /// The memory of the indentations, which is part of node_bytes as every cube stores Cube::EDGES indentations.
+    std::size_t indentation_bytes{0};
+    /// The part of indentation_bytes which belongs to cubes which are not Type::NORMAL and therefore never used.
+    std::size_t unused_indentation_bytes{0};
+    /// The number of cubes which hold a polygon cache.
+    std::size_t polygon_caches{0};
+    /// The memory of the polygon caches. A cache which is shared, e.g. with a clone, is counted in full by every octree
+    /// which holds it, so the sum over octrees which share caches counts them more than once.
+    std::size_t polygon_cache_bytes{0};
+    /// The number of Type::SOLID and Type::NORMAL cubes whose polygon cache has to be rebuilt.
+    std::size_t invalid_polygon_caches{0};
+
+    /// The number of cubes of all types.
+    [[nodiscard]] std::size_t cubes() const noexcept;
+
+    /// The memory of the cubes and their polygon caches.
+    [[nodiscard]] std::size_t total_bytes() const noexcept {
+        return node_bytes + polygon_cache_bytes;
+    }
+
+    /// Add the statistics of another octree, e.g. to get the memory of all worlds.
+    MemoryStatistics &operator+=(const MemoryStatistics &rhs);
+};
+
+/// Collect the memory statistics of a cube and all of its children.
+/// This visits every cube once without allocating memory per cube, so it can be polled each frame for small worlds.
+/// @param cube The cube, usually the root of a world
+[[nodiscard]] MemoryStatistics collect_memory_statistics(const Cube &cube);
+
+} // namespace inexor::vulkan_renderer::octree
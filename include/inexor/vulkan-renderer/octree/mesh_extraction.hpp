@@ -0,0 +1,85 @@
+#pragma once
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace inexor::vulkan_renderer::octree {
+
+// Forward declaration
+class IndexedMeshBuilder;
+
+/// Options which control how the geometry of an octree is turned into triangles.
+struct MeshExtractionSettings {
+    /// Drop the faces which lie on the side of a cube and are covered by a Type::SOLID neighbor of equal or larger
+    /// size. Such faces can never be seen, because they are always covered by the neighbor.
+    bool cull_hidden_faces{true};
+    /// Merge adjacent coplanar faces of Type::SOLID cubes into larger rectangles, like greedy meshing does for voxels.
+    /// Only faces of cubes on the same octree level are merged.
+    bool merge_coplanar_faces{false};
+    /// The level below the extracted cube on which octants are collapsed into a single cube, which gives a coarser mesh
+    /// for distant geometry. The extracted cube is on level 0. A collapsed octant becomes a Type::SOLID cube if at
+    /// least solid_fill_ratio of its volume is filled, otherwise it is left out.
+    std::optional<std::size_t> max_depth{};
+    /// The filled part of the volume of an octant from which it is collapsed into a Type::SOLID cube.
+    float solid_fill_ratio{0.5f};
+    /// The number of threads which extract the subtrees below split_depth, tools::default_thread_count() if 0. The
+    /// extracted mesh is the same for every number of threads.
+    std::size_t thread_count{1};
+    /// The level below the extracted cube at which the tree is split into subtrees, see Cube::parallel_polygons.
+    std::size_t split_depth{2};
+};
+
+/// Statistics which are collected during mesh extraction.
+struct MeshStatistics {
+    /// The number of Type::SOLID and Type::NORMAL cubes which have been visited.
+    std::size_t geometry_cubes{0};
+    /// The number of triangles which are part of the extracted mesh.
+    std::size_t emitted_triangles{0};
+    /// The number of triangles which have been dropped because they are hidden.
+    std::size_t culled_triangles{0};
+    /// The number of triangles which have been saved by merging coplanar faces.
+    std::size_t merged_triangles{0};
+    /// The number of octants which have been collapsed into a single cube because of MeshExtractionSettings::max_depth.
+    std::size_t collapsed_octants{0};
+
+    MeshStatistics &operator+=(const MeshStatistics &other) noexcept {
+        geometry_cubes += other.geometry_cubes;
+        emitted_triangles += other.emitted_triangles;
+        culled_triangles += other.culled_triangles;
+        merged_triangles += other.merged_triangles;
+        collapsed_octants += other.collapsed_octants;
+        return *this;
+    }
+};
+
+/// The triangles of an octree.
+struct OctreeMesh {
+    std::vector<Polygon> polygons;
+    MeshStatistics statistics;
+};
+
+/// Extract the triangles of a cube and all of its children.
+/// In contrast to Cube::polygons(), which returns the polygon cache of every geometry cube, this takes the neighbors of
+/// each cube into account. The neighbors are passed down while traversing the tree, so no neighbor search is needed.
+/// Like Cube::parallel_polygons(), independent subtrees are extracted on multiple threads if
+/// MeshExtractionSettings::thread_count is not 1.
+/// @note Faces on the outside of the given cube are never culled, as its neighbors are not taken into account.
+/// @param cube The cube to extract the triangles from, usually the root of a world
+/// @param settings The extraction settings
+/// @return The triangles and the extraction statistics. The triangles are in the same order as Cube::polygons(),
+/// except for merged faces, which are appended at the end.
+[[nodiscard]] OctreeMesh extract_mesh(const Cube &cube, const MeshExtractionSettings &settings = {});
+
+/// Extract the triangles of a cube and all of its children into an indexed mesh.
+/// The corners of every cube are only looked up once, no intermediate triangle array is created. Subtrees which are
+/// extracted on other threads are built into meshes of their own, which are added to the builder afterwards.
+/// @param cube The cube to extract the triangles from, usually the root of a world
+/// @param builder The builder to add the triangles to, it can be used for multiple worlds
+/// @param settings The extraction settings
+/// @return The extraction statistics
+MeshStatistics extract_mesh(const Cube &cube, IndexedMeshBuilder &builder, const MeshExtractionSettings &settings = {});
+
+} // namespace inexor::vulkan_renderer::octree
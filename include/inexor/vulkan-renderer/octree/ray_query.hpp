@@ -0,0 +1,113 @@
+#pragma once
+
+#include "inexor/vulkan-renderer/octree/compact_octree.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace inexor::vulkan_renderer::octree {
+
+/// The first cube which is hit by a ray.
+struct RayHit {
+    /// The cube which has been hit, a Type::SOLID or Type::NORMAL cube or a Type::OCTANT cube on the maximum depth. Only
+    /// set if the query is for a Cube.
+    /// @warning The pointer is only valid as long as the octree is not changed.
+    const Cube *cube{nullptr};
+    /// The node which has been hit. Only set if the query is for a CompactOctree.
+    CompactOctree::NodeIndex node{CompactOctree::INVALID_NODE};
+    /// The ray enters the cube at origin + t * direction. If the origin is inside of the cube, t is 0. For Type::NORMAL
+    /// cubes, this is where the ray hits the first triangle of the cube.
+    float t{0.0f};
+    /// The normal of the face through which the ray enters the cube, or zero if the origin is inside of the cube. For
+    /// Type::NORMAL cubes, this is the normal of the triangle which is hit, facing the ray.
+    glm::vec3 normal{0.0f, 0.0f, 0.0f};
+    /// The octree level of the cube, the root is on level 0.
+    std::uint32_t level{0};
+};
+
+/// Many rays in structure of arrays layout, which is the layout the packet traversal of RayQuery works on.
+struct RayBatch {
+    std::vector<float> origin_x;
+    std::vector<float> origin_y;
+    std::vector<float> origin_z;
+    std::vector<float> direction_x;
+    std::vector<float> direction_y;
+    std::vector<float> direction_z;
+
+    /// Append a ray.
+    /// @param origin The start of the ray
+    /// @param direction The direction of the ray, it does not need to be normalized
+    void add(const glm::vec3 &origin, const glm::vec3 &direction);
+
+    /// Reserve memory for a number of rays.
+    /// @param size The number of rays
+    void reserve(std::size_t size);
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return origin_x.size();
+    }
+};
+
+/// Casts rays through an octree.
+/// The traversal is the parametric algorithm by Revelles et al.: the ray parameters at which a ray crosses the planes
+/// of a cube are split in half for its children, so no intersection tests are needed below the root. The children of
+/// an octant are visited in the order in which the ray passes through them and the traversal stops at the first hit.
+/// A ray which runs exactly along a plane between two cubes belongs to the cube on the upper side of the plane.
+/// Type::NORMAL cubes are hit where the ray hits one of their 12 triangles, which are the triangles of their polygon
+/// cache. Both sides of the triangles are hit, so a ray which starts inside of a Type::NORMAL cube hits it where it
+/// leaves it.
+class RayQuery {
+private:
+    const Cube *m_root{nullptr};
+    const CompactOctree *m_compact_octree{nullptr};
+    std::optional<std::uint32_t> m_max_depth;
+
+public:
+    /// The number of rays which are traversed together by the batch version of cast().
+    static constexpr std::size_t RAY_PACKET_SIZE{8};
+
+    /// Create a query for an octree.
+    /// @warning The octree must outlive the query.
+    /// @param root The root of the octree
+    /// @param max_depth The maximum level to descend to. Type::OCTANT cubes on that level are hit as if they were
+    /// Type::SOLID, which allows to select cubes of a certain grid size.
+    explicit RayQuery(const Cube &root, std::optional<std::uint32_t> max_depth = std::nullopt)
+        : m_root(&root), m_max_depth(max_depth) {}
+
+    /// Create a query for a compact octree, the hits refer to nodes instead of cubes.
+    /// @warning The octree must outlive the query.
+    /// @param octree The octree
+    /// @param max_depth The maximum level to descend to, see the overload for Cube
+    explicit RayQuery(const CompactOctree &octree, std::optional<std::uint32_t> max_depth = std::nullopt)
+        : m_compact_octree(&octree), m_max_depth(max_depth) {}
+
+    /// Find the first cube which is hit by a ray.
+    /// @param origin The start of the ray
+    /// @param direction The direction of the ray, it does not need to be normalized
+    /// @param max_distance Cubes which the ray enters after origin + max_distance * direction are not hit
+    /// @return The hit, or std::nullopt if the ray does not hit any cube
+    [[nodiscard]] std::optional<RayHit> cast(const glm::vec3 &origin, const glm::vec3 &direction,
+                                             float max_distance = std::numeric_limits<float>::max()) const;
+
+    /// Find the first cube which is hit by each of many rays.
+    /// The rays are grouped into packets of RAY_PACKET_SIZE rays whose directions have the same signs, and every
+    /// packet is traversed together, so each cube is only fetched once per packet. Large batches are split across
+    /// threads.
+    /// @note A ray which passes exactly through an edge or a corner shared by several cubes may hit another one of
+    /// these cubes than the single ray version of cast().
+    /// @param rays The rays
+    /// @param max_distance Cubes which a ray enters after origin + max_distance * direction are not hit
+    /// @param thread_count The number of threads to use for large batches, tools::default_thread_count() if 0
+    /// @return The hit of every ray, in the order of the rays
+    /// @exception std::invalid_argument The arrays of the batch have different sizes
+    [[nodiscard]] std::vector<std::optional<RayHit>> cast(const RayBatch &rays,
+                                                          float max_distance = std::numeric_limits<float>::max(),
+                                                          std::size_t thread_count = 0) const;
+};
+
+} // namespace inexor::vulkan_renderer::octree
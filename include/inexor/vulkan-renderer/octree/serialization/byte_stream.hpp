@@ -1,58 +1,147 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
+// Forward declaration
+namespace inexor::vulkan_renderer::octree {
+class Indentation;
+} // namespace inexor::vulkan_renderer::octree
+
 namespace inexor::vulkan_renderer::serialization {
 
+/// A sequence of bytes, which is either owned by the stream or a view of memory which is owned elsewhere.
+/// Views are not copied when the stream is copied, which makes loading from a memory mapped file zero-copy.
 class ByteStream {
 protected:
     std::vector<std::uint8_t> m_buffer;
-
-    /// Read from file.
-    [[nodiscard]] static std::vector<std::uint8_t> read_file(const std::filesystem::path &path);
+    /// The memory the stream reads from instead of m_buffer.
+    std::optional<std::span<const std::uint8_t>> m_view;
+    /// Keeps the memory of m_view alive if the stream owns it, e.g. the mapping of a file.
+    std::shared_ptr<const void> m_view_owner;
 
 public:
     ByteStream() = default;
     explicit ByteStream(std::vector<std::uint8_t> buffer);
 
-    /// Read from file.
+    /// Create a view of memory which is owned by the caller.
+    /// @warning The memory must stay valid as long as the stream or any copy of it is used.
+    /// @param data The memory to read from
+    explicit ByteStream(std::span<const std::uint8_t> data);
+
+    /// Map a file into memory, the file is not read until the bytes are accessed.
+    /// @param path The path of the file
+    /// @exception std::runtime_error The file could not be opened or mapped
     explicit ByteStream(const std::filesystem::path &path);
 
-    [[nodiscard]] const std::vector<std::uint8_t> &buffer() const;
+    [[nodiscard]] std::span<const std::uint8_t> data() const;
 
     [[nodiscard]] std::size_t size() const;
 };
 
 class ByteStreamReader {
 private:
-    const ByteStream &m_stream;
-
     /// Stream iterator.
-    std::vector<std::uint8_t>::const_iterator m_iter;
+    const std::uint8_t *m_iter;
+    const std::uint8_t *m_end;
 
     void check_end(std::size_t size) const;
 
 public:
+    /// @warning The stream must not be modified or destroyed while it is read.
     explicit ByteStreamReader(const ByteStream &stream);
+    explicit ByteStreamReader(std::span<const std::uint8_t> data);
 
     /// Generic read method.
     template <typename T, typename... Args>
     [[nodiscard]] T read(const Args &...);
 
+    /// Read packed indentations, every 3 bytes hold the 6 bit uids of 4 indentations.
+    /// This decodes the indentations of many cubes at once, read<std::array<octree::Indentation, 12>> reads the
+    /// indentations of one cube.
+    /// @param indentations The indentations to read into, the number of indentations must be a multiple of 4
+    /// @exception std::invalid_argument The number of indentations is not a multiple of 4
+    /// @exception std::runtime_error The stream ends early or contains an invalid uid
+    void read_indentations(std::span<octree::Indentation> indentations);
+
     [[nodiscard]] std::size_t remaining() const;
 
     /// Skip 'size' bytes (std::uint8_t).
     void skip(std::size_t size);
 };
 
+/// The destination of a ByteStreamWriter, which receives the written bytes in chunks.
+class ByteSink {
+public:
+    virtual ~ByteSink() = default;
+
+    /// Receive the next chunk of bytes.
+    /// @param data The bytes, they are only valid during the call
+    virtual void write(std::span<const std::uint8_t> data) = 0;
+};
+
+/// A sink which writes to a file.
+class FileByteSink : public ByteSink {
+private:
+    std::ofstream m_file;
+
+public:
+    /// Create or truncate a file.
+    /// @param path The path of the file
+    /// @exception std::runtime_error The file could not be opened
+    explicit FileByteSink(const std::filesystem::path &path);
+
+    /// @exception std::runtime_error Writing to the file failed
+    void write(std::span<const std::uint8_t> data) override;
+};
+
+/// Writes bytes either into its own buffer or through a buffer of fixed size into a ByteSink.
 class ByteStreamWriter : public ByteStream {
+private:
+    ByteSink *m_sink{nullptr};
+    /// The number of bytes which are collected before they are passed to the sink.
+    std::size_t m_sink_buffer_size{0};
+
+    /// Append bytes to the buffer, which is passed to the sink first if the bytes do not fit into it.
+    void append(std::span<const std::uint8_t> data);
+
 public:
-    using ByteStream::ByteStream;
+    static constexpr std::size_t DEFAULT_SINK_BUFFER_SIZE{64 * 1024};
+
+    /// The views of ByteStream are read-only, so a writer can only start from an empty buffer or one it owns.
+    ByteStreamWriter() = default;
+
+    /// Append to a buffer.
+    /// @param buffer The bytes the written bytes are appended to
+    explicit ByteStreamWriter(std::vector<std::uint8_t> buffer);
+
+    /// Write into a sink, the memory usage of the writer does not grow with the number of written bytes.
+    /// In this mode, the stream only holds the bytes which have not been passed to the sink yet.
+    /// @warning The sink must outlive the writer and flush() must be called after the last write.
+    /// @param sink The sink to write to
+    /// @param buffer_size The number of bytes which are passed to the sink at once
+    explicit ByteStreamWriter(ByteSink &sink, std::size_t buffer_size = DEFAULT_SINK_BUFFER_SIZE);
+
+    /// Pass all buffered bytes to the sink, does nothing if the writer has no sink.
+    void flush();
+
+    /// Reserve memory for the given total number of bytes, so the buffer does not grow while writing.
+    /// This has no effect if the writer has a sink.
+    void reserve(std::size_t size);
 
     /// Generic write method.
     template <typename T>
     void write(const T &value);
+
+    /// Write packed indentations in the format of ByteStreamReader::read_indentations.
+    /// @param indentations The indentations to write, the number of indentations must be a multiple of 4
+    /// @exception std::invalid_argument The number of indentations is not a multiple of 4
+    void write_indentations(std::span<const octree::Indentation> indentations);
 };
 
 } // namespace inexor::vulkan_renderer::serialization
@@ -1,38 +1,113 @@
 #pragma once
 
+#include "inexor/vulkan-renderer/octree/serialization/byte_stream.hpp"
 #include "inexor/vulkan-renderer/octree/serialization/octree_parser.hpp"
 
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstddef>
 #include <memory>
+#include <optional>
 
 // Forward declaration
 namespace inexor::vulkan_renderer::octree {
 class Cube;
 } // namespace inexor::vulkan_renderer::octree
 
-// Forward declaration
-namespace inexor::vulkan_renderer::serialization {
-class ByteStream;
-} // namespace inexor::vulkan_renderer::serialization
-
 namespace inexor::vulkan_renderer::serialization {
 
+/// Parser of the Inexor octree format.
+/// Version 0 is a pre-order stream of all cubes. Version 1 additionally stores the byte size of every child subtree of
+/// the octants on the top levels, which allows to skip subtrees and to decode them on multiple threads. Version 2 is a
+/// compressed variant of version 0: the cube types are run length coded and both the cube types and the indentations
+/// are entropy coded with rANS, which makes it the smallest version for storing and sending maps.
 class NXOCParser : public OctreeParser {
 private:
-    static constexpr std::uint32_t LATEST_VERSION{0};
+    static constexpr std::uint32_t LATEST_VERSION{1};
+    /// The number of octree levels whose octants store the byte sizes of their children in version 1.
+    static constexpr std::uint8_t INDEXED_LEVELS{2};
+    /// The maximum number of indexed levels which is accepted when reading version 1.
+    static constexpr std::uint8_t MAX_INDEXED_LEVELS{8};
+
+    /// The number of threads to decode with, 0 uses tools::default_thread_count().
+    std::size_t m_thread_count{0};
 
     /// Specific version deserialization.
+    /// @param stream The stream to read from
+    /// @param region Only decode the subtrees which overlap this bounding box, if supported by the version
     template <std::size_t version>
-    [[nodiscard]] std::shared_ptr<octree::Cube> deserialize_impl(const ByteStream &stream);
+    [[nodiscard]] std::shared_ptr<octree::Cube> deserialize_impl(const ByteStream &stream,
+                                                                 const std::optional<std::array<glm::vec3, 2>> &region);
 
     /// Specific version serialization.
     template <std::size_t version>
-    [[nodiscard]] ByteStream serialize_impl(std::shared_ptr<const octree::Cube> cube);
+    void serialize_impl(const octree::Cube &cube, ByteStreamWriter &writer);
+
+    /// Dispatch to the serialization of a version.
+    void serialize_version(const std::shared_ptr<const octree::Cube> &cube, std::uint32_t version,
+                           ByteStreamWriter &writer);
+
+    /// Check the identifier and dispatch to the deserialization of the version of the stream.
+    [[nodiscard]] std::shared_ptr<octree::Cube>
+    deserialize_version(const ByteStream &stream, const std::optional<std::array<glm::vec3, 2>> &region);
+
+    /// Read a cube and all of its children in pre-order.
+    static void deserialize_subtree(octree::Cube &cube, ByteStreamReader &reader);
+
+    /// Write a cube and all of its children in pre-order.
+    /// @param cube The cube
+    /// @param writer The writer
+    /// @param level The octree level of the cube, the root is on level 0
+    /// @param indexed_levels The number of levels whose octants store the byte sizes of their children
+    static void serialize_subtree(const octree::Cube &cube, ByteStreamWriter &writer, std::size_t level,
+                                  std::size_t indexed_levels);
+
+    /// The number of bytes of a cube and all of its children without the header.
+    /// @param cube The cube
+    /// @param level The octree level of the cube, the root is on level 0
+    /// @param indexed_levels The number of levels whose octants store the byte sizes of their children
+    [[nodiscard]] static std::size_t serialized_size(const octree::Cube &cube, std::size_t level,
+                                                     std::size_t indexed_levels);
 
 public:
+    /// Create a parser.
+    /// @param thread_count The number of threads to decode version 1 with, 0 uses all hardware threads
+    explicit NXOCParser(std::size_t thread_count = 0) : m_thread_count(thread_count) {}
+
     /// Deserialization of an octree.
     [[nodiscard]] std::shared_ptr<octree::Cube> deserialize(const ByteStream &stream) final;
 
+    /// Deserialize only the part of an octree which is close to a point.
+    /// Subtrees of version 1 octrees which are farther away than the radius are skipped and left Type::EMPTY. Version 0
+    /// and 2 octrees can not skip subtrees, so they are always decoded completely.
+    /// @param stream The stream to read from
+    /// @param point The point around which the octree is decoded
+    /// @param radius The distance from the point in which subtrees are decoded on each axis
+    [[nodiscard]] std::shared_ptr<octree::Cube> deserialize_region(const ByteStream &stream, const glm::vec3 &point,
+                                                                   float radius);
+
     /// Serialization of an octree.
     [[nodiscard]] ByteStream serialize(std::shared_ptr<const octree::Cube> cube, std::uint32_t version) final;
+
+    /// Serialization of an octree into a sink, e.g. a file. The memory usage does not depend on the size of the octree.
+    /// @param cube The root of the octree
+    /// @param version The version to write
+    /// @param sink The sink to write to
+    /// @param buffer_size The number of bytes which are passed to the sink at once
+    void serialize(const std::shared_ptr<const octree::Cube> &cube, std::uint32_t version, ByteSink &sink,
+                   std::size_t buffer_size = ByteStreamWriter::DEFAULT_SINK_BUFFER_SIZE);
+
+    /// Write a randomly generated world into a sink without building it, e.g. to create huge worlds for stress tests.
+    /// The stream is the same as the serialization of octree::create_random_world() with the same depth and seed. The
+    /// subtrees are generated on multiple threads in batches, so only a few of them are held in memory at once.
+    /// @param max_depth The maximum of nested octants
+    /// @param seed The seed of the world
+    /// @param version The version to write, version 2 is not supported as it needs the whole world for its tables
+    /// @param sink The sink to write to
+    /// @param buffer_size The number of bytes which are passed to the sink at once
+    /// @exception std::invalid_argument The version is not supported or the maximum depth is too large
+    void serialize_random_world(std::uint32_t max_depth, std::uint32_t seed, std::uint32_t version, ByteSink &sink,
+                                std::size_t buffer_size = ByteStreamWriter::DEFAULT_SINK_BUFFER_SIZE);
 };
 } // namespace inexor::vulkan_renderer::serialization
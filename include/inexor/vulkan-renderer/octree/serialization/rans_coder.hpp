@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace inexor::vulkan_renderer::serialization {
+
+/// The static symbol probabilities of a rANS coded stream.
+/// The frequencies of all symbols sum up to PROBABILITY_SCALE, or to 0 if the stream does not contain any symbol.
+class RansFrequencyTable {
+public:
+    static constexpr std::uint32_t PROBABILITY_BITS{12};
+    static constexpr std::uint32_t PROBABILITY_SCALE{1u << PROBABILITY_BITS};
+
+private:
+    std::vector<std::uint16_t> m_frequencies;
+    /// The sum of the frequencies of all previous symbols.
+    std::vector<std::uint16_t> m_cumulative;
+    /// The symbol of every slot in [0, PROBABILITY_SCALE), which makes decoding a symbol a single lookup.
+    std::vector<std::uint16_t> m_slot_symbols;
+
+public:
+    /// Use normalized frequencies, e.g. the ones which have been stored next to an encoded stream.
+    /// @param frequencies The frequency of every symbol
+    /// @exception std::runtime_error The frequencies do not sum up to PROBABILITY_SCALE or 0
+    explicit RansFrequencyTable(std::vector<std::uint16_t> frequencies);
+
+    /// Normalize the number of occurrences of every symbol, every symbol which occurs keeps a frequency of at least 1.
+    /// @param counts The number of occurrences of every symbol
+    /// @exception std::invalid_argument There are more symbols than PROBABILITY_SCALE
+    [[nodiscard]] static RansFrequencyTable from_counts(std::span<const std::uint64_t> counts);
+
+    [[nodiscard]] std::uint16_t cumulative(const std::uint16_t symbol) const {
+        return m_cumulative[symbol];
+    }
+
+    [[nodiscard]] std::uint16_t frequency(const std::uint16_t symbol) const {
+        return m_frequencies[symbol];
+    }
+
+    [[nodiscard]] const std::vector<std::uint16_t> &frequencies() const noexcept {
+        return m_frequencies;
+    }
+
+    [[nodiscard]] std::uint16_t symbol(const std::uint32_t slot) const {
+        return m_slot_symbols[slot];
+    }
+};
+
+/// Encode symbols with a range asymmetric numeral system (rANS), which compresses them close to their entropy.
+/// @param symbols The symbols, each of them must have a frequency greater than 0 in the table
+/// @param table The symbol probabilities
+/// @return The encoded bytes, which start with the final coder state
+[[nodiscard]] std::vector<std::uint8_t> rans_encode(std::span<const std::uint16_t> symbols,
+                                                    const RansFrequencyTable &table);
+
+/// Decodes the symbols of a stream which has been encoded by rans_encode in the order in which they were encoded.
+class RansDecoder {
+private:
+    /// The coder state is renormalized to stay in [LOWER_BOUND, LOWER_BOUND * 256).
+    static constexpr std::uint32_t LOWER_BOUND{1u << 23};
+
+    const RansFrequencyTable &m_table;
+    const std::uint8_t *m_iter;
+    const std::uint8_t *m_end;
+    std::uint32_t m_state{0};
+
+public:
+    /// @warning The table and the data must outlive the decoder.
+    /// @exception std::runtime_error The data is too short to contain the coder state
+    RansDecoder(const RansFrequencyTable &table, std::span<const std::uint8_t> data);
+
+    /// Decode the next symbol.
+    /// @warning The caller has to make sure not to decode more symbols than have been encoded.
+    /// @exception std::runtime_error The data ended before the symbol could be decoded
+    [[nodiscard]] std::uint16_t decode() {
+        const std::uint32_t slot = m_state & (RansFrequencyTable::PROBABILITY_SCALE - 1);
+        const std::uint16_t symbol = m_table.symbol(slot);
+        m_state = m_table.frequency(symbol) * (m_state >> RansFrequencyTable::PROBABILITY_BITS) + slot -
+                  m_table.cumulative(symbol);
+        while (m_state < LOWER_BOUND) {
+            if (m_iter == m_end) {
+                throw std::runtime_error("Error: End of rANS stream");
+            }
+            m_state = (m_state << 8u) | *m_iter++;
+        }
+        return symbol;
+    }
+
+    /// The encoder state after the first symbol is restored once all symbols have been decoded.
+    [[nodiscard]] bool finished() const noexcept {
+        return m_iter == m_end && m_state == LOWER_BOUND;
+    }
+};
+
+} // namespace inexor::vulkan_renderer::serialization
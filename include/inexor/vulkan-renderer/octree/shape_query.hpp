@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+// Forward declaration
+namespace inexor::vulkan_renderer::octree {
+class Cube;
+} // namespace inexor::vulkan_renderer::octree
+
+namespace inexor::vulkan_renderer::octree {
+
+/// A geometry cube which overlaps a shape.
+struct ShapeContact {
+    /// The cube, a Type::SOLID or Type::NORMAL cube.
+    /// @warning The pointer is only valid as long as the octree is not changed.
+    const Cube *cube{nullptr};
+    /// The point of the geometry which is closest to the shape, or the center of the overlap for boxes.
+    glm::vec3 point{0.0f, 0.0f, 0.0f};
+    /// The direction in which the shape has to be moved to resolve the overlap.
+    glm::vec3 normal{0.0f, 0.0f, 0.0f};
+    /// How far the shape has to be moved along the normal to resolve the overlap.
+    float depth{0.0f};
+};
+
+/// The first geometry cube which a moving shape touches.
+struct SweepHit {
+    /// The cube, a Type::SOLID or Type::NORMAL cube.
+    /// @warning The pointer is only valid as long as the octree is not changed.
+    const Cube *cube{nullptr};
+    /// The shape touches the geometry after moving by t * motion, t is in [0, 1].
+    float t{0.0f};
+    /// The point of the geometry which is touched.
+    glm::vec3 point{0.0f, 0.0f, 0.0f};
+    /// The normal of the geometry at the touched point, pointing towards the shape.
+    glm::vec3 normal{0.0f, 0.0f, 0.0f};
+};
+
+/// Overlap and sweep queries of simple shapes against the geometry of an octree, as needed for moving characters and
+/// physics objects. Only the cubes whose bounding boxes overlap the bounds of the shape are visited.
+/// Type::SOLID cubes collide with their bounding box. Type::NORMAL cubes collide with their 12 triangles for spheres,
+/// and with the bounding box of their indented corners for boxes.
+/// None of the queries allocates memory, so they can be run for many entities every frame.
+class ShapeQuery {
+private:
+    const Cube *m_root{nullptr};
+
+public:
+    /// The maximum number of steps of sweep_sphere(), after which the sphere is considered to touch the geometry.
+    static constexpr std::uint32_t MAX_SWEEP_STEPS{32};
+    /// The distance along the motion below which sweep_sphere() considers the sphere to touch the geometry. The sphere
+    /// stops up to this distance in front of the geometry.
+    static constexpr float SWEEP_TOLERANCE{1e-4f};
+
+    /// Create a query for an octree.
+    /// @warning The octree must outlive the query.
+    /// @param root The root of the octree
+    explicit ShapeQuery(const Cube &root) : m_root(&root) {}
+
+    /// Find the geometry cubes which overlap an axis aligned box. Boxes which only touch the geometry do not overlap.
+    /// @param box The minimum and maximum corner of the box
+    /// @param contacts Receives the contacts, contacts which do not fit into it are only counted
+    /// @return The number of overlapping cubes, which may be greater than the size of contacts
+    [[nodiscard]] std::size_t overlap_box(const std::array<glm::vec3, 2> &box, std::span<ShapeContact> contacts) const;
+
+    /// Find the geometry cubes which overlap a sphere. A sphere with radius 0 finds the cubes which contain a point.
+    /// @param center The center of the sphere
+    /// @param radius The radius of the sphere
+    /// @param contacts Receives the contacts, contacts which do not fit into it are only counted
+    /// @return The number of overlapping cubes, which may be greater than the size of contacts
+    [[nodiscard]] std::size_t overlap_sphere(const glm::vec3 &center, float radius,
+                                             std::span<ShapeContact> contacts) const;
+
+    /// Find the first geometry cube which a moving sphere touches.
+    /// The sphere is advanced by its distance to the closest geometry in front of it until it touches the geometry,
+    /// so it never moves into the geometry. Geometry which the sphere moves away from or slides along does not stop
+    /// it, which allows to slide along walls and floors. A capsule is the volume which is swept by a sphere, so
+    /// sweep_sphere(bottom, radius, top - bottom) tests a capsule.
+    /// @param center The center of the sphere before moving
+    /// @param radius The radius of the sphere
+    /// @param motion The movement of the sphere
+    /// @return The first touched cube, or std::nullopt if the sphere can move freely
+    [[nodiscard]] std::optional<SweepHit> sweep_sphere(const glm::vec3 &center, float radius,
+                                                       const glm::vec3 &motion) const;
+};
+
+} // namespace inexor::vulkan_renderer::octree
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace inexor::vulkan_renderer::octree {
+
+// Forward declaration
+class Cube;
+
+/// A regular grid on which the vertices of octree geometry are stored as 16 bit integers.
+/// All vertices of a cube lie on the grid of its indentation steps (size / Indentation::MAX), which is a multiple of
+/// the indentation step of the smallest cube in the octree. Quantizing the vertices on that grid is lossless.
+class QuantizationGrid {
+public:
+    /// The largest coordinate which can be stored, in multiples of the step size.
+    static constexpr std::uint32_t MAX_COORDINATE{std::numeric_limits<std::uint16_t>::max()};
+
+private:
+    glm::vec3 m_origin{0.0f, 0.0f, 0.0f};
+    float m_step{1.0f};
+
+public:
+    QuantizationGrid() = default;
+    /// @param origin The position of the grid coordinate (0, 0, 0)
+    /// @param step The distance between two grid coordinates, must be greater than 0
+    QuantizationGrid(const glm::vec3 &origin, float step);
+
+    /// Create the grid which represents all vertices of an octree losslessly.
+    /// The origin is the position of the cube and the step is the indentation step of its smallest geometry cube.
+    /// @note Use fits() to check if the octree is small enough for 16 bit coordinates.
+    [[nodiscard]] static QuantizationGrid from_octree(const Cube &cube);
+
+    /// Dequantize grid coordinates.
+    [[nodiscard]] glm::vec3 dequantize(const std::array<std::uint16_t, 3> &coordinates) const noexcept;
+
+    /// Check if a box lies completely in the range of the grid.
+    [[nodiscard]] bool fits(const glm::vec3 &min, const glm::vec3 &max) const noexcept;
+
+    [[nodiscard]] const glm::vec3 &origin() const noexcept {
+        return m_origin;
+    }
+
+    /// Quantize a position to the nearest grid coordinates.
+    /// @exception std::out_of_range The position is outside of the range of the grid
+    [[nodiscard]] std::array<std::uint16_t, 3> quantize(const glm::vec3 &position) const;
+
+    [[nodiscard]] float step() const noexcept {
+        return m_step;
+    }
+};
+
+} // namespace inexor::vulkan_renderer::octree
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+#include "inexor/vulkan-renderer/octree/locational_code.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace inexor::vulkan_renderer::octree {
+
+/// The new content of a single cube.
+struct CubeEdit {
+    /// The cube to change. If it does not exist yet, the leaf which contains it is subdivided. The other children keep
+    /// the type of the leaf, children of a Type::NORMAL leaf become Type::SOLID.
+    LocationalCode code;
+    /// The new type, Type::OCTANT is not allowed, use WorldEditor::paste() to write subtrees.
+    Cube::Type type{Cube::Type::EMPTY};
+    /// The indentations, only used for Type::NORMAL.
+    std::array<Indentation, Cube::EDGES> indentations{};
+};
+
+/// What a batch of edits, an undo or a redo has changed.
+struct EditStatistics {
+    /// The number of subtrees which have been written.
+    std::size_t written_subtrees{0};
+    /// The number of cubes which have been written, including the cubes of all written subtrees.
+    std::size_t written_cubes{0};
+    /// The number of octants whose children all became Type::EMPTY or all became Type::SOLID and which have been turned
+    /// into a single cube.
+    std::size_t collapsed_octants{0};
+    /// The number of cubes which have been marked as edited, see Cube::take_dirty_cubes.
+    std::size_t dirty_cubes{0};
+    /// The number of bytes of the journal entry which reverts the change.
+    std::size_t journal_bytes{0};
+};
+
+/// Applies batches of edits to a world and keeps a journal to undo and redo them.
+/// A batch is applied as a whole: the cubes are changed without marking them as edited one by one, then the octants
+/// whose children have become uniform are collapsed, and only the topmost changed cubes are marked as edited at the
+/// end. The journal does not store copies of cubes, but the previous content of every changed subtree as a compact
+/// stream of types and indentation uids. Each batch costs time and journal memory in the size of the changed
+/// subtrees, regardless of the size of the world.
+/// @warning Pointers to cubes of the world are invalidated by any change, as cubes are replaced and collapsed.
+class WorldEditor {
+private:
+    /// Subtrees which are written into a world, which is how batches and their reverse are journaled.
+    struct EditRecord {
+        /// The code of every subtree, in the order in which they are written.
+        std::vector<LocationalCode> codes;
+        /// The types of the cubes of all subtrees in pre-order.
+        std::vector<Cube::Type> types;
+        /// The 12 indentation uids of every Type::NORMAL cube in types.
+        std::vector<std::uint8_t> indentations;
+
+        [[nodiscard]] std::size_t memory_usage() const noexcept {
+            return codes.size() * sizeof(LocationalCode) + types.size() * sizeof(Cube::Type) + indentations.size();
+        }
+    };
+
+    std::shared_ptr<Cube> m_world;
+    std::size_t m_journal_budget;
+    std::deque<EditRecord> m_undo;
+    std::vector<EditRecord> m_redo;
+    std::size_t m_journal_usage{0};
+
+    /// Append a cube and all of its children to a record in pre-order.
+    static void encode(const Cube &cube, EditRecord &record);
+
+    /// Write the subtrees of a record into the world.
+    /// @param record The subtrees to write
+    /// @param collapse Whether to collapse uniform octants afterwards, which is never done to undo or redo a batch, as
+    /// they restore the world exactly
+    /// @param statistics The statistics to update
+    /// @return The record which reverts the change
+    [[nodiscard]] EditRecord write(const EditRecord &record, bool collapse, EditStatistics &statistics);
+
+    /// Push a record to the undo journal, clear the redo journal and drop the oldest records which exceed the journal
+    /// budget.
+    void push_undo(EditRecord record);
+
+    /// Drop the oldest records of the undo journal until the journal fits into its budget. If the redo journal exceeds
+    /// the budget on its own, the records which would be redone last are dropped as well.
+    void trim_journal();
+
+public:
+    /// @param world The world to edit, the root of an octree
+    /// @param journal_budget The maximum number of bytes of the undo and redo journal, the oldest batches are dropped
+    /// from the undo journal when it is exceeded, and the batches which would be redone last if that is not enough
+    /// @exception std::invalid_argument The world is nullptr or not a root
+    explicit WorldEditor(std::shared_ptr<Cube> world, std::size_t journal_budget = 16 * 1024 * 1024);
+
+    /// Change cubes of the world as a single batch, which is one step of the undo journal.
+    /// The edits are applied in order, so later edits overwrite earlier edits of the same cubes.
+    /// @param edits The edits
+    /// @return What has been changed
+    /// @exception std::invalid_argument An edit has the type Type::OCTANT
+    EditStatistics apply(std::span<const CubeEdit> edits);
+
+    [[nodiscard]] bool can_redo() const noexcept {
+        return !m_redo.empty();
+    }
+
+    [[nodiscard]] bool can_undo() const noexcept {
+        return !m_undo.empty();
+    }
+
+    /// Set all cubes of a level which are inside of a box to a type, as a single batch.
+    /// Octants which lie completely inside of the box are replaced as a whole instead of being edited cube by cube,
+    /// and cubes which already have the type are skipped, so large brushes only touch the cubes on their border.
+    /// @param box The minimum and maximum corner of the box
+    /// @param level The level of the cubes on the border of the box, cubes of this level are filled if their center is
+    /// inside of the box
+    /// @param type The type, Type::EMPTY or Type::SOLID
+    /// @return What has been changed
+    /// @exception std::invalid_argument The type is not Type::EMPTY or Type::SOLID, or the level is greater than
+    /// LocationalCode::MAX_LEVEL
+    EditStatistics fill(const std::array<glm::vec3, 2> &box, std::size_t level, Cube::Type type);
+
+    /// The number of bytes of the undo and redo journal.
+    [[nodiscard]] std::size_t journal_usage() const noexcept {
+        return m_journal_usage;
+    }
+
+    /// Replace a cube of the world with a copy of another cube and its children, as a single batch.
+    /// This is the paste of copy and paste: the source is usually a clone() of a part of a world. It is scaled to the
+    /// size of the target.
+    /// @param source The cube to copy
+    /// @param target The cube to replace, if it does not exist yet the leaf which contains it is subdivided
+    /// @return What has been changed
+    /// @exception std::invalid_argument The copy would have cubes below LocationalCode::MAX_LEVEL, nothing is changed
+    EditStatistics paste(const Cube &source, const LocationalCode &target);
+
+    /// Apply the last batch which has been undone again.
+    /// @return What has been changed, nothing if there is nothing to redo
+    EditStatistics redo();
+
+    /// Revert the last batch, which can be applied again with redo() until a new batch is applied.
+    /// @return What has been changed, nothing if there is nothing to undo
+    EditStatistics undo();
+
+    [[nodiscard]] const std::shared_ptr<Cube> &world() const noexcept {
+        return m_world;
+    }
+};
+
+} // namespace inexor::vulkan_renderer::octree
@@ -2,6 +2,7 @@
 
 #include <volk.h>
 
+#include "inexor/vulkan-renderer/render-graph/render_graph_compiler.hpp"
 #include "inexor/vulkan-renderer/render-graph/texture.hpp"
 #include "inexor/vulkan-renderer/wrapper/descriptors/descriptor_set_layout.hpp"
 #include "inexor/vulkan-renderer/wrapper/device.hpp"
@@ -48,6 +49,8 @@ private:
 
     /// The buffers which are read by this graphics pass
     std::vector<std::weak_ptr<Buffer>> m_buffer_reads;
+    /// The buffers which are written to by this graphics pass
+    std::vector<std::weak_ptr<Buffer>> m_buffer_writes;
     /// The texture attachments of this pass (unified means color, depth, stencil attachment or a swapchain)
     std::vector<std::pair<std::weak_ptr<Texture>, std::optional<VkClearValue>>> m_texture_writes;
     /// The swapchains this graphics pass writes to
@@ -65,6 +68,8 @@ private:
     std::optional<VkRenderingAttachmentInfo> m_depth_attachment{std::nullopt};
     /// The stencil attachment inside of m_rendering_info
     std::optional<VkRenderingAttachmentInfo> m_stencil_attachment{std::nullopt};
+    /// The barriers which are recorded before the pass, computed by the rendergraph compiler
+    std::vector<ResourceBarrier> m_barriers;
 
     /// Reset the rendering info
     void reset_rendering_info();
@@ -74,11 +79,12 @@ public:
     /// @param name The name of the graphics pass
     /// @param on_record_cmd_buffer The command buffer recording function of the graphics pass
     /// @param buffer_reads The buffers which are read by this graphics pass
+    /// @param buffer_writes The buffers which are written to by this graphics pass
     /// @param texture_writes The textures which are written to by this graphics pass
     /// @param swapchain_writes The swapchains which are written to by this graphics pass
     /// @param pass_debug_label_color The debug label of the pass (visible in graphics debuggers like RenderDoc)
     GraphicsPass(std::string name, std::function<void(const CommandBuffer &)> on_record_cmd_buffer,
-                 std::vector<std::weak_ptr<Buffer>> buffer_reads,
+                 std::vector<std::weak_ptr<Buffer>> buffer_reads, std::vector<std::weak_ptr<Buffer>> buffer_writes,
                  std::vector<std::pair<std::weak_ptr<Texture>, std::optional<VkClearValue>>> texture_writes,
                  std::vector<std::pair<std::weak_ptr<Swapchain>, std::optional<VkClearValue>>> swapchain_writes,
                  wrapper::DebugLabelColor pass_debug_label_color);
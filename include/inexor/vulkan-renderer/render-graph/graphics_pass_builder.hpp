@@ -67,7 +67,7 @@ public:
 
     /// Specify that this graphics pass writes to a buffer
     /// @brief buffer The buffer that is written to
-    /// @note This feature might be used in the future if a pass writes to a buffer
+    /// @note Rendergraph orders the passes which read this buffer after this pass
     /// @return A const reference to the this pointer (allowing method calls to be chained)
     [[nodiscard]] GraphicsPassBuilder &writes_to(std::weak_ptr<Buffer> buffer);
 
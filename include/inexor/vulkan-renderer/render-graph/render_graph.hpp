@@ -3,6 +3,7 @@
 #include "inexor/vulkan-renderer/render-graph/buffer.hpp"
 #include "inexor/vulkan-renderer/render-graph/graphics_pass.hpp"
 #include "inexor/vulkan-renderer/render-graph/graphics_pass_builder.hpp"
+#include "inexor/vulkan-renderer/render-graph/render_graph_compiler.hpp"
 #include "inexor/vulkan-renderer/render-graph/texture.hpp"
 #include "inexor/vulkan-renderer/wrapper/commands/command_buffer.hpp"
 #include "inexor/vulkan-renderer/wrapper/descriptors/descriptor_set_allocator.hpp"
@@ -15,8 +16,10 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <tuple>
+#include <variant>
 #include <vector>
 
 namespace inexor::vulkan_renderer::wrapper {
@@ -42,8 +45,11 @@ private:
     std::vector<std::shared_ptr<Buffer>> m_buffers;
     /// The textures (back buffers, depth buffers, textures...)
     std::vector<std::shared_ptr<Texture>> m_textures;
-    /// The graphics passes
+    /// The graphics passes in the order in which they have been added
     std::vector<std::shared_ptr<GraphicsPass>> m_graphics_passes;
+    /// The indices of the graphics passes which are recorded, in the order of execution. Passes whose results are never
+    /// used are not part of it
+    std::vector<std::size_t> m_pass_order;
     /// An instance of the graphics pass builder
     GraphicsPassBuilder m_graphics_pass_builder{};
     /// An instance of the graphics pipeline builder
@@ -81,10 +87,24 @@ private:
     /// only one VkSemaphore in here because collect_swapchain_image_available_semaphores method will fill this vector)
     std::vector<VkSemaphore> m_swapchains_imgs_available;
 
+    /// A resource which is accessed by the graphics passes
+    using PassResource = std::variant<std::weak_ptr<Buffer>, std::weak_ptr<Texture>, std::weak_ptr<Swapchain>>;
+    /// The resources which are accessed by the graphics passes, indexed by the resource indices of the barriers
+    std::vector<PassResource> m_pass_resources;
+    /// The barriers after the last graphics pass, which prepare the swapchain images for presenting
+    std::vector<ResourceBarrier> m_final_barriers;
+
     void acquire_swapchain_images();
 
     void allocate_descriptor_sets();
 
+    /// Describe the graphics passes and the resources they access to the rendergraph compiler
+    /// @return The rendergraph compiler, whose resource indices refer to m_pass_resources
+    /// @exception InexorException A graphics pass accesses a resource which has already been destroyed
+    [[nodiscard]] RenderGraphCompiler create_compiler();
+
+    /// Sort the graphics passes topologically into m_pass_order, which leaves out the passes whose results are never
+    /// used, and compute the barriers between the passes
     void sort_graphics_passes_by_order();
 
     void update_buffers();
@@ -105,6 +125,11 @@ private:
     /// @param pass The graphics pass
     void fill_graphics_pass_rendering_info(GraphicsPass &pass);
 
+    /// Record the barriers computed by the rendergraph compiler as one pipeline barrier
+    /// @param cmd_buf The command buffer to record the barriers into
+    /// @param barriers The barriers
+    void record_barriers(const CommandBuffer &cmd_buf, std::span<const ResourceBarrier> barriers);
+
     /// Record the command buffer of a pass. After a lot of discussions about the API design of rendergraph, we came to
     /// the conclusion that it's the full responsibility of the programmer to manually bind pipelines, descriptors sets,
     /// and buffers inside of the on_record function instead of attempting to abstract all of this in rendergraph. This
@@ -135,7 +160,8 @@ public:
     /// @return A weak pointer to the buffer resource which was created
     [[nodiscard]] std::weak_ptr<Buffer> add_buffer(std::string name, BufferType type, std::function<void()> on_update);
 
-    /// Add a graphics pass to the rendergraph
+    /// Add a graphics pass to the rendergraph. A pass whose results are never used stays in the rendergraph, but it is
+    /// not recorded
     /// @param graphics_pass The graphics pass which was created
     /// @return A weak pointer to the graphics pass which was created
     [[nodiscard]] std::weak_ptr<GraphicsPass> add_graphics_pass(std::shared_ptr<GraphicsPass> graphics_pass);
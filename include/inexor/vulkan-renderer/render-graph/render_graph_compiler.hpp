@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace inexor::vulkan_renderer::render_graph {
+
+/// The ways in which a graphics pass accesses a resource. Every access stands for a pipeline stage, a memory access
+/// and, for images, an image layout, which RenderGraph translates into Vulkan barriers.
+enum class ResourceAccess : std::uint8_t {
+    VERTEX_BUFFER_READ,
+    INDEX_BUFFER_READ,
+    UNIFORM_BUFFER_READ,
+    /// A shader writes to a buffer, see GraphicsPassBuilder::writes_to.
+    BUFFER_WRITE,
+    COLOR_ATTACHMENT_WRITE,
+    DEPTH_STENCIL_ATTACHMENT_WRITE,
+    /// Presenting a swapchain image after the last pass, which is not used by passes themselves.
+    PRESENT,
+};
+
+/// A set of resource accesses, with one bit per ResourceAccess.
+using ResourceAccessMask = std::uint32_t;
+
+/// The bit of a resource access in a ResourceAccessMask.
+[[nodiscard]] constexpr ResourceAccessMask access_bit(const ResourceAccess access) noexcept {
+    return ResourceAccessMask{1} << static_cast<std::uint32_t>(access);
+}
+
+/// The layouts of images, every image access requires one of them.
+enum class ImageLayout : std::uint8_t {
+    /// The content of the image is discarded, also used for buffers which have no layout.
+    UNDEFINED,
+    COLOR_ATTACHMENT,
+    DEPTH_STENCIL_ATTACHMENT,
+    PRESENT,
+};
+
+/// Whether an access writes to the resource.
+[[nodiscard]] bool is_write_access(ResourceAccess access) noexcept;
+
+/// The layout an image must be in for an access, ImageLayout::UNDEFINED for buffer accesses.
+[[nodiscard]] ImageLayout image_layout(ResourceAccess access) noexcept;
+
+/// The kinds of resources, which decide whether a resource has an image layout.
+enum class ResourceType : std::uint8_t {
+    BUFFER,
+    IMAGE,
+};
+
+/// A resource as the rendergraph compiler sees it. The compiler only works with the indices of the resources, so it
+/// does not need any Vulkan objects.
+struct RenderGraphResource {
+    /// The name of the resource, which is used in error messages.
+    std::string name;
+    ResourceType type{ResourceType::BUFFER};
+    /// The layout of an image at the beginning of every frame.
+    ImageLayout initial_layout{ImageLayout::UNDEFINED};
+    /// The image is presented after the last pass, e.g. a swapchain image.
+    bool presented{false};
+    /// The resource is used outside of the passes, e.g. presented or read through a descriptor, so the passes which
+    /// write it are never culled.
+    bool external{false};
+};
+
+/// The access of a pass to a resource.
+struct ResourceUse {
+    /// The index of the resource.
+    std::size_t resource{0};
+    ResourceAccess access{ResourceAccess::VERTEX_BUFFER_READ};
+};
+
+/// A pass as the rendergraph compiler sees it.
+struct RenderGraphPassNode {
+    /// The name of the pass, which is used in error messages.
+    std::string name;
+    /// The resources which are accessed by the pass, a resource may be accessed in multiple ways.
+    std::vector<ResourceUse> uses;
+};
+
+/// A barrier in front of a pass, which covers all accesses of the pass to one resource.
+struct ResourceBarrier {
+    /// The index of the resource.
+    std::size_t resource{0};
+    /// The accesses which must be finished before the barrier, 0 if only the image layout changes.
+    ResourceAccessMask src_access{0};
+    /// The accesses which wait for the barrier. This includes the accesses of later passes which read the resource in
+    /// the same layout, so they do not need a barrier of their own.
+    ResourceAccessMask dst_access{0};
+    ImageLayout old_layout{ImageLayout::UNDEFINED};
+    ImageLayout new_layout{ImageLayout::UNDEFINED};
+
+    bool operator==(const ResourceBarrier &) const = default;
+};
+
+/// The result of compiling a rendergraph.
+struct CompiledRenderGraph {
+    /// The indices of the passes which are executed, in the order of execution.
+    std::vector<std::size_t> pass_order;
+    /// The barriers in front of every pass of pass_order.
+    std::vector<std::vector<ResourceBarrier>> pass_barriers;
+    /// The barriers after the last pass, which prepare images for presenting or return them to their initial layout.
+    std::vector<ResourceBarrier> final_barriers;
+    /// The indices of the passes whose results are never used, in ascending order.
+    std::vector<std::size_t> culled_passes;
+};
+
+/// Turns the passes of a rendergraph and the resources they access into a directed acyclic graph (DAG), which is
+/// sorted, culled and annotated with the barriers between the passes.
+/// Passes which write the same resource are executed in the order in which they have been added. A pass which reads a
+/// resource depends on the last writer which has been added before it, or on the last writer of all if it has been
+/// added before all writers, and the next writer depends on the passes which read the previous write. Frames are
+/// expected to be separated by a queue submission which waits for the previous frame, so the barriers only synchronize
+/// the passes of one frame.
+class RenderGraphCompiler {
+private:
+    std::vector<RenderGraphResource> m_resources;
+    std::vector<RenderGraphPassNode> m_passes;
+    /// The passes which depend on each pass.
+    std::vector<std::vector<std::size_t>> m_successors;
+    /// The passes each pass depends on.
+    std::vector<std::vector<std::size_t>> m_predecessors;
+    /// The passes which use the results of each pass, which is the part of m_successors without the write-after-read
+    /// edges. Those only order the passes and do not keep a pass from being culled.
+    std::vector<std::vector<std::size_t>> m_data_successors;
+
+    /// Find passes which depend on each other in a cycle, an empty vector if the graph is acyclic.
+    [[nodiscard]] std::vector<std::size_t> find_cycle() const;
+
+public:
+    /// Build the graph of the passes.
+    /// @param resources The resources
+    /// @param passes The passes in the order in which they have been added
+    /// @exception std::invalid_argument A pass uses a resource which does not exist, uses an image access on a buffer
+    /// or the other way around, or uses an image in two layouts
+    RenderGraphCompiler(std::vector<RenderGraphResource> resources, std::vector<RenderGraphPassNode> passes);
+
+    /// Ensure that the graph is a directed acyclic graph (DAG).
+    /// @exception std::runtime_error The passes depend on each other in a cycle, the message names the passes
+    void check_for_cycles() const;
+
+    /// Compile the graph: sort the passes topologically, cull the passes whose results are never used and compute the
+    /// barriers in front of every pass.
+    /// @exception std::runtime_error The passes depend on each other in a cycle
+    [[nodiscard]] CompiledRenderGraph compile() const;
+
+    /// The passes which depend on a pass.
+    /// @param pass The index of the pass
+    [[nodiscard]] const std::vector<std::size_t> &successors(const std::size_t pass) const {
+        return m_successors.at(pass);
+    }
+
+    /// Sort the passes topologically. Passes which do not depend on each other keep the order in which they have been
+    /// added.
+    /// @exception std::runtime_error The passes depend on each other in a cycle
+    [[nodiscard]] std::vector<std::size_t> sort_passes() const;
+};
+
+} // namespace inexor::vulkan_renderer::render_graph
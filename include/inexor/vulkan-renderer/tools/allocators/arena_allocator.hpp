@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+namespace inexor::vulkan_renderer::tools::allocators {
+
+/// One block of memory for a known number of objects of the same type, which are allocated one after another.
+/// This is meant for data structures which are built in one go, like the copy of a tree: instead of one heap
+/// allocation per object, there is a single allocation for all of them. Deallocated objects are not reused, the block
+/// is freed as a whole once the arena has been sealed and all of its objects have been deallocated.
+/// @note Objects may be deallocated on any thread, but allocate() and seal() must not be called concurrently.
+class Arena {
+private:
+    std::size_t m_capacity;
+    std::size_t m_used{0};
+    std::size_t m_object_size{0};
+    std::size_t m_alignment{0};
+    std::byte *m_memory{nullptr};
+    /// The number of live objects, plus one reference which is held until the arena is sealed. Both are released by
+    /// the same atomic decrement, so exactly one thread sees the count drop to zero and deletes the arena.
+    std::atomic<std::size_t> m_references{1};
+    bool m_sealed{false};
+
+    explicit Arena(const std::size_t capacity) noexcept : m_capacity(capacity) {}
+
+    ~Arena() {
+        if (m_memory != nullptr) {
+            ::operator delete(m_memory, std::align_val_t{m_alignment});
+        }
+    }
+
+public:
+    /// Create an arena, which deletes itself once it has been sealed and all of its objects have been deallocated.
+    /// @param capacity The number of objects
+    [[nodiscard]] static Arena *create(const std::size_t capacity) {
+        return new Arena(capacity);
+    }
+
+    Arena(const Arena &) = delete;
+    Arena(Arena &&) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+    Arena &operator=(Arena &&) = delete;
+
+    /// Allocate the memory of the next object. The memory block is allocated with the first object.
+    /// @param size The size of the object, which must be the same for all objects
+    /// @param alignment The alignment of the object, which must be the same for all objects
+    /// @exception std::bad_alloc The arena is full or sealed
+    [[nodiscard]] void *allocate(const std::size_t size, const std::size_t alignment) {
+        if (m_used == m_capacity || m_sealed) {
+            throw std::bad_alloc();
+        }
+        if (m_memory == nullptr) {
+            m_object_size = (size + alignment - 1) / alignment * alignment;
+            m_alignment = alignment;
+            m_memory =
+                static_cast<std::byte *>(::operator new(m_capacity * m_object_size, std::align_val_t{alignment}));
+        }
+        assert(size <= m_object_size && alignment == m_alignment);
+        m_references.fetch_add(1, std::memory_order_relaxed);
+        return m_memory + m_object_size * m_used++;
+    }
+
+    /// The number of objects which have been allocated but not deallocated yet.
+    /// @note This must not be called concurrently with seal().
+    [[nodiscard]] std::size_t live_objects() const noexcept {
+        return m_references.load(std::memory_order_acquire) - (m_sealed ? 0 : 1);
+    }
+
+    /// The memory of the arena and its block, which includes the objects which have been deallocated already.
+    [[nodiscard]] std::size_t memory_usage() const noexcept {
+        return sizeof(Arena) + m_capacity * m_object_size;
+    }
+
+    /// Deallocate an object, which deletes the arena if it has been sealed and this was its last object.
+    void deallocate() noexcept {
+        release();
+    }
+
+    /// Declare that no more objects are allocated, which deletes the arena right away if it has no objects.
+    /// @note This must be called exactly once.
+    void seal() noexcept {
+        assert(!m_sealed);
+        m_sealed = true;
+        release();
+    }
+
+private:
+    /// Release an object or the reference which is held until sealing, the last one deletes the arena.
+    void release() noexcept {
+        if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+};
+
+/// A standard allocator which allocates from an arena, e.g. for std::allocate_shared.
+template <typename T>
+class ArenaAllocator {
+private:
+    Arena *m_arena;
+
+    template <typename U>
+    friend class ArenaAllocator;
+
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena *arena) noexcept : m_arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : m_arena(other.m_arena) {} // NOLINT
+
+    /// @exception std::bad_alloc More than one object is requested, or the arena is full or sealed
+    [[nodiscard]] T *allocate(const std::size_t count) {
+        if (count != 1) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(m_arena->allocate(sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T * /*pointer*/, std::size_t /*count*/) noexcept {
+        m_arena->deallocate();
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const noexcept {
+        return m_arena == other.m_arena;
+    }
+};
+
+} // namespace inexor::vulkan_renderer::tools::allocators
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace inexor::vulkan_renderer::tools {
+
+/// The result of testing a box against a frustum.
+enum class FrustumTest { OUTSIDE, INTERSECTING, INSIDE };
+
+/// The view frustum of a camera, given by the 6 planes of the clip space volume in world space.
+/// The planes are extracted from the view projection matrix as described by Gribb and Hartmann, using the clip space
+/// depth range [0, 1] of Vulkan.
+class Frustum {
+private:
+    /// The planes with normals pointing into the frustum, a point p is on the inner side of a plane if
+    /// dot(plane, vec4(p, 1)) >= 0. The order is left, right, bottom, top, near, far.
+    std::array<glm::vec4, 6> m_planes{};
+
+public:
+    /// The number of planes of a frustum.
+    static constexpr std::size_t PLANES{6};
+    /// The plane mask in which every plane of the frustum still has to be tested.
+    static constexpr std::uint8_t ALL_PLANES{(1u << PLANES) - 1};
+
+    /// Extract the frustum of a camera.
+    /// @param view_projection The projection matrix multiplied by the view matrix
+    explicit Frustum(const glm::mat4 &view_projection);
+
+    [[nodiscard]] const std::array<glm::vec4, 6> &planes() const noexcept {
+        return m_planes;
+    }
+
+    /// Test an axis aligned box against the frustum.
+    /// Boxes which are close to a corner of the frustum may be reported as intersecting although they are outside,
+    /// which is the usual conservative behaviour of plane based culling.
+    /// @param box The minimum and maximum corner of the box
+    /// @param plane_mask The planes to test, the box is known to be inside of all other planes. On return, it only
+    /// contains the planes the box intersects, which is the mask to use for boxes inside of this box. This makes
+    /// hierarchical culling cheaper the deeper it descends.
+    /// @return Whether the box is outside, intersecting or inside of the frustum
+    [[nodiscard]] FrustumTest test(const std::array<glm::vec3, 2> &box, std::uint8_t &plane_mask) const;
+
+    /// Test an axis aligned box against all planes of the frustum.
+    /// @param box The minimum and maximum corner of the box
+    /// @return Whether the box is outside, intersecting or inside of the frustum
+    [[nodiscard]] FrustumTest test(const std::array<glm::vec3, 2> &box) const {
+        std::uint8_t plane_mask = ALL_PLANES;
+        return test(box, plane_mask);
+    }
+};
+
+} // namespace inexor::vulkan_renderer::tools
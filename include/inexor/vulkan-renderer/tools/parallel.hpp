@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace inexor::vulkan_renderer::tools {
+
+/// The number of threads which is used if no thread count is given, at least 1.
+[[nodiscard]] std::size_t default_thread_count() noexcept;
+
+/// Call a function for all indices in [0, count) on multiple threads.
+/// The tasks are not assigned to the threads in advance: every thread takes the next unprocessed index as soon as it
+/// has finished its previous one, so threads which got cheap tasks automatically take over work from busy threads.
+/// The calling thread takes part in the work, so a thread count of 1 executes all tasks on the calling thread.
+/// @param count The number of tasks
+/// @param task The function to call for every index, must be safe to be called concurrently for different indices
+/// @param thread_count The number of threads to use, default_thread_count() if 0
+/// @note If tasks throw, the remaining tasks are skipped and the first exception is rethrown on the calling thread.
+void parallel_for(std::size_t count, const std::function<void(std::size_t)> &task, std::size_t thread_count = 0);
+
+} // namespace inexor::vulkan_renderer::tools
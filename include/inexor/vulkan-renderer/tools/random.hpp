@@ -1,6 +1,7 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
 #include <optional>
 #include <random>
 #include <type_traits>
@@ -26,4 +27,29 @@ inline auto generate_random_number =
     }
 };
 
+/// Generates a random number from a key and a counter.
+/// In contrast to generate_random_number, this has no state: the number only depends on the key and the counter, so
+/// numbers can be generated in any order and on any thread while the result stays the same for a key. A common use is
+/// to derive the key from a seed and the position of an object, and to count the numbers which belong to the object.
+/// This uses the finalizer of SplitMix64, applied to the key and then to the mixed key plus the counter.
+/// @param key The key, e.g. a seed combined with an id
+/// @param counter The index of the number for this key
+[[nodiscard]] constexpr std::uint64_t counter_based_random(const std::uint64_t key,
+                                                           const std::uint64_t counter) noexcept {
+    auto mix = [](std::uint64_t value) {
+        value += 0x9e3779b97f4a7c15u;
+        value = (value ^ (value >> 30u)) * 0xbf58476d1ce4e5b9u;
+        value = (value ^ (value >> 27u)) * 0x94d049bb133111ebu;
+        return value ^ (value >> 31u);
+    };
+    return mix(mix(key) + counter);
+}
+
+/// Map a random number of counter_based_random to the range [0, count) without a division.
+/// @param random The random number
+/// @param count The number of values
+[[nodiscard]] constexpr std::uint32_t random_below(const std::uint64_t random, const std::uint32_t count) noexcept {
+    return static_cast<std::uint32_t>(((random >> 32u) * count) >> 32u);
+}
+
 } // namespace inexor::vulkan_renderer::tools
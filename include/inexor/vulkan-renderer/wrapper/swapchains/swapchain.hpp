@@ -87,6 +87,10 @@ public:
     /// @param cmd_buf The command buffer used for recording
     void change_image_layout_to_prepare_for_presenting(const CommandBuffer &cmd_buf);
 
+    [[nodiscard]] auto current_swapchain_image() const {
+        return m_current_swapchain_img;
+    }
+
     [[nodiscard]] auto current_swapchain_image_view() const {
         return m_current_swapchain_img_view;
     }
@@ -1,17 +1,21 @@
 #version 450
 
-layout (location = 0) in vec3 in_position;
-layout (location = 1) in vec3 in_color;
+// Quantized position, see OctreeGpuVertex.
+layout (location = 0) in uvec4 in_position;
+layout (location = 1) in vec4 in_color;
 
 layout (binding = 0) uniform UniformBufferObject {
     mat4 model;
     mat4 view;
     mat4 proj;
+    // Origin (xyz) and step (w) of the quantization grid
+    vec4 quantization;
 } ubo;
 
 layout (location = 0) out vec3 frag_color;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(in_position, 1.0);
-    frag_color = in_color;
+    vec3 position = ubo.quantization.xyz + vec3(in_position.xyz) * ubo.quantization.w;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+    frag_color = in_color.rgb;
 }
@@ -0,0 +1,315 @@
+#include "inexor/vulkan-renderer/octree/chunk_manager.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace inexor::vulkan_renderer::octree {
+
+namespace {
+
+/// The number of levels below a cube.
+std::size_t subtree_depth(const Cube &cube) {
+    if (cube.type() != Cube::Type::OCTANT) {
+        return 0;
+    }
+    std::size_t depth = 0;
+    for (const auto &child : cube.children()) {
+        depth = std::max(depth, subtree_depth(*child) + 1);
+    }
+    return depth;
+}
+
+} // namespace
+
+ChunkManager::ChunkManager(std::vector<std::shared_ptr<Cube>> worlds, ChunkSettings settings)
+    : m_worlds(std::move(worlds)), m_settings(settings) {
+    if (m_settings.slot_count == 0) {
+        throw std::invalid_argument("Error: The slot count of the chunk manager must not be zero!");
+    }
+    m_slots.resize(m_settings.slot_count);
+    for (std::size_t world = 0; world < m_worlds.size(); world++) {
+        if (!m_worlds[world]) {
+            throw std::invalid_argument("Error: World " + std::to_string(world) + " is nullptr!");
+        }
+        // The chunks are created from the current state of the world, so previous edits are irrelevant.
+        static_cast<void>(m_worlds[world]->take_dirty_cubes());
+        collect_chunks(world, m_worlds[world], 0);
+    }
+    rebuild_lookup();
+}
+
+void ChunkManager::apply_edits(std::vector<std::size_t> &changed_slots) {
+    for (std::size_t world = 0; world < m_worlds.size(); world++) {
+        const auto dirty_cubes = m_worlds[world]->take_dirty_cubes();
+        std::vector<std::size_t> edited_chunks;
+        edited_chunks.reserve(dirty_cubes.size());
+        for (const auto &cube : dirty_cubes) {
+            const auto chunk = find_chunk(*m_worlds[world], *cube);
+            if (!chunk) {
+                // The chunks below the edited cube have been replaced, so all chunks of the world are created again.
+                partition_world(world, changed_slots);
+                edited_chunks.clear();
+                break;
+            }
+            edited_chunks.push_back(*chunk);
+        }
+        for (const auto idx : edited_chunks) {
+            auto &chunk = m_chunks[idx];
+            if (!chunk.loaded) {
+                // The mesh is created from the current state of the world when the chunk is loaded.
+                chunk.last_memory_usage = std::nullopt;
+                continue;
+            }
+            load(chunk, chunk.lod);
+            if (!chunk.slot) {
+                // A slot is assigned in update() if the chunk has geometry now.
+                continue;
+            }
+            changed_slots.push_back(*chunk.slot);
+            if (chunk.mesh.indices.empty()) {
+                m_slots[*chunk.slot] = std::nullopt;
+                chunk.slot = std::nullopt;
+            }
+        }
+    }
+}
+
+CullingResult ChunkManager::cull(const tools::Frustum &frustum) const {
+    const auto start = std::chrono::steady_clock::now();
+    CullingResult result;
+    for (const auto &world : m_worlds) {
+        cull(*world, frustum, tools::Frustum::ALL_PLANES, result);
+    }
+    result.culled_chunks =
+        static_cast<std::size_t>(std::count_if(m_slots.begin(), m_slots.end(), [](const auto &slot) { return slot; })) -
+        result.visible_chunks;
+    result.cpu_time = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+void ChunkManager::cull(const Cube &cube, const tools::Frustum &frustum, std::uint8_t plane_mask,
+                        CullingResult &result) const {
+    if (plane_mask != 0) {
+        result.tested_boxes++;
+        if (frustum.test(cube.bounding_box(), plane_mask) == tools::FrustumTest::OUTSIDE) {
+            return;
+        }
+    }
+    if (const auto chunk = m_chunk_lookup.find(&cube); chunk != m_chunk_lookup.end()) {
+        const auto &slot = m_chunks[chunk->second].slot;
+        if (slot) {
+            const auto index_count = m_chunks[chunk->second].mesh.indices.size();
+            result.draw_ranges.push_back({*slot, 0, static_cast<std::uint32_t>(index_count)});
+            result.visible_chunks++;
+            result.visible_triangles += index_count / 3;
+        }
+        return;
+    }
+    // Every cube above the chunk level which is not a chunk is an octant.
+    for (const auto &child : cube.children()) {
+        cull(*child, frustum, plane_mask, result);
+    }
+}
+
+const Chunk *ChunkManager::chunk_in_slot(const std::size_t slot) const {
+    if (slot >= m_slots.size() || !m_slots[slot]) {
+        return nullptr;
+    }
+    return &m_chunks[*m_slots[slot]];
+}
+
+void ChunkManager::collect_chunks(const std::size_t world, const std::shared_ptr<Cube> &cube, const std::size_t level) {
+    if (level < m_settings.chunk_level && cube->type() == Cube::Type::OCTANT) {
+        for (const auto &child : cube->children()) {
+            collect_chunks(world, child, level + 1);
+        }
+        return;
+    }
+    // Empty cubes become chunks as well, so edits which add geometry to them are found.
+    auto &chunk = m_chunks.emplace_back();
+    chunk.cube = cube;
+    chunk.world = world;
+    chunk.bounding_box = cube->bounding_box();
+}
+
+std::optional<std::size_t> ChunkManager::find_chunk(const Cube &world, const Cube &cube) const {
+    const glm::vec3 point = cube.center();
+    const Cube *current = &world;
+    while (true) {
+        if (const auto chunk = m_chunk_lookup.find(current); chunk != m_chunk_lookup.end()) {
+            return chunk->second;
+        }
+        if (current->size() <= cube.size() || current->type() != Cube::Type::OCTANT) {
+            return std::nullopt;
+        }
+        const glm::vec3 center = current->center();
+        const std::size_t child = (point.x >= center.x ? 4 : 0) | (point.y >= center.y ? 2 : 0) |
+                                  (point.z >= center.z ? 1 : 0);
+        current = current->children()[child].get();
+    }
+}
+
+void ChunkManager::load(Chunk &chunk, const std::size_t lod) {
+    MeshExtractionSettings mesh_settings = m_settings.mesh_settings;
+    if (lod > 0) {
+        const std::size_t depth = subtree_depth(*chunk.cube);
+        mesh_settings.max_depth = depth > lod ? depth - lod : 0;
+    }
+    IndexedMeshBuilder builder;
+    chunk.statistics = extract_mesh(*chunk.cube, builder, mesh_settings);
+    chunk.mesh = builder.build();
+    chunk.loaded = true;
+    chunk.lod = lod;
+    chunk.last_memory_usage = chunk.memory_usage(m_settings.vertex_size);
+}
+
+std::size_t ChunkManager::lod(const float distance) const {
+    return static_cast<std::size_t>(
+        std::lower_bound(m_settings.lod_distances.begin(), m_settings.lod_distances.end(), distance) -
+        m_settings.lod_distances.begin());
+}
+
+void ChunkManager::partition_world(const std::size_t world, std::vector<std::size_t> &changed_slots) {
+    for (auto &chunk : m_chunks) {
+        if (chunk.world == world) {
+            unload(chunk, changed_slots);
+        }
+    }
+    std::erase_if(m_chunks, [&](const Chunk &chunk) { return chunk.world == world; });
+    collect_chunks(world, m_worlds[world], 0);
+    rebuild_lookup();
+}
+
+void ChunkManager::rebuild_lookup() {
+    m_chunk_lookup.clear();
+    std::fill(m_slots.begin(), m_slots.end(), std::nullopt);
+    for (std::size_t idx = 0; idx < m_chunks.size(); idx++) {
+        m_chunk_lookup[m_chunks[idx].cube.get()] = idx;
+        if (m_chunks[idx].slot) {
+            m_slots[*m_chunks[idx].slot] = idx;
+        }
+    }
+}
+
+MeshStatistics ChunkManager::statistics() const {
+    MeshStatistics statistics;
+    for (const auto &chunk : m_chunks) {
+        if (chunk.loaded) {
+            statistics.geometry_cubes += chunk.statistics.geometry_cubes;
+            statistics.emitted_triangles += chunk.statistics.emitted_triangles;
+            statistics.culled_triangles += chunk.statistics.culled_triangles;
+            statistics.merged_triangles += chunk.statistics.merged_triangles;
+            statistics.collapsed_octants += chunk.statistics.collapsed_octants;
+        }
+    }
+    return statistics;
+}
+
+void ChunkManager::unload(Chunk &chunk, std::vector<std::size_t> &changed_slots) {
+    if (chunk.slot) {
+        changed_slots.push_back(*chunk.slot);
+        m_slots[*chunk.slot] = std::nullopt;
+        chunk.slot = std::nullopt;
+    }
+    chunk.mesh = {};
+    chunk.statistics = {};
+    chunk.loaded = false;
+}
+
+std::vector<std::size_t> ChunkManager::update(const glm::vec3 &camera_position) {
+    std::vector<std::size_t> changed_slots;
+    apply_edits(changed_slots);
+
+    // The distance between the camera and the closest point of the bounding box of each chunk
+    std::vector<float> distances(m_chunks.size());
+    for (std::size_t idx = 0; idx < m_chunks.size(); idx++) {
+        const auto &bounding_box = m_chunks[idx].bounding_box;
+        distances[idx] = glm::distance(camera_position, glm::clamp(camera_position, bounding_box[0], bounding_box[1]));
+    }
+    std::vector<std::size_t> order(m_chunks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](const std::size_t lhs, const std::size_t rhs) { return distances[lhs] < distances[rhs]; });
+
+    // Keep the closest chunks until one of the limits is reached. A chunk which does not fit stops the search, so
+    // chunks which are farther away never push out closer ones.
+    std::vector<bool> keep(m_chunks.size(), false);
+    std::size_t memory_usage = 0;
+    std::size_t used_slots = 0;
+    std::size_t loads = 0;
+    auto fits = [&](const std::size_t chunk_memory_usage) {
+        // Only chunks with an empty mesh use no memory, and those do not need a slot.
+        return memory_usage + chunk_memory_usage <= m_settings.memory_budget &&
+               (chunk_memory_usage == 0 || used_slots < m_slots.size());
+    };
+    for (const auto idx : order) {
+        if (distances[idx] > m_settings.load_distance) {
+            break;
+        }
+        auto &chunk = m_chunks[idx];
+        const std::size_t chunk_lod = lod(distances[idx]);
+        if (!chunk.loaded) {
+            // Avoid meshing a chunk in every update only to find out it still does not fit.
+            if (chunk.last_memory_usage && !fits(*chunk.last_memory_usage)) {
+                break;
+            }
+            if (loads == m_settings.max_loads_per_update) {
+                continue;
+            }
+            load(chunk, chunk_lod);
+            loads++;
+        } else if (chunk.lod != chunk_lod && loads < m_settings.max_loads_per_update) {
+            // The chunk keeps its previous level of detail until there is time to mesh it again.
+            load(chunk, chunk_lod);
+            loads++;
+            if (chunk.slot) {
+                changed_slots.push_back(*chunk.slot);
+                if (chunk.mesh.indices.empty()) {
+                    m_slots[*chunk.slot] = std::nullopt;
+                    chunk.slot = std::nullopt;
+                }
+            }
+        }
+        const std::size_t chunk_memory_usage = chunk.memory_usage(m_settings.vertex_size);
+        if (!fits(chunk_memory_usage)) {
+            break;
+        }
+        memory_usage += chunk_memory_usage;
+        used_slots += chunk.mesh.indices.empty() ? 0 : 1;
+        keep[idx] = true;
+    }
+
+    for (std::size_t idx = 0; idx < m_chunks.size(); idx++) {
+        if (m_chunks[idx].loaded && !keep[idx]) {
+            unload(m_chunks[idx], changed_slots);
+        }
+    }
+
+    // Evicting first makes sure there is a free slot for every chunk which is kept
+    std::size_t free_slot = 0;
+    for (const auto idx : order) {
+        auto &chunk = m_chunks[idx];
+        if (!keep[idx] || chunk.slot || chunk.mesh.indices.empty()) {
+            continue;
+        }
+        while (m_slots[free_slot]) {
+            free_slot++;
+        }
+        m_slots[free_slot] = idx;
+        chunk.slot = free_slot;
+        changed_slots.push_back(free_slot);
+    }
+    m_memory_usage = memory_usage;
+
+    std::sort(changed_slots.begin(), changed_slots.end());
+    changed_slots.erase(std::unique(changed_slots.begin(), changed_slots.end()), changed_slots.end());
+    return changed_slots;
+}
+
+} // namespace inexor::vulkan_renderer::octree
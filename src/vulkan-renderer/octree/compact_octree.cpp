@@ -0,0 +1,227 @@
+#include "inexor/vulkan-renderer/octree/compact_octree.hpp"
+
+#include <cassert>
+#include <functional>
+
+namespace inexor::vulkan_renderer::octree {
+
+namespace {
+
+/// Offset of a child in an octant, relative to the size of the child.
+/// Look into octree documentation to find information about the order of subcubes in space.
+glm::vec3 child_offset(const std::size_t idx) {
+    return {static_cast<float>((idx >> 2u) & 1u), static_cast<float>((idx >> 1u) & 1u), static_cast<float>(idx & 1u)};
+}
+
+} // namespace
+
+CompactOctree::CompactOctree() {
+    append_node(Cube::Type::EMPTY, INVALID_NODE);
+}
+
+CompactOctree::CompactOctree(const Cube &cube) : m_size(cube.size()), m_position(cube.position()) {
+    const std::size_t geometry_cubes = cube.count_geometry_cubes();
+    // Every geometry cube needs at least one octant, so this is only a lower bound.
+    m_types.reserve(geometry_cubes);
+    m_parents.reserve(geometry_cubes);
+    m_links.reserve(geometry_cubes);
+    convert(cube, append_node(cube.type(), INVALID_NODE));
+}
+
+CompactOctree::NodeIndex CompactOctree::append_node(const Cube::Type type, const NodeIndex parent) {
+    assert(m_types.size() < INVALID_NODE && "Octree too big!");
+    m_types.push_back(static_cast<std::uint8_t>(type));
+    m_parents.push_back(parent);
+    m_links.push_back(INVALID_NODE);
+    return static_cast<NodeIndex>(m_types.size() - 1);
+}
+
+std::array<glm::vec3, 2> CompactOctree::bounding_box(const NodeIndex node) const {
+    // Walk up to the root to find the size, then walk down again to accumulate the position.
+    std::size_t level = grid_level(node);
+    const float size = m_size / static_cast<float>(1u << level);
+    glm::vec3 position = m_position;
+    for (NodeIndex current = node; current != ROOT; current = m_parents[current]) {
+        position += child_offset(index_in_parent(current)) * (m_size / static_cast<float>(1u << level));
+        level--;
+    }
+    return {position, {position.x + size, position.y + size, position.z + size}};
+}
+
+CompactOctree::NodeIndex CompactOctree::child(const NodeIndex node, const std::size_t idx) const {
+    assert(idx < Cube::SUB_CUBES);
+    if (type(node) != Cube::Type::OCTANT) {
+        return INVALID_NODE;
+    }
+    return m_links[node] + static_cast<NodeIndex>(idx);
+}
+
+void CompactOctree::collect_polygons(const NodeIndex node, const glm::vec3 &position, const float size,
+                                     std::vector<Polygon> &polygons) const {
+    switch (type(node)) {
+    case Cube::Type::EMPTY:
+        return;
+    case Cube::Type::OCTANT: {
+        const float half_size = size / 2;
+        for (std::size_t idx = 0; idx < Cube::SUB_CUBES; idx++) {
+            collect_polygons(m_links[node] + static_cast<NodeIndex>(idx), position + child_offset(idx) * half_size,
+                             half_size, polygons);
+        }
+        return;
+    }
+    case Cube::Type::SOLID:
+    case Cube::Type::NORMAL: {
+        static const std::array<Indentation, Cube::EDGES> NO_INDENTATIONS{};
+        const auto &ind = type(node) == Cube::Type::NORMAL ? m_indentations[m_links[node]] : NO_INDENTATIONS;
+        const std::array<glm::vec3, 8> v = Cube::vertices(type(node), position, size, ind);
+        for (const auto &triangle : Cube::triangle_corners(type(node), ind)) {
+            polygons.push_back({{v[triangle[0]], v[triangle[1]], v[triangle[2]]}});
+        }
+        return;
+    }
+    }
+}
+
+void CompactOctree::convert(const Cube &cube, const NodeIndex node) {
+    if (cube.type() == Cube::Type::NORMAL) {
+        m_links[node] = static_cast<NodeIndex>(m_indentations.size());
+        m_indentations.push_back(cube.indentations());
+        return;
+    }
+    if (cube.type() != Cube::Type::OCTANT) {
+        return;
+    }
+    // Reserve the whole block of children first, so siblings are always stored next to each other.
+    const auto first_child = static_cast<NodeIndex>(m_types.size());
+    m_links[node] = first_child;
+    for (const auto &child : cube.children()) {
+        append_node(child->type(), node);
+    }
+    for (std::size_t idx = 0; idx < Cube::SUB_CUBES; idx++) {
+        convert(*cube.children()[idx], first_child + static_cast<NodeIndex>(idx));
+    }
+}
+
+std::size_t CompactOctree::count_geometry_cubes() const noexcept {
+    std::size_t count = 0;
+    for (const auto type : m_types) {
+        const auto cube_type = static_cast<Cube::Type>(type);
+        if (cube_type == Cube::Type::SOLID || cube_type == Cube::Type::NORMAL) {
+            count++;
+        }
+    }
+    return count;
+}
+
+std::size_t CompactOctree::grid_level(NodeIndex node) const {
+    std::size_t level = 0;
+    while (node != ROOT) {
+        node = m_parents[node];
+        level++;
+    }
+    return level;
+}
+
+const std::array<Indentation, Cube::EDGES> &CompactOctree::indentations(const NodeIndex node) const {
+    assert(type(node) == Cube::Type::NORMAL);
+    return m_indentations[m_links[node]];
+}
+
+std::size_t CompactOctree::memory_usage() const noexcept {
+    return sizeof(CompactOctree) + m_types.capacity() * sizeof(std::uint8_t) +
+           m_parents.capacity() * sizeof(NodeIndex) + m_links.capacity() * sizeof(NodeIndex) +
+           m_indentations.capacity() * sizeof(std::array<Indentation, Cube::EDGES>);
+}
+
+CompactOctree::NodeIndex CompactOctree::neighbor(const NodeIndex node, const Cube::NeighborAxis axis,
+                                                 const Cube::NeighborDirection direction) const {
+    if (node == ROOT) {
+        return INVALID_NODE;
+    }
+    // This follows Samets "OT_GTEQ_FACE_NEIGHBOR(P,I)", but instead of keeping a history of the visited indices, the
+    // indices are looked up again in the parent array on the way down.
+    const auto relevant_index_bit = static_cast<std::uint8_t>(axis);
+
+    auto get_bit = [&relevant_index_bit](const std::uint8_t cube_index) {
+        return ((cube_index >> relevant_index_bit) & 1u) != 0;
+    };
+    auto toggle_bit = [&relevant_index_bit](const std::uint8_t cube_index) {
+        return static_cast<std::uint8_t>(cube_index ^ (1u << relevant_index_bit));
+    };
+
+    const NodeIndex parent_node = m_parents[node];
+    const std::uint8_t index = index_in_parent(node);
+    const bool home_bit = get_bit(index);
+
+    if ((home_bit && direction == Cube::NeighborDirection::NEGATIVE) ||
+        (!home_bit && direction == Cube::NeighborDirection::POSITIVE)) {
+        // The demanded neighbor is a sibling!
+        return m_links[parent_node] + toggle_bit(index);
+    }
+    if (parent_node == ROOT) {
+        return INVALID_NODE;
+    }
+
+    // Find the first ancestor whose index bit is different to the home bit.
+    // That ancestors parent is the first mutual parent of the desired neighbor and the node.
+    NodeIndex ancestor = parent_node;
+    std::size_t path_length = 2;
+    while (get_bit(index_in_parent(ancestor)) == home_bit) {
+        ancestor = m_parents[ancestor];
+        if (ancestor == ROOT) {
+            return INVALID_NODE;
+        }
+        path_length++;
+    }
+
+    // Now mirror the path we took by flipping the relevant bit of each index on the path.
+    NodeIndex current = m_parents[ancestor];
+    for (std::size_t remaining = path_length; remaining > 0; remaining--) {
+        if (type(current) != Cube::Type::OCTANT) {
+            // The neighbor is larger but still a neighbor!
+            return current;
+        }
+        NodeIndex on_path = node;
+        for (std::size_t distance = 1; distance < remaining; distance++) {
+            on_path = m_parents[on_path];
+        }
+        current = m_links[current] + toggle_bit(index_in_parent(on_path));
+    }
+    // We found a same-sized neighbor!
+    return current;
+}
+
+std::vector<Polygon> CompactOctree::polygons() const {
+    std::vector<Polygon> polygons;
+    polygons.reserve(count_geometry_cubes() * Cube::EDGES);
+    this->polygons(polygons);
+    return polygons;
+}
+
+void CompactOctree::polygons(std::vector<Polygon> &polygons) const {
+    collect_polygons(ROOT, m_position, m_size, polygons);
+}
+
+std::shared_ptr<Cube> CompactOctree::to_cube() const {
+    std::shared_ptr<Cube> root = std::make_shared<Cube>(m_size, m_position);
+
+    std::function<void(Cube &, NodeIndex)> copy_node = [&](Cube &cube, const NodeIndex node) {
+        cube.set_type(type(node));
+        if (type(node) == Cube::Type::NORMAL) {
+            const auto &ind = indentations(node);
+            for (std::uint8_t edge = 0; edge < Cube::EDGES; edge++) {
+                cube.set_indent(edge, ind[edge]);
+            }
+            return;
+        }
+        if (type(node) == Cube::Type::OCTANT) {
+            for (std::size_t idx = 0; idx < Cube::SUB_CUBES; idx++) {
+                copy_node(*cube.children()[idx], m_links[node] + static_cast<NodeIndex>(idx));
+            }
+        }
+    };
+    copy_node(*root, ROOT);
+    return root;
+}
+
+} // namespace inexor::vulkan_renderer::octree
@@ -1,9 +1,17 @@
 #include "inexor/vulkan-renderer/octree/cube.hpp"
 
 #include "inexor/vulkan-renderer/octree/indentation.hpp"
+#include "inexor/vulkan-renderer/tools/allocators/arena_allocator.hpp"
+#include "inexor/vulkan-renderer/tools/parallel.hpp"
 #include "inexor/vulkan-renderer/tools/random.hpp"
 
+#include <glm/common.hpp>
+
+#include <algorithm>
 #include <functional>
+#include <iterator>
+#include <random>
+#include <stdexcept>
 #include <utility>
 
 void swap(inexor::vulkan_renderer::octree::Cube &lhs, inexor::vulkan_renderer::octree::Cube &rhs) noexcept {
@@ -11,21 +19,41 @@ void swap(inexor::vulkan_renderer::octree::Cube &lhs, inexor::vulkan_renderer::o
     std::swap(lhs.m_size, rhs.m_size);
     std::swap(lhs.m_position, rhs.m_position);
     std::swap(lhs.m_parent, rhs.m_parent);
-    std::swap(lhs.m_index_in_parent, rhs.m_index_in_parent);
+    std::swap(lhs.m_code, rhs.m_code);
     std::swap(lhs.m_indentations, rhs.m_indentations);
     std::swap(lhs.m_children, rhs.m_children);
+    // The children have changed their owner.
+    for (auto *cube : {&lhs, &rhs}) {
+        for (const auto &child : cube->m_children) {
+            if (child) {
+                child->m_parent = cube;
+            }
+        }
+    }
     std::swap(lhs.m_polygon_cache, rhs.m_polygon_cache);
     std::swap(lhs.m_polygon_cache_valid, rhs.m_polygon_cache_valid);
+    std::swap(lhs.m_dirty, rhs.m_dirty);
+    std::swap(lhs.m_subtree_dirty, rhs.m_subtree_dirty);
+    std::swap(lhs.m_dirty_bounds, rhs.m_dirty_bounds);
 }
 
 namespace inexor::vulkan_renderer::octree {
 
 Cube::Cube(const float size, const glm::vec3 &position) : m_size(size), m_position(position) {}
 
-Cube::Cube(std::weak_ptr<Cube> parent, const std::uint8_t index, const float size, const glm::vec3 &position)
+Cube::Cube(Cube *parent, const std::uint8_t index, const float size, const glm::vec3 &position)
     : Cube(size, position) {
-    m_parent = std::move(parent);
-    m_index_in_parent = index;
+    m_parent = parent;
+    m_code = parent->m_code.child(index);
+}
+
+Cube::~Cube() {
+    for (const auto &child : m_children) {
+        // Children which are still referenced somewhere else outlive this cube.
+        if (child && child.use_count() > 1) {
+            child->detach();
+        }
+    }
 }
 
 Cube::Cube(Cube &&rhs) noexcept : Cube() {
@@ -52,28 +80,108 @@ std::shared_ptr<const Cube> Cube::operator[](std::size_t idx) const {
     return m_children[idx];
 }
 
+const Cube *Cube::ancestor(const std::size_t level) const noexcept {
+    const std::size_t own_level = m_code.level();
+    if (level > own_level) {
+        return nullptr;
+    }
+    const Cube *cube = this;
+    for (std::size_t steps = own_level - level; steps > 0; steps--) {
+        cube = cube->m_parent;
+    }
+    return cube;
+}
+
 const std::array<std::shared_ptr<Cube>, Cube::SUB_CUBES> &Cube::children() const {
     return m_children;
 }
 
 std::shared_ptr<Cube> Cube::clone() const {
-    std::shared_ptr<Cube> clone = std::make_shared<Cube>(this->m_size, this->m_position);
-    clone->m_type = this->m_type;
-    clone->m_index_in_parent = this->m_index_in_parent;
-
-    if (clone->m_type == Type::NORMAL) {
-        clone->m_indentations = this->m_indentations;
-    } else if (clone->m_type == Type::OCTANT) {
-        for (std::size_t idx = 0; idx <= this->m_children.size(); idx++) {
-            clone->m_children[idx] = this->m_children[idx]->clone();
-            clone->m_children[idx]->m_parent = clone;
+    std::size_t cube_count = 0;
+    std::function<void(const Cube &)> count_cubes = [&](const Cube &cube) {
+        cube_count++;
+        if (cube.m_type == Type::OCTANT) {
+            for (const auto &child : cube.m_children) {
+                count_cubes(*child);
+            }
+        }
+    };
+    count_cubes(*this);
+
+    auto *arena = tools::allocators::Arena::create(cube_count);
+    const tools::allocators::ArenaAllocator<Cube> allocator(arena);
+    std::function<std::shared_ptr<Cube>(const Cube &, Cube *, LocationalCode)> clone_cube =
+        [&](const Cube &cube, Cube *parent, const LocationalCode code) {
+            auto clone = std::allocate_shared<Cube>(allocator, cube.m_size, cube.m_position);
+            clone->m_type = cube.m_type;
+            clone->m_parent = parent;
+            clone->m_arena = arena;
+            clone->m_code = code;
+            clone->m_indentations = cube.m_indentations;
+            clone->m_polygon_cache = cube.m_polygon_cache;
+            clone->m_polygon_cache_valid = cube.m_polygon_cache_valid;
+            if (cube.m_type == Type::OCTANT) {
+                for (std::uint8_t idx = 0; idx < SUB_CUBES; idx++) {
+                    clone->m_children[idx] = clone_cube(*cube.m_children[idx], clone.get(), code.child(idx));
+                }
+            }
+            return clone;
+        };
+    std::shared_ptr<Cube> clone;
+    try {
+        clone = clone_cube(*this, nullptr, {});
+    } catch (...) {
+        arena->seal();
+        throw;
+    }
+    arena->seal();
+    return clone;
+}
+
+void Cube::clear_dirty() {
+    if (!m_subtree_dirty) {
+        return;
+    }
+    m_dirty = false;
+    m_subtree_dirty = false;
+    if (m_type == Type::OCTANT) {
+        for (const auto &child : m_children) {
+            child->clear_dirty();
         }
     }
-    clone->m_polygon_cache_valid = this->m_polygon_cache_valid;
-    if (clone->m_type == Type::NORMAL || clone->m_type == Type::SOLID) {
-        clone->m_polygon_cache = std::make_shared<std::vector<Polygon>>(*this->m_polygon_cache);
+}
+
+void Cube::collect_dirty_cubes(std::vector<std::shared_ptr<Cube>> &cubes) {
+    if (!m_subtree_dirty) {
+        return;
+    }
+    if (m_dirty) {
+        cubes.push_back(shared_from_this());
+        clear_dirty();
+        return;
+    }
+    m_subtree_dirty = false;
+    if (m_type == Type::OCTANT) {
+        for (const auto &child : m_children) {
+            child->collect_dirty_cubes(cubes);
+        }
+    }
+}
+
+void Cube::collect_polygons(std::vector<PolygonCache> &polygons, const bool update_invalid) const {
+    // post-order traversal
+    if (m_type == Type::OCTANT) {
+        for (const auto &child : m_children) {
+            child->collect_polygons(polygons, update_invalid);
+        }
+        return;
+    }
+    if (!m_polygon_cache_valid && update_invalid) {
+        update_polygon_cache();
+    }
+    if (m_polygon_cache != nullptr) {
+        polygons.push_back(m_polygon_cache);
     }
-    return clone;
 }
 
 std::size_t Cube::count_geometry_cubes() const noexcept {
@@ -90,48 +198,99 @@ std::size_t Cube::count_geometry_cubes() const noexcept {
     return 0;
 }
 
-std::shared_ptr<Cube> create_random_world(std::uint32_t max_depth, const glm::vec3 &position,
-                                          const std::optional<std::uint32_t> seed) {
-    std::shared_ptr<Cube> cube = std::make_shared<Cube>(4.0f, position);
-    cube->set_type(Cube::Type::OCTANT);
-    std::function<void(const Cube &, std::uint32_t)> populate_cube = [&](const Cube &parent, std::uint32_t depth) {
-        for (const auto &child : parent.children()) {
-            if (depth != max_depth) {
-                child->set_type(Cube::Type::OCTANT);
-                populate_cube(*child, depth + 1);
-                continue;
-            }
-            const auto ty = tools::generate_random_number(0, 100, seed);
-            if (ty < 30) {
-                child->set_type(Cube::Type::EMPTY);
-                continue;
+std::shared_ptr<Cube> create_random_world(const std::uint32_t max_depth, const glm::vec3 &position,
+                                          const std::optional<std::uint32_t> seed, const std::size_t thread_count) {
+    if (max_depth >= LocationalCode::MAX_LEVEL) {
+        throw std::invalid_argument("Error: The depth of a random world must be smaller than the maximum level!");
+    }
+    const std::uint32_t world_seed = seed.value_or(std::random_device{}());
+    std::shared_ptr<Cube> world = std::make_shared<Cube>(4.0f, position);
+    world->set_type(Cube::Type::OCTANT);
+
+    std::function<void(Cube &)> populate_cube = [&](Cube &cube) {
+        if (cube.m_code.level() <= max_depth) {
+            cube.change_type(Cube::Type::OCTANT);
+            for (const auto &child : cube.m_children) {
+                populate_cube(*child);
             }
-            if (ty < 60) {
-                child->set_type(Cube::Type::SOLID);
-                continue;
+            return;
+        }
+        const RandomWorldCube leaf = random_world_cube(world_seed, cube.m_code);
+        cube.change_type(leaf.type);
+        cube.m_indentations = leaf.indentations;
+    };
+
+    // Every leaf only depends on its locational code, so the subtrees below the split level can be built on multiple
+    // threads without changing the result. change_type does not touch the parents, which keeps the subtrees disjoint.
+    constexpr std::size_t SPLIT_LEVEL{2};
+    std::vector<Cube *> subtrees{world.get()};
+    while (subtrees.front()->m_code.level() < std::min<std::size_t>(SPLIT_LEVEL, max_depth + 1)) {
+        std::vector<Cube *> children;
+        children.reserve(subtrees.size() * Cube::SUB_CUBES);
+        for (Cube *cube : subtrees) {
+            cube->change_type(Cube::Type::OCTANT);
+            for (const auto &child : cube->m_children) {
+                children.push_back(child.get());
             }
-            if (ty < 100) {
-                child->set_type(Cube::Type::NORMAL);
-                for (int i = 0; i < 12; i++) {
-                    std::uint8_t indent_value = tools::generate_random_number(0, 44, seed);
-                    child->set_indent(i, Indentation(indent_value));
-                }
-                continue;
+        }
+        subtrees = std::move(children);
+    }
+    tools::parallel_for(
+        subtrees.size(), [&](const std::size_t idx) { populate_cube(*subtrees[idx]); }, thread_count);
+    return world;
+}
+
+RandomWorldCube random_world_cube(const std::uint32_t seed, const LocationalCode &code) noexcept {
+    // The first number of a cube selects its type, the following ones its indentations.
+    const std::uint64_t key = tools::counter_based_random(seed, code.value());
+    RandomWorldCube cube;
+    const auto type = tools::random_below(tools::counter_based_random(key, 0), 100);
+    if (type < 30) {
+        cube.type = Cube::Type::EMPTY;
+    } else if (type < 60) {
+        cube.type = Cube::Type::SOLID;
+    } else {
+        cube.type = Cube::Type::NORMAL;
+        for (std::size_t edge = 0; edge < Cube::EDGES; edge++) {
+            cube.indentations[edge] = Indentation(static_cast<std::uint8_t>(
+                tools::random_below(tools::counter_based_random(key, edge + 1), Indentation::UID_COUNT)));
+        }
+    }
+    return cube;
+}
+
+void Cube::detach() {
+    m_parent = nullptr;
+    std::function<void(Cube &, LocationalCode)> update_codes = [&](Cube &cube, const LocationalCode code) {
+        cube.m_code = code;
+        for (std::uint8_t idx = 0; idx < SUB_CUBES; idx++) {
+            // Children which have been removed by remove_children() are nullptr.
+            if (cube.m_children[idx]) {
+                update_codes(*cube.m_children[idx], code.child(idx));
             }
         }
     };
-    populate_cube(*cube, 0);
+    update_codes(*this, {});
+}
+
+const Cube *Cube::find(const LocationalCode &code) const noexcept {
+    const std::size_t level = code.level();
+    const Cube *cube = ancestor(LocationalCode::common_level(m_code, code));
+    for (std::size_t child_level = cube->m_code.level() + 1; child_level <= level; child_level++) {
+        if (cube->m_type != Type::OCTANT) {
+            break;
+        }
+        cube = cube->m_children[code.child_index(child_level)].get();
+    }
     return cube;
 }
 
-std::size_t Cube::grid_level() const noexcept {
-    std::size_t level = 0;
-    std::shared_ptr<Cube> parent = m_parent.lock();
-    while (!parent->is_root()) {
-        parent = parent->m_parent.lock();
-        level++;
+const Cube *Cube::find_neighbor(const NeighborAxis axis, const NeighborDirection direction) const noexcept {
+    const auto code = m_code.neighbor(static_cast<std::size_t>(axis), direction == NeighborDirection::POSITIVE);
+    if (!code) {
+        return nullptr;
     }
-    return level;
+    return find(*code);
 }
 
 void Cube::indent(const std::uint8_t edge_id, const bool positive_direction, const std::uint8_t steps) {
@@ -144,7 +303,14 @@ void Cube::indent(const std::uint8_t edge_id, const bool positive_direction, con
     } else {
         m_indentations[edge_id].indent_end(steps);
     }
-    m_polygon_cache_valid = false;
+    mark_dirty();
+}
+
+std::optional<std::array<glm::vec3, 2>> Cube::dirty_bounds() const noexcept {
+    if (!m_subtree_dirty) {
+        return std::nullopt;
+    }
+    return m_dirty_bounds;
 }
 
 std::array<Indentation, Cube::EDGES> Cube::indentations() const noexcept {
@@ -155,117 +321,120 @@ void Cube::invalidate_polygon_cache() const {
     m_polygon_cache_valid = false;
 }
 
-bool Cube::is_root() const noexcept {
-    return m_parent.lock() == nullptr;
-}
-
 std::vector<PolygonCache> Cube::polygons(const bool update_invalid) const {
     std::vector<PolygonCache> polygons;
     polygons.reserve(count_geometry_cubes());
-
-    // post-order traversal
-    std::function<void(const Cube &)> collect = [&collect, &polygons, &update_invalid](const Cube &cube) {
-        if (cube.type() == octree::Cube::Type::OCTANT) {
-            for (const auto &child : cube.children()) {
-                collect(*child);
-            }
-            return;
-        }
-        if (!cube.m_polygon_cache_valid && update_invalid) {
-            cube.update_polygon_cache();
-        }
-        if (cube.m_polygon_cache != nullptr) {
-            polygons.push_back(cube.m_polygon_cache);
-        }
-    };
-    collect(*this);
+    collect_polygons(polygons, update_invalid);
     return polygons;
 }
 
 std::shared_ptr<Cube> Cube::neighbor(const NeighborAxis axis, const NeighborDirection direction) {
-    if (is_root()) {
+    const Cube *neighbor = find_neighbor(axis, direction);
+    if (neighbor == nullptr) {
         return nullptr;
     }
+    // The neighbor is never the root, so it is owned by its parent.
+    return neighbor->m_parent->m_children[neighbor->m_code.child_index()];
+}
 
-    // Each axis only requires information and manipulation of one (relevant) bit to find the neighbor.
-    const auto relevant_index_bit = static_cast<std::uint8_t>(axis); // bit index of the axis we are working on
-
-    auto get_bit = [&relevant_index_bit](const std::uint8_t cube_index) {
-        return ((cube_index >> relevant_index_bit) & 1u) != 0;
-    };
-    auto toggle_bit = [&relevant_index_bit](const std::uint8_t cube_index) {
-        return cube_index ^ (1u << relevant_index_bit);
+std::vector<PolygonCache> Cube::parallel_polygons(const bool update_invalid, const std::size_t split_depth,
+                                                  const std::size_t thread_count) const {
+    // Gather the subtrees in the same order as the traversal of polygons(), so the result can be concatenated.
+    std::vector<const Cube *> subtrees;
+    std::function<void(const Cube &, std::size_t)> split = [&](const Cube &cube, const std::size_t depth) {
+        if (cube.m_type != Type::OCTANT || depth == split_depth) {
+            subtrees.push_back(&cube);
+            return;
+        }
+        for (const auto &child : cube.m_children) {
+            split(*child, depth + 1);
+        }
     };
+    split(*this, 0);
 
-    auto parent = m_parent.lock();
-    const std::uint8_t index = m_index_in_parent;
-    const bool home_bit = get_bit(index);
+    std::vector<std::vector<PolygonCache>> subtree_polygons(subtrees.size());
+    tools::parallel_for(
+        subtrees.size(),
+        [&](const std::size_t idx) { subtrees[idx]->collect_polygons(subtree_polygons[idx], update_invalid); },
+        thread_count);
 
-    // The relevant bit denotes whether `m_parent` and `this` share a face on the upper side of the relevant axis.
-    // If they share one and also the user wants to go in the positive direction, then the neighbor is not a sibling.
-    // (Same for opposite, i.e. share face on lower side and going negative direction.)
-    if (home_bit && direction == NeighborDirection::NEGATIVE || !home_bit && direction == NeighborDirection::POSITIVE) {
-        // The demanded neighbor is a sibling! Return the neighboring sibling.
-        return parent->m_children[toggle_bit(index)];
+    std::size_t total_count = 0;
+    for (const auto &polygons : subtree_polygons) {
+        total_count += polygons.size();
     }
-    if (parent->is_root()) {
-        return nullptr;
-    }
-    // the neighbor is further away than a sibling
-
-    // Keep the history of indices because we just need to mirror indices (i.e. toggle the relevant bit)
-    // to find the desired neighboring cube.
-    std::vector<std::uint8_t> history;
-    history.push_back(index);
-
-    // Find the first cube where the bit (of `get_bit`) is different to `this_bit`.
-    // That cubes parent is the first mutual parent of the desired neighbor and `this`.
-    std::uint8_t p_index = parent->m_index_in_parent;
-    history.push_back(p_index);
-    while (get_bit(p_index) == home_bit) {
-        parent = parent->m_parent.lock();
-        if (parent->is_root()) {
-            return nullptr;
-        }
-        p_index = parent->m_index_in_parent;
-        history.push_back(p_index);
+    std::vector<PolygonCache> polygons;
+    polygons.reserve(total_count);
+    for (auto &subtree : subtree_polygons) {
+        std::move(subtree.begin(), subtree.end(), std::back_inserter(polygons));
     }
+    return polygons;
+}
 
-    // get the first mutual parent of neighbor and `this`.
-    std::shared_ptr<Cube> child = parent->m_parent.lock();
+void Cube::mark_dirty() {
+    m_polygon_cache_valid = false;
+    m_dirty = true;
 
-    // Now mirror the path we took by just flipping the relevant bit of each index in the history.
-    while (!history.empty()) {
-        if (child->m_type != Type::OCTANT) {
-            // The neighbor is larger but still a neighbor!
-            return {child};
+    const std::array<glm::vec3, 2> bounds = bounding_box();
+    auto contains_bounds = [&bounds](const Cube &cube) {
+        const auto &[min, max] = cube.m_dirty_bounds;
+        return cube.m_subtree_dirty && min.x <= bounds[0].x && min.y <= bounds[0].y && min.z <= bounds[0].z &&
+               max.x >= bounds[1].x && max.y >= bounds[1].y && max.z >= bounds[1].z;
+    };
+    auto expand_bounds = [&bounds](Cube &cube) {
+        if (!cube.m_subtree_dirty) {
+            cube.m_dirty_bounds = bounds;
+            cube.m_subtree_dirty = true;
+            return;
         }
-        child = child->m_children[toggle_bit(history.back())];
-        history.pop_back();
-    }
+        cube.m_dirty_bounds[0] = glm::min(cube.m_dirty_bounds[0], bounds[0]);
+        cube.m_dirty_bounds[1] = glm::max(cube.m_dirty_bounds[1], bounds[1]);
+    };
 
-    // We found a same-sized neighbor!
-    return {child};
+    if (contains_bounds(*this)) {
+        // The dirty bounds of all parents already contain this cube.
+        return;
+    }
+    expand_bounds(*this);
+    for (Cube *parent = m_parent; parent != nullptr; parent = parent->m_parent) {
+        if (contains_bounds(*parent)) {
+            break;
+        }
+        expand_bounds(*parent);
+    }
 }
 
 void Cube::remove_children() {
     for (auto &child : m_children) {
-        child->remove_children();
-        child.reset();
+        // Children which have been turned into leaves before do not have children of their own anymore.
+        if (child) {
+            child->remove_children();
+            if (child.use_count() > 1) {
+                child->detach();
+            }
+            child.reset();
+        }
     }
 }
 
-std::shared_ptr<Cube> Cube::root() {
-    std::shared_ptr<Cube> new_parent = m_parent.lock();
-    if (!new_parent) {
-        return shared_from_this();
+const Cube &Cube::root() const noexcept {
+    const Cube *cube = this;
+    while (cube->m_parent != nullptr) {
+        cube = cube->m_parent;
     }
-    std::shared_ptr<Cube> parent;
-    while (new_parent) {
-        parent = new_parent;
-        new_parent = parent->m_parent.lock();
+    return *cube;
+}
+
+void Cube::place_children() {
+    const float half_size = m_size / 2;
+    for (std::uint8_t idx = 0; idx < SUB_CUBES; idx++) {
+        Cube &child = *m_children[idx];
+        child.m_code = m_code.child(idx);
+        child.m_position = m_position + glm::vec3(static_cast<float>((idx >> 2) & 1u) * half_size,
+                                                  static_cast<float>((idx >> 1) & 1u) * half_size,
+                                                  static_cast<float>(idx & 1u) * half_size);
+        // The geometry has moved.
+        child.m_polygon_cache_valid = false;
     }
-    return parent;
 }
 
 /// 90 degree rotation.
@@ -286,6 +455,7 @@ void Cube::rotate<1>(const RotationAxis::Type &axis) {
             m_indentations[edge_rotation[idx][0]].mirror();
             m_indentations[edge_rotation[idx][2]].mirror();
         }
+        m_polygon_cache_valid = false;
         return;
     }
     if (m_type == Type::OCTANT) {
@@ -295,6 +465,7 @@ void Cube::rotate<1>(const RotationAxis::Type &axis) {
             std::swap(m_children[order[1]], m_children[order[2]]);
             std::swap(m_children[order[2]], m_children[order[3]]);
         }
+        place_children();
         for (auto &child : m_children) {
             child->rotate<1>(axis);
         }
@@ -318,6 +489,7 @@ void Cube::rotate<2>(const RotationAxis::Type &axis) {
             m_indentations[edge_rotation[idx][2]].mirror();
             m_indentations[edge_rotation[idx][3]].mirror();
         }
+        m_polygon_cache_valid = false;
         return;
     }
     if (m_type == Type::OCTANT) {
@@ -326,6 +498,7 @@ void Cube::rotate<2>(const RotationAxis::Type &axis) {
             std::swap(m_children[order[0]], m_children[order[2]]);
             std::swap(m_children[order[1]], m_children[order[3]]);
         }
+        place_children();
         for (auto &child : m_children) {
             child->rotate<2>(axis);
         }
@@ -348,6 +521,7 @@ void Cube::rotate<3>(const RotationAxis::Type &axis) {
         m_indentations[edge_rotation[0][3]].mirror();
         m_indentations[edge_rotation[1][1]].mirror();
         m_indentations[edge_rotation[1][3]].mirror();
+        m_polygon_cache_valid = false;
         return;
     }
     if (m_type == Type::OCTANT) {
@@ -357,6 +531,7 @@ void Cube::rotate<3>(const RotationAxis::Type &axis) {
             std::swap(m_children[order[3]], m_children[order[2]]);
             std::swap(m_children[order[2]], m_children[order[1]]);
         }
+        place_children();
         for (auto &child : m_children) {
             child->rotate<3>(axis);
         }
@@ -381,6 +556,7 @@ void Cube::rotate(const RotationAxis::Type &axis, int rotations) {
     default:
         break;
     }
+    mark_dirty();
 }
 
 void Cube::set_indent(const std::uint8_t edge_id, Indentation indentation) {
@@ -389,9 +565,10 @@ void Cube::set_indent(const std::uint8_t edge_id, Indentation indentation) {
     }
     assert(edge_id <= Cube::EDGES);
     m_indentations[edge_id] = indentation;
+    mark_dirty();
 }
 
-void Cube::set_type(const Type new_type) {
+void Cube::change_type(const Type new_type) {
     if (m_type == new_type) {
         return;
     }
@@ -403,10 +580,13 @@ void Cube::set_type(const Type new_type) {
         m_indentations = {};
         break;
     case Type::OCTANT:
+        if (m_code.level() == LocationalCode::MAX_LEVEL) {
+            throw std::length_error("Error: Cubes at LocationalCode::MAX_LEVEL cannot be subdivided!");
+        }
         const float half_size = m_size / 2;
         std::uint8_t index = 0;
         auto create_cube = [&](const glm::vec3 &offset) {
-            return std::make_shared<Cube>(weak_from_this(), index++, half_size, m_position + offset);
+            return std::make_shared<Cube>(this, index++, half_size, m_position + offset);
         };
         // Look into octree documentation to find information about the order of subcubes in space.
         // We can't use initializer list here because clang-tidy complains about it.
@@ -424,15 +604,83 @@ void Cube::set_type(const Type new_type) {
     if (m_type == Type::OCTANT && new_type != Type::OCTANT) {
         remove_children();
     }
-    m_polygon_cache_valid = false;
     m_type = new_type;
-    // TODO: clean up if whole octant is empty, etc.
+    m_polygon_cache_valid = false;
+}
+
+void Cube::set_type(const Type new_type) {
+    if (m_type == new_type) {
+        return;
+    }
+    change_type(new_type);
+    mark_dirty();
+}
+
+std::vector<std::shared_ptr<Cube>> Cube::take_dirty_cubes() {
+    std::vector<std::shared_ptr<Cube>> cubes;
+    collect_dirty_cubes(cubes);
+    return cubes;
 }
 
 Cube::Type Cube::type() const noexcept {
     return m_type;
 }
 
+std::array<std::array<std::uint8_t, 3>, Cube::EDGES>
+Cube::triangle_corners(const Type type, const std::array<Indentation, Cube::EDGES> &indentations) noexcept {
+    std::array<std::array<std::uint8_t, 3>, Cube::EDGES> triangles{{
+        {0, 2, 1}, // x = 0
+        {1, 2, 3}, // x = 0
+        {4, 5, 6}, // x = 1
+        {5, 7, 6}, // x = 1
+        {0, 1, 4}, // y = 0
+        {1, 5, 4}, // y = 0
+        {2, 6, 3}, // y = 1
+        {3, 6, 7}, // y = 1
+        {0, 4, 2}, // z = 0
+        {2, 4, 6}, // z = 0
+        {1, 3, 5}, // z = 1
+        {3, 7, 5}  // z = 1
+    }};
+    if (type != Type::NORMAL) {
+        return triangles;
+    }
+    const std::array<Indentation, Cube::EDGES> &ind = indentations;
+
+    // Check for each side if the side is convex, rotate the hypotenuse (middle diagonal edge) so it becomes convex!
+    // x = 0
+    if (ind[0].start() + ind[6].start() < ind[9].start() + ind[3].start()) {
+        triangles[0] = {0, 2, 3};
+        triangles[1] = {0, 3, 1};
+    }
+    // x = 1
+    if (ind[0].end() + ind[6].end() < ind[9].end() + ind[3].end()) {
+        triangles[2] = {4, 7, 6};
+        triangles[3] = {4, 5, 7};
+    }
+    // y = 0
+    if (ind[1].start() + ind[7].start() < ind[4].start() + ind[10].start()) {
+        triangles[4] = {0, 1, 5};
+        triangles[5] = {0, 5, 4};
+    }
+    // y = 1
+    if (ind[1].end() + ind[7].end() < ind[4].end() + ind[10].end()) {
+        triangles[6] = {2, 7, 3};
+        triangles[7] = {2, 6, 7};
+    }
+    // z = 0
+    if (ind[2].start() + ind[8].start() < ind[11].start() + ind[5].start()) {
+        triangles[8] = {0, 4, 6};
+        triangles[9] = {0, 6, 2};
+    }
+    // z = 1
+    if (ind[2].end() + ind[8].end() < ind[11].end() + ind[5].end()) {
+        triangles[10] = {1, 3, 7};
+        triangles[11] = {1, 7, 5};
+    }
+    return triangles;
+}
+
 void Cube::update_polygon_cache() const {
     if (m_type == Type::OCTANT || m_type == Type::EMPTY) {
         m_polygon_cache = nullptr;
@@ -440,72 +688,26 @@ void Cube::update_polygon_cache() const {
         return;
     }
     const std::array<glm::vec3, 8> v = vertices();
-    m_polygon_cache = std::make_shared<std::vector<Polygon>>(std::vector<Polygon>{
-        {{v[0], v[2], v[1]}}, // x = 0
-        {{v[1], v[2], v[3]}}, // x = 0
-        {{v[4], v[5], v[6]}}, // x = 1
-        {{v[5], v[7], v[6]}}, // x = 1
-        {{v[0], v[1], v[4]}}, // y = 0
-        {{v[1], v[5], v[4]}}, // y = 0
-        {{v[2], v[6], v[3]}}, // y = 1
-        {{v[3], v[6], v[7]}}, // y = 1
-        {{v[0], v[4], v[2]}}, // z = 0
-        {{v[2], v[4], v[6]}}, // z = 0
-        {{v[1], v[3], v[5]}}, // z = 1
-        {{v[3], v[7], v[5]}}  // z = 1
-    });
-    if (m_type == Type::SOLID) {
-        m_polygon_cache_valid = true;
-        return;
-    }
-    if (m_type == Type::NORMAL) {
-        const std::array<Indentation, Cube::EDGES> ind = m_indentations;
-
-        // Check for each side if the side is convex, rotate the hypotenuse (middle diagonal edge) so it becomes convex!
-        // x = 0
-        if (ind[0].start() + ind[6].start() < ind[9].start() + ind[3].start()) {
-            (*m_polygon_cache)[0] = {{v[0], v[2], v[3]}};
-            (*m_polygon_cache)[1] = {{v[0], v[3], v[1]}};
-        }
-        // x = 1
-        if (ind[0].end() + ind[6].end() < ind[9].end() + ind[3].end()) {
-            (*m_polygon_cache)[2] = {{v[4], v[7], v[6]}};
-            (*m_polygon_cache)[3] = {{v[4], v[5], v[7]}};
-        }
-        // y = 0
-        if (ind[1].start() + ind[7].start() < ind[4].start() + ind[10].start()) {
-            (*m_polygon_cache)[4] = {{v[0], v[1], v[5]}};
-            (*m_polygon_cache)[5] = {{v[0], v[5], v[4]}};
-        }
-        // y = 1
-        if (ind[1].end() + ind[7].end() < ind[4].end() + ind[10].end()) {
-            (*m_polygon_cache)[6] = {{v[2], v[7], v[3]}};
-            (*m_polygon_cache)[7] = {{v[2], v[6], v[7]}};
-        }
-        // z = 0
-        if (ind[2].start() + ind[8].start() < ind[11].start() + ind[5].start()) {
-            (*m_polygon_cache)[8] = {{v[0], v[4], v[6]}};
-            (*m_polygon_cache)[9] = {{v[0], v[6], v[2]}};
-        }
-        // z = 1
-        if (ind[2].end() + ind[8].end() < ind[11].end() + ind[5].end()) {
-            (*m_polygon_cache)[10] = {{v[1], v[3], v[7]}};
-            (*m_polygon_cache)[11] = {{v[1], v[7], v[5]}};
-        }
-        m_polygon_cache_valid = true;
-        return;
+    auto polygons = std::make_shared<std::vector<Polygon>>();
+    polygons->reserve(Cube::EDGES);
+    for (const auto &triangle : triangle_corners(m_type, m_indentations)) {
+        polygons->push_back({{v[triangle[0]], v[triangle[1]], v[triangle[2]]}});
     }
-    // This point should not be reached.
-    assert(false);
+    m_polygon_cache = std::move(polygons);
+    m_polygon_cache_valid = true;
 }
 
 std::array<glm::vec3, 8> Cube::vertices() const noexcept {
     assert(m_type == Type::SOLID || m_type == Type::NORMAL);
+    return vertices(m_type, m_position, m_size, m_indentations);
+}
 
-    const glm::vec3 pos = m_position;
-    const glm::vec3 max = {m_position.x + m_size, m_position.y + m_size, m_position.z + m_size};
+std::array<glm::vec3, 8> Cube::vertices(const Type type, const glm::vec3 &position, const float size,
+                                        const std::array<Indentation, Cube::EDGES> &indentations) {
+    const glm::vec3 pos = position;
+    const glm::vec3 max = {position.x + size, position.y + size, position.z + size};
 
-    if (m_type == Type::SOLID) {
+    if (type == Type::SOLID) {
         return {{{pos.x, pos.y, pos.z},
                  {pos.x, pos.y, max.z},
                  {pos.x, max.y, pos.z},
@@ -515,9 +717,9 @@ std::array<glm::vec3, 8> Cube::vertices() const noexcept {
                  {max.x, max.y, pos.z},
                  {max.x, max.y, max.z}}};
     }
-    if (m_type == Type::NORMAL) {
-        const float step = m_size / Indentation::MAX;
-        const std::array<Indentation, Cube::EDGES> &ind = m_indentations;
+    if (type == Type::NORMAL) {
+        const float step = size / Indentation::MAX;
+        const std::array<Indentation, Cube::EDGES> &ind = indentations;
 
         return {{{pos.x + static_cast<float>(ind[0].start()) * step, pos.y + static_cast<float>(ind[1].start()) * step,
                   pos.z + static_cast<float>(ind[2].start()) * step},
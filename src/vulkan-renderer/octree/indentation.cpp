@@ -1,27 +1,27 @@
 #include "inexor/vulkan-renderer/octree/indentation.hpp"
 
 #include <algorithm>
-#include <array>
-#include <cassert>
-#include <cmath>
 
 namespace inexor::vulkan_renderer::octree {
-Indentation::Indentation(const std::uint8_t start, const std::uint8_t end) noexcept : m_start(start), m_end(end) {}
-
-Indentation::Indentation(const std::uint8_t uid) noexcept {
-    assert(uid <= 44);
-    constexpr std::array<std::uint8_t, Indentation::MAX> MASKS{44, 42, 39, 35, 30, 24, 17, 9};
-    for (std::uint8_t idx = 0; idx < Indentation::MAX; idx++) {
-        if (MASKS[idx] <= uid) {
-            m_start = Indentation::MAX - idx;
-            m_end = m_start + (uid - MASKS[idx]);
-            return;
+
+namespace {
+
+/// The uids are assigned in the order of start, then end. The remaining 6 bit values get the default indentation.
+constexpr std::array<Indentation, 64> create_uid_table() {
+    std::array<Indentation, 64> table{};
+    std::size_t uid = 0;
+    for (std::uint8_t start = 0; start <= Indentation::MAX; start++) {
+        for (std::uint8_t end = start; end <= Indentation::MAX; end++) {
+            table[uid++] = {start, end};
         }
     }
-    m_start = 0;
-    m_end = uid;
+    return table;
 }
 
+} // namespace
+
+constinit const std::array<Indentation, 64> Indentation::UID_TABLE = create_uid_table();
+
 bool Indentation::operator==(const Indentation &rhs) const {
     return this->m_start == rhs.m_start && this->m_end == rhs.m_end;
 }
@@ -73,8 +73,4 @@ std::uint8_t Indentation::start() const noexcept {
 std::uint8_t Indentation::start_abs() const noexcept {
     return this->m_start;
 }
-
-std::uint8_t Indentation::uid() const {
-    return static_cast<std::uint8_t>(10 * m_start + offset() - (std::pow(m_start, 2) + m_start) / 2);
-}
 } // namespace inexor::vulkan_renderer::octree
@@ -0,0 +1,135 @@
+#include "inexor/vulkan-renderer/octree/indexed_mesh_builder.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace inexor::vulkan_renderer::octree {
+
+namespace {
+
+/// The smallest size of the hash table.
+constexpr std::size_t MIN_TABLE_SIZE{64};
+
+/// The bit pattern of a float, -0.0 is mapped to 0.0.
+std::uint32_t float_bits(const float value) {
+    return std::bit_cast<std::uint32_t>(value + 0.0f);
+}
+
+std::size_t hash_position(const glm::vec3 &position) {
+    // The coordinates of octree vertices often only differ in the upper bits of the mantissa, so all bits are mixed
+    // with the finalizer of MurmurHash3 before the lower bits are used as slot.
+    std::uint64_t hash = (static_cast<std::uint64_t>(float_bits(position.x)) << 32u) | float_bits(position.y);
+    hash ^= static_cast<std::uint64_t>(float_bits(position.z)) * 0x9E3779B97F4A7C15ull;
+    hash ^= hash >> 33u;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33u;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33u;
+    return static_cast<std::size_t>(hash);
+}
+
+bool equal_positions(const glm::vec3 &lhs, const glm::vec3 &rhs) {
+    return float_bits(lhs.x) == float_bits(rhs.x) && float_bits(lhs.y) == float_bits(rhs.y) &&
+           float_bits(lhs.z) == float_bits(rhs.z);
+}
+
+} // namespace
+
+IndexedMeshBuilder::IndexedMeshBuilder(const std::size_t expected_vertices) {
+    // Keep the load factor below 0.5.
+    m_table.resize(std::bit_ceil(std::max(MIN_TABLE_SIZE, 2 * expected_vertices)), INVALID_INDEX);
+    m_mesh.vertices.reserve(expected_vertices);
+}
+
+void IndexedMeshBuilder::add_box_triangles(const std::array<glm::vec3, 8> &corners,
+                                           const std::span<const std::array<std::uint8_t, 3>> triangles) {
+    std::array<std::uint32_t, 8> corner_indices;
+    corner_indices.fill(INVALID_INDEX);
+    for (const auto &triangle : triangles) {
+        for (const auto corner : triangle) {
+            if (corner_indices[corner] == INVALID_INDEX) {
+                corner_indices[corner] = add_vertex(corners[corner]);
+            }
+            m_mesh.indices.push_back(corner_indices[corner]);
+        }
+    }
+}
+
+void IndexedMeshBuilder::add_cube(const Cube &cube) {
+    switch (cube.type()) {
+    case Cube::Type::EMPTY:
+        return;
+    case Cube::Type::OCTANT:
+        for (const auto &child : cube.children()) {
+            add_cube(*child);
+        }
+        return;
+    case Cube::Type::SOLID:
+    case Cube::Type::NORMAL:
+        const auto indentations = cube.indentations();
+        const auto triangles = Cube::triangle_corners(cube.type(), indentations);
+        add_box_triangles(Cube::vertices(cube.type(), cube.position(), cube.size(), indentations), triangles);
+        return;
+    }
+}
+
+void IndexedMeshBuilder::add_mesh(const IndexedMesh &mesh) {
+    // The vertices of a mesh are in the order of their first use, so adding them in order keeps the order of the
+    // vertices which are new to this builder.
+    std::vector<std::uint32_t> vertex_indices(mesh.vertices.size());
+    for (std::size_t idx = 0; idx < mesh.vertices.size(); idx++) {
+        vertex_indices[idx] = add_vertex(mesh.vertices[idx]);
+    }
+    m_mesh.indices.reserve(m_mesh.indices.size() + mesh.indices.size());
+    for (const auto index : mesh.indices) {
+        m_mesh.indices.push_back(vertex_indices[index]);
+    }
+}
+
+void IndexedMeshBuilder::add_triangle(const Polygon &polygon) {
+    for (const auto &vertex : polygon) {
+        m_mesh.indices.push_back(add_vertex(vertex));
+    }
+}
+
+std::uint32_t IndexedMeshBuilder::add_vertex(const glm::vec3 &position) {
+    const std::size_t mask = m_table.size() - 1;
+    for (std::size_t slot = hash_position(position) & mask;; slot = (slot + 1) & mask) {
+        const std::uint32_t index = m_table[slot];
+        if (index == INVALID_INDEX) {
+            assert(m_mesh.vertices.size() < INVALID_INDEX && "Mesh too big!");
+            const auto new_index = static_cast<std::uint32_t>(m_mesh.vertices.size());
+            m_mesh.vertices.push_back(position);
+            m_table[slot] = new_index;
+            if (2 * m_mesh.vertices.size() > m_table.size()) {
+                grow_table();
+            }
+            return new_index;
+        }
+        if (equal_positions(m_mesh.vertices[index], position)) {
+            return index;
+        }
+    }
+}
+
+IndexedMesh IndexedMeshBuilder::build() {
+    IndexedMesh mesh = std::move(m_mesh);
+    m_mesh = {};
+    std::fill(m_table.begin(), m_table.end(), INVALID_INDEX);
+    return mesh;
+}
+
+void IndexedMeshBuilder::grow_table() {
+    m_table.assign(2 * m_table.size(), INVALID_INDEX);
+    const std::size_t mask = m_table.size() - 1;
+    for (std::uint32_t index = 0; index < m_mesh.vertices.size(); index++) {
+        std::size_t slot = hash_position(m_mesh.vertices[index]) & mask;
+        while (m_table[slot] != INVALID_INDEX) {
+            slot = (slot + 1) & mask;
+        }
+        m_table[slot] = index;
+    }
+}
+
+} // namespace inexor::vulkan_renderer::octree
@@ -0,0 +1,87 @@
+#include "inexor/vulkan-renderer/octree/memory_statistics.hpp"
+
+#include "inexor/vulkan-renderer/tools/allocators/arena_allocator.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace inexor::vulkan_renderer::octree {
+
+namespace {
+
+/// The control block which std::make_shared places in front of the object: a pointer to its virtual table and the use
+/// and weak counts. This is the layout of libstdc++, other standard libraries differ (libc++ uses long counts), so the
+/// result is an estimate there. The cubes of a clone are not allocated this way, their arena is counted instead.
+constexpr std::size_t CONTROL_BLOCK_BYTES{sizeof(void *) + 2 * sizeof(int)};
+
+} // namespace
+
+std::size_t MemoryStatistics::cubes() const noexcept {
+    return std::accumulate(cubes_per_type.begin(), cubes_per_type.end(), std::size_t{0});
+}
+
+MemoryStatistics &MemoryStatistics::operator+=(const MemoryStatistics &rhs) {
+    for (std::size_t type = 0; type < CUBE_TYPE_COUNT; type++) {
+        cubes_per_type[type] += rhs.cubes_per_type[type];
+    }
+    cubes_per_level.resize(std::max(cubes_per_level.size(), rhs.cubes_per_level.size()));
+    for (std::size_t level = 0; level < rhs.cubes_per_level.size(); level++) {
+        for (std::size_t type = 0; type < CUBE_TYPE_COUNT; type++) {
+            cubes_per_level[level][type] += rhs.cubes_per_level[level][type];
+        }
+    }
+    node_bytes += rhs.node_bytes;
+    indentation_bytes += rhs.indentation_bytes;
+    unused_indentation_bytes += rhs.unused_indentation_bytes;
+    polygon_caches += rhs.polygon_caches;
+    polygon_cache_bytes += rhs.polygon_cache_bytes;
+    invalid_polygon_caches += rhs.invalid_polygon_caches;
+    return *this;
+}
+
+MemoryStatistics collect_memory_statistics(const Cube &cube) {
+    constexpr std::size_t INDENTATION_BYTES{sizeof(Cube::m_indentations)};
+    MemoryStatistics statistics;
+    // The stack holds at most 7 siblings per level, so it stays small even for huge worlds.
+    std::vector<std::pair<const Cube *, std::size_t>> stack{{&cube, 0}};
+    while (!stack.empty()) {
+        const auto [current, level] = stack.back();
+        stack.pop_back();
+        const auto type = static_cast<std::size_t>(current->m_type);
+        if (statistics.cubes_per_level.size() <= level) {
+            statistics.cubes_per_level.resize(level + 1);
+        }
+        statistics.cubes_per_level[level][type]++;
+        statistics.cubes_per_type[type]++;
+        if (current->m_arena == nullptr) {
+            statistics.node_bytes += CONTROL_BLOCK_BYTES + sizeof(Cube);
+        } else if (current == &cube || current->m_parent->m_arena != current->m_arena) {
+            // The whole block of the arena is counted once by the topmost cube which has been allocated in it, as it
+            // stays allocated until the last of its cubes has been destroyed.
+            statistics.node_bytes += current->m_arena->memory_usage();
+        }
+        statistics.indentation_bytes += INDENTATION_BYTES;
+
+        if (current->m_type != Cube::Type::NORMAL) {
+            statistics.unused_indentation_bytes += INDENTATION_BYTES;
+        }
+        if (current->m_polygon_cache) {
+            statistics.polygon_caches++;
+            statistics.polygon_cache_bytes += CONTROL_BLOCK_BYTES + sizeof(std::vector<Polygon>) +
+                                              current->m_polygon_cache->capacity() * sizeof(Polygon);
+        }
+        if ((current->m_type == Cube::Type::SOLID || current->m_type == Cube::Type::NORMAL) &&
+            !current->m_polygon_cache_valid) {
+            statistics.invalid_polygon_caches++;
+        }
+        if (current->m_type == Cube::Type::OCTANT) {
+            for (const auto &child : current->m_children) {
+                stack.emplace_back(child.get(), level + 1);
+            }
+        }
+    }
+    return statistics;
+}
+
+} // namespace inexor::vulkan_renderer::octree
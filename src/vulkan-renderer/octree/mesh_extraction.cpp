@@ -0,0 +1,371 @@
+#include "inexor/vulkan-renderer/octree/mesh_extraction.hpp"
+
+#include "inexor/vulkan-renderer/octree/indexed_mesh_builder.hpp"
+#include "inexor/vulkan-renderer/tools/parallel.hpp"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace inexor::vulkan_renderer::octree {
+
+namespace {
+
+/// The sides of a cube in the order of the triangles of Cube::triangle_corners: x = 0, x = 1, y = 0, y = 1, ...
+constexpr std::size_t FACES{6};
+
+/// The neighbors of a cube for every face, nullptr if there is none.
+using Neighbors = std::array<const Cube *, FACES>;
+
+/// The bit of the child index which corresponds to the axis of a face.
+constexpr std::uint8_t axis_bit(const std::size_t face) {
+    return static_cast<std::uint8_t>(1u << (2 - face / 2));
+}
+
+/// Is the face on the positive side of its axis.
+constexpr bool is_positive_side(const std::size_t face) {
+    return face % 2 == 1;
+}
+
+/// Get the neighbors of a child from the neighbors of its parent.
+Neighbors child_neighbors(const Cube &parent, const Neighbors &parent_neighbors, const std::size_t idx) {
+    Neighbors neighbors{};
+    for (std::size_t face = 0; face < FACES; face++) {
+        const std::uint8_t bit = axis_bit(face);
+        const auto mirrored_idx = idx ^ bit;
+        if (((idx & bit) != 0) != is_positive_side(face)) {
+            // The neighbor is a sibling.
+            neighbors[face] = parent.children()[mirrored_idx].get();
+            continue;
+        }
+        const Cube *parent_neighbor = parent_neighbors[face];
+        if (parent_neighbor != nullptr && parent_neighbor->type() == Cube::Type::OCTANT) {
+            neighbors[face] = parent_neighbor->children()[mirrored_idx].get();
+        } else {
+            // The neighbor of the parent is larger, but still a neighbor.
+            neighbors[face] = parent_neighbor;
+        }
+    }
+    return neighbors;
+}
+
+/// Does the face of the cube lie completely on the side of the cube.
+bool is_face_on_side(const std::array<glm::vec3, 8> &vertices, const Cube &cube, const std::size_t face) {
+    const std::size_t axis = face / 2;
+    const float plane = cube.position()[axis] + (is_positive_side(face) ? cube.size() : 0.0f);
+    const std::uint8_t bit = axis_bit(face);
+    for (std::uint8_t corner = 0; corner < vertices.size(); corner++) {
+        if (((corner & bit) != 0) == is_positive_side(face) && vertices[corner][axis] != plane) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Faces which can be merged have the same side, lie in the same plane and belong to cubes of the same size.
+struct FaceGroupKey {
+    std::size_t face;
+    float plane;
+    float size;
+
+    auto operator<=>(const FaceGroupKey &) const = default;
+};
+
+/// The position of a face in its plane in multiples of the cube size, relative to the extracted cube.
+using FaceCell = std::array<std::int32_t, 2>;
+
+/// The two axes which span the plane of a face.
+constexpr std::array<std::size_t, 2> plane_axes(const std::size_t face) {
+    switch (face / 2) {
+    case 0:
+        return {1, 2};
+    case 1:
+        return {0, 2};
+    default:
+        return {0, 1};
+    }
+}
+
+/// The part of the volume of a cube which is filled with geometry.
+float fill_ratio(const Cube &cube) {
+    switch (cube.type()) {
+    case Cube::Type::EMPTY:
+        return 0.0f;
+    case Cube::Type::SOLID:
+        return 1.0f;
+    case Cube::Type::NORMAL: {
+        // The volume of a closed triangle mesh is the sum of the signed volumes of the tetrahedra spanned by its
+        // triangles and the origin. The triangles of cubes face inwards, which flips the sign.
+        const auto indentations = cube.indentations();
+        const auto vertices = Cube::vertices(Cube::Type::NORMAL, {0.0f, 0.0f, 0.0f}, 1.0f, indentations);
+        float volume = 0.0f;
+        for (const auto &triangle : Cube::triangle_corners(Cube::Type::NORMAL, indentations)) {
+            volume -= glm::dot(vertices[triangle[0]], glm::cross(vertices[triangle[1]], vertices[triangle[2]]));
+        }
+        return volume / 6.0f;
+    }
+    case Cube::Type::OCTANT:
+        break;
+    }
+    float ratio = 0.0f;
+    for (const auto &child : cube.children()) {
+        ratio += fill_ratio(*child);
+    }
+    return ratio / static_cast<float>(Cube::SUB_CUBES);
+}
+
+struct ExtractionContext {
+    const MeshExtractionSettings &settings;
+    MeshStatistics &statistics;
+    /// Either the triangles are written into polygons or into the builder.
+    std::vector<Polygon> *polygons;
+    IndexedMeshBuilder *builder;
+    glm::vec3 origin;
+    std::map<FaceGroupKey, std::vector<FaceCell>> face_groups;
+    /// Whether the octants on the maximum depth which have been collapsed so far became a solid cube, as octants on
+    /// the maximum depth are also needed as neighbors.
+    std::unordered_map<const Cube *, bool> collapsed_octants;
+
+    /// Does an octant on the maximum depth become a solid cube when it is collapsed.
+    bool collapses_to_solid(const Cube &octant) {
+        const auto [collapsed, inserted] = collapsed_octants.try_emplace(&octant, false);
+        if (inserted) {
+            collapsed->second = fill_ratio(octant) >= settings.solid_fill_ratio;
+        }
+        return collapsed->second;
+    }
+
+    /// Emit triangles which are given as indices into the corners of a box.
+    void emit(const std::array<glm::vec3, 8> &corners, const std::span<const std::array<std::uint8_t, 3>> triangles) {
+        if (builder != nullptr) {
+            builder->add_box_triangles(corners, triangles);
+            return;
+        }
+        for (const auto &triangle : triangles) {
+            polygons->push_back({{corners[triangle[0]], corners[triangle[1]], corners[triangle[2]]}});
+        }
+    }
+};
+
+/// Emit the two triangles of a rectangle on the side of an axis aligned box.
+/// The triangles of a solid cube are reused, so the winding order is the same as for unmerged faces.
+void emit_rectangle(const std::size_t face, const glm::vec3 &min, const glm::vec3 &max, ExtractionContext &context) {
+    std::array<glm::vec3, 8> vertices{};
+    for (std::uint8_t corner = 0; corner < vertices.size(); corner++) {
+        vertices[corner] = {(corner & 4u) != 0 ? max.x : min.x, (corner & 2u) != 0 ? max.y : min.y,
+                            (corner & 1u) != 0 ? max.z : min.z};
+    }
+    static const auto SOLID_TRIANGLES = Cube::triangle_corners(Cube::Type::SOLID, {});
+    context.emit(vertices, std::span(SOLID_TRIANGLES).subspan(2 * face, 2));
+}
+
+/// Greedily merge the faces of one group into as few rectangles as possible.
+void merge_faces(const FaceGroupKey &key, std::vector<FaceCell> &cells, ExtractionContext &context) {
+    // Sort row by row, so every rectangle starts at its first cell.
+    std::sort(cells.begin(), cells.end(), [](const FaceCell &lhs, const FaceCell &rhs) {
+        return lhs[1] < rhs[1] || (lhs[1] == rhs[1] && lhs[0] < rhs[0]);
+    });
+    auto pack = [](const std::int32_t u, const std::int32_t v) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(u)) << 32u) | static_cast<std::uint32_t>(v);
+    };
+    std::unordered_set<std::uint64_t> remaining;
+    remaining.reserve(cells.size());
+    for (const auto &cell : cells) {
+        remaining.insert(pack(cell[0], cell[1]));
+    }
+    const auto [u_axis, v_axis] = plane_axes(key.face);
+    const std::size_t axis = key.face / 2;
+
+    std::size_t rectangles = 0;
+    for (const auto &cell : cells) {
+        if (!remaining.contains(pack(cell[0], cell[1]))) {
+            continue;
+        }
+        // Grow the rectangle along the first axis as long as possible, then add rows of the same width.
+        std::int32_t width = 1;
+        while (remaining.contains(pack(cell[0] + width, cell[1]))) {
+            width++;
+        }
+        std::int32_t height = 1;
+        auto is_row_complete = [&](const std::int32_t row) {
+            for (std::int32_t column = 0; column < width; column++) {
+                if (!remaining.contains(pack(cell[0] + column, row))) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        while (is_row_complete(cell[1] + height)) {
+            height++;
+        }
+        for (std::int32_t row = 0; row < height; row++) {
+            for (std::int32_t column = 0; column < width; column++) {
+                remaining.erase(pack(cell[0] + column, cell[1] + row));
+            }
+        }
+
+        glm::vec3 min{};
+        glm::vec3 max{};
+        min[axis] = max[axis] = key.plane;
+        min[u_axis] = context.origin[u_axis] + static_cast<float>(cell[0]) * key.size;
+        max[u_axis] = context.origin[u_axis] + static_cast<float>(cell[0] + width) * key.size;
+        min[v_axis] = context.origin[v_axis] + static_cast<float>(cell[1]) * key.size;
+        max[v_axis] = context.origin[v_axis] + static_cast<float>(cell[1] + height) * key.size;
+        emit_rectangle(key.face, min, max, context);
+        rectangles++;
+    }
+    context.statistics.emitted_triangles += 2 * rectangles;
+    context.statistics.merged_triangles += 2 * (cells.size() - rectangles);
+}
+
+/// @param depth The level of the cube below the extracted cube
+void extract(const Cube &cube, const Neighbors &neighbors, const std::size_t depth, ExtractionContext &context) {
+    const bool max_depth_reached = context.settings.max_depth && depth >= *context.settings.max_depth;
+    Cube::Type type = cube.type();
+    if (type == Cube::Type::OCTANT && max_depth_reached) {
+        type = context.collapses_to_solid(cube) ? Cube::Type::SOLID : Cube::Type::EMPTY;
+        context.statistics.collapsed_octants++;
+    }
+    switch (type) {
+    case Cube::Type::EMPTY:
+        return;
+    case Cube::Type::OCTANT:
+        for (std::size_t idx = 0; idx < Cube::SUB_CUBES; idx++) {
+            extract(*cube.children()[idx], child_neighbors(cube, neighbors, idx), depth + 1, context);
+        }
+        return;
+    case Cube::Type::SOLID:
+    case Cube::Type::NORMAL:
+        break;
+    }
+    // Neighbors are never smaller than the cube, so a neighbor which is an octant is on the same level.
+    auto is_solid = [&](const Cube *neighbor) {
+        return neighbor != nullptr &&
+               (neighbor->type() == Cube::Type::SOLID ||
+                (neighbor->type() == Cube::Type::OCTANT && max_depth_reached && context.collapses_to_solid(*neighbor)));
+    };
+    MeshStatistics &statistics = context.statistics;
+    statistics.geometry_cubes++;
+    const auto indentations = cube.indentations();
+    const auto vertices = Cube::vertices(type, cube.position(), cube.size(), indentations);
+    const auto triangles = Cube::triangle_corners(type, indentations);
+
+    // Collect the visible triangles first, so the corners are only looked up once if an indexed mesh is built.
+    std::array<std::array<std::uint8_t, 3>, Cube::EDGES> visible_triangles{};
+    std::size_t visible_count = 0;
+    for (std::size_t face = 0; face < FACES; face++) {
+        const Cube *neighbor = neighbors[face];
+        if (context.settings.cull_hidden_faces && is_solid(neighbor) && is_face_on_side(vertices, cube, face)) {
+            statistics.culled_triangles += 2;
+            continue;
+        }
+        if (context.settings.merge_coplanar_faces && type == Cube::Type::SOLID) {
+            const std::size_t axis = face / 2;
+            const auto [u_axis, v_axis] = plane_axes(face);
+            const glm::vec3 cell = (cube.position() - context.origin) / cube.size();
+            context.face_groups[{face, vertices[is_positive_side(face) ? 7 : 0][axis], cube.size()}].push_back(
+                {static_cast<std::int32_t>(std::lround(cell[u_axis])),
+                 static_cast<std::int32_t>(std::lround(cell[v_axis]))});
+            continue;
+        }
+        visible_triangles[visible_count++] = triangles[2 * face];
+        visible_triangles[visible_count++] = triangles[2 * face + 1];
+    }
+    statistics.emitted_triangles += visible_count;
+    context.emit(vertices, std::span(visible_triangles).first(visible_count));
+}
+
+/// A subtree which is extracted on its own.
+struct Subtree {
+    const Cube *cube;
+    Neighbors neighbors;
+    std::size_t depth;
+};
+
+/// Split the tree into subtrees at the split depth, in the order in which extract visits them.
+void split(const Cube &cube, const Neighbors &neighbors, const std::size_t depth,
+           const MeshExtractionSettings &settings, std::vector<Subtree> &subtrees) {
+    const bool max_depth_reached = settings.max_depth && depth >= *settings.max_depth;
+    if (cube.type() != Cube::Type::OCTANT || max_depth_reached || depth == settings.split_depth) {
+        subtrees.push_back({&cube, neighbors, depth});
+        return;
+    }
+    for (std::size_t idx = 0; idx < Cube::SUB_CUBES; idx++) {
+        split(*cube.children()[idx], child_neighbors(cube, neighbors, idx), depth + 1, settings, subtrees);
+    }
+}
+
+/// Extract the subtrees on multiple threads into meshes of their own and append them in traversal order, which gives
+/// the same result as extracting the whole tree at once.
+void extract_parallel(const Cube &cube, ExtractionContext &context) {
+    std::vector<Subtree> subtrees;
+    split(cube, {}, 0, context.settings, subtrees);
+
+    std::vector<MeshStatistics> statistics(subtrees.size());
+    std::vector<std::vector<Polygon>> polygons(context.polygons != nullptr ? subtrees.size() : 0);
+    std::vector<IndexedMeshBuilder> builders(context.builder != nullptr ? subtrees.size() : 0);
+    std::vector<std::map<FaceGroupKey, std::vector<FaceCell>>> face_groups(subtrees.size());
+    tools::parallel_for(
+        subtrees.size(),
+        [&](const std::size_t idx) {
+            ExtractionContext subtree_context{context.settings,
+                                              statistics[idx],
+                                              context.polygons != nullptr ? &polygons[idx] : nullptr,
+                                              context.builder != nullptr ? &builders[idx] : nullptr,
+                                              context.origin,
+                                              {},
+                                              {}};
+            extract(*subtrees[idx].cube, subtrees[idx].neighbors, subtrees[idx].depth, subtree_context);
+            face_groups[idx] = std::move(subtree_context.face_groups);
+        },
+        context.settings.thread_count);
+
+    for (std::size_t idx = 0; idx < subtrees.size(); idx++) {
+        context.statistics += statistics[idx];
+        if (context.polygons != nullptr) {
+            context.polygons->insert(context.polygons->end(), polygons[idx].begin(), polygons[idx].end());
+        } else {
+            context.builder->add_mesh(builders[idx].mesh());
+        }
+        for (auto &[key, cells] : face_groups[idx]) {
+            auto &group = context.face_groups[key];
+            group.insert(group.end(), cells.begin(), cells.end());
+        }
+    }
+}
+
+void extract_root(const Cube &cube, ExtractionContext &context) {
+    if (context.settings.thread_count == 1) {
+        extract(cube, {}, 0, context);
+    } else {
+        extract_parallel(cube, context);
+    }
+    for (auto &[key, cells] : context.face_groups) {
+        merge_faces(key, cells, context);
+    }
+}
+
+} // namespace
+
+OctreeMesh extract_mesh(const Cube &cube, const MeshExtractionSettings &settings) {
+    OctreeMesh mesh;
+    ExtractionContext context{settings, mesh.statistics, &mesh.polygons, nullptr, cube.position(), {}, {}};
+    extract_root(cube, context);
+    return mesh;
+}
+
+MeshStatistics extract_mesh(const Cube &cube, IndexedMeshBuilder &builder, const MeshExtractionSettings &settings) {
+    MeshStatistics statistics;
+    ExtractionContext context{settings, statistics, nullptr, &builder, cube.position(), {}, {}};
+    extract_root(cube, context);
+    return statistics;
+}
+
+} // namespace inexor::vulkan_renderer::octree
@@ -0,0 +1,565 @@
+#include "inexor/vulkan-renderer/octree/ray_query.hpp"
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+#include "inexor/vulkan-renderer/octree/cube_triangles.hpp"
+#include "inexor/vulkan-renderer/tools/parallel.hpp"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace inexor::vulkan_renderer::octree {
+
+namespace {
+
+using detail::AXIS_BITS;
+
+/// Direction components which are smaller than this are replaced by it. This keeps the ray parameters of rays which
+/// are parallel to a plane finite, so a ray on the plane of a cube does not produce NaN.
+constexpr float MIN_DIRECTION{1e-20f};
+
+/// The state of one cast which does not change during the traversal.
+struct Traversal {
+    /// The axis bits of the directions which have been mirrored to make all direction components positive.
+    std::uint8_t mirror_mask;
+    /// The origin before mirroring, which is used for the triangles of Type::NORMAL cubes.
+    glm::vec3 origin;
+    /// The direction before mirroring, which is used for the hit normal and the triangles of Type::NORMAL cubes.
+    glm::vec3 direction;
+    float max_distance;
+    std::optional<std::uint32_t> max_depth;
+};
+
+/// The nodes of a Cube octree.
+struct CubeNodes {
+    using Node = const Cube *;
+
+    [[nodiscard]] static Cube::Type type(const Node node) {
+        return node->type();
+    }
+
+    [[nodiscard]] static Node child(const Node node, const std::size_t idx) {
+        return node->children()[idx].get();
+    }
+
+    [[nodiscard]] static std::array<glm::vec3, 8> vertices(const Node node) {
+        return Cube::vertices(node->type(), node->position(), node->size(), node->indentations());
+    }
+
+    [[nodiscard]] static std::array<Indentation, Cube::EDGES> indentations(const Node node) {
+        return node->indentations();
+    }
+
+    static void set_hit(RayHit &hit, const Node node) {
+        hit.cube = node;
+    }
+};
+
+/// The nodes of a CompactOctree.
+struct CompactNodes {
+    using Node = CompactOctree::NodeIndex;
+    const CompactOctree &octree;
+
+    [[nodiscard]] Cube::Type type(const Node node) const {
+        return octree.type(node);
+    }
+
+    [[nodiscard]] Node child(const Node node, const std::size_t idx) const {
+        return octree.child(node, idx);
+    }
+
+    [[nodiscard]] std::array<glm::vec3, 8> vertices(const Node node) const {
+        const auto bounding_box = octree.bounding_box(node);
+        return Cube::vertices(octree.type(node), bounding_box[0], bounding_box[1].x - bounding_box[0].x,
+                              octree.indentations(node));
+    }
+
+    [[nodiscard]] const std::array<Indentation, Cube::EDGES> &indentations(const Node node) const {
+        return octree.indentations(node);
+    }
+
+    static void set_hit(RayHit &hit, const Node node) {
+        hit.node = node;
+    }
+};
+
+/// The first child which is entered by the ray.
+/// @param t0 The ray parameters at which the ray crosses the lower planes of the octant
+/// @param tm The ray parameters at which the ray crosses the center planes of the octant
+std::uint8_t first_child(const glm::vec3 &t0, const glm::vec3 &tm) {
+    // The plane through which the ray enters is the one which is crossed last. The center planes on the other axes
+    // which are crossed before tell on which side of them the ray enters.
+    int entry_axis = 0;
+    for (int axis = 1; axis < 3; axis++) {
+        if (t0[axis] > t0[entry_axis]) {
+            entry_axis = axis;
+        }
+    }
+    std::uint8_t child = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        if (axis != entry_axis && tm[axis] < t0[entry_axis]) {
+            child |= AXIS_BITS[axis];
+        }
+    }
+    return child;
+}
+
+/// The child which is entered after leaving a child, or Cube::SUB_CUBES if the ray leaves the octant.
+/// @param child The child the ray leaves
+/// @param t1 The ray parameters at which the ray crosses the upper planes of the child
+std::uint8_t next_child(const std::uint8_t child, const glm::vec3 &t1) {
+    int exit_axis = 0;
+    for (int axis = 1; axis < 3; axis++) {
+        if (t1[axis] < t1[exit_axis]) {
+            exit_axis = axis;
+        }
+    }
+    if ((child & AXIS_BITS[exit_axis]) != 0) {
+        return Cube::SUB_CUBES;
+    }
+    return child | AXIS_BITS[exit_axis];
+}
+
+/// The 12 triangles of a Type::NORMAL cube in structure of arrays layout, so a ray is tested against all of them with
+/// the same instructions.
+struct CubeTriangles {
+    using Lanes = std::array<float, Cube::EDGES>;
+
+    std::array<Lanes, 3> corner;
+    std::array<Lanes, 3> edge1;
+    std::array<Lanes, 3> edge2;
+
+    /// The triangles of a Type::NORMAL node, see detail::for_each_normal_cube_triangle.
+    template <typename Nodes>
+    CubeTriangles(const Nodes &nodes, const typename Nodes::Node node) {
+        detail::for_each_normal_cube_triangle(
+            nodes.vertices(node), nodes.indentations(node),
+            [&](const std::size_t triangle, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+                for (int axis = 0; axis < 3; axis++) {
+                    corner[axis][triangle] = a[axis];
+                    edge1[axis][triangle] = b[axis] - a[axis];
+                    edge2[axis][triangle] = c[axis] - a[axis];
+                }
+            });
+    }
+
+    /// Intersect a ray with all triangles, both sides of the triangles are hit.
+    /// This is the algorithm by Möller and Trumbore, written as one fixed length loop without branches, so the
+    /// compiler turns it into vector instructions.
+    /// @param origin The start of the ray
+    /// @param direction The direction of the ray
+    /// @param max_distance Triangles which are hit after origin + max_distance * direction are not hit
+    /// @return The ray parameter of the nearest hit and the normal of the triangle facing the ray
+    [[nodiscard]] std::optional<std::pair<float, glm::vec3>> intersect(const glm::vec3 &origin, const glm::vec3 &direction,
+                                                                       const float max_distance) const {
+        Lanes t;
+        for (std::size_t lane = 0; lane < Cube::EDGES; lane++) {
+            // p = direction x edge2
+            const float px = direction.y * edge2[2][lane] - direction.z * edge2[1][lane];
+            const float py = direction.z * edge2[0][lane] - direction.x * edge2[2][lane];
+            const float pz = direction.x * edge2[1][lane] - direction.y * edge2[0][lane];
+            const float determinant = edge1[0][lane] * px + edge1[1][lane] * py + edge1[2][lane] * pz;
+            // The determinant is 0 for degenerated triangles of fully indented edges and for parallel rays. These lanes
+            // are masked out below, dividing by 0 is not guarded against, as a branch would prevent vectorization.
+            const float inverse_determinant = 1.0f / determinant;
+            const float sx = origin.x - corner[0][lane];
+            const float sy = origin.y - corner[1][lane];
+            const float sz = origin.z - corner[2][lane];
+            const float u = (sx * px + sy * py + sz * pz) * inverse_determinant;
+            // q = s x edge1
+            const float qx = sy * edge1[2][lane] - sz * edge1[1][lane];
+            const float qy = sz * edge1[0][lane] - sx * edge1[2][lane];
+            const float qz = sx * edge1[1][lane] - sy * edge1[0][lane];
+            const float v = (direction.x * qx + direction.y * qy + direction.z * qz) * inverse_determinant;
+            const float hit_t = (edge2[0][lane] * qx + edge2[1][lane] * qy + edge2[2][lane] * qz) * inverse_determinant;
+            const bool hit = (determinant != 0.0f) & (u >= 0.0f) & (v >= 0.0f) & (u + v <= 1.0f) & (hit_t >= 0.0f) &
+                             (hit_t <= max_distance);
+            t[lane] = hit ? hit_t : std::numeric_limits<float>::infinity();
+        }
+        const auto nearest = static_cast<std::size_t>(std::min_element(t.begin(), t.end()) - t.begin());
+        if (t[nearest] == std::numeric_limits<float>::infinity()) {
+            return std::nullopt;
+        }
+        const glm::vec3 edge1_nearest{edge1[0][nearest], edge1[1][nearest], edge1[2][nearest]};
+        const glm::vec3 edge2_nearest{edge2[0][nearest], edge2[1][nearest], edge2[2][nearest]};
+        glm::vec3 normal = glm::normalize(glm::cross(edge1_nearest, edge2_nearest));
+        if (glm::dot(normal, direction) > 0.0f) {
+            normal = -normal;
+        }
+        return std::make_pair(t[nearest], normal);
+    }
+};
+
+/// Intersect a ray with the triangles of a Type::NORMAL cube.
+/// @param triangles The triangles of the cube
+/// @param node The cube
+/// @param level The octree level of the cube
+/// @param traversal The ray
+template <typename Nodes>
+std::optional<RayHit> normal_cube_hit(const CubeTriangles &triangles, const typename Nodes::Node node,
+                                      const std::uint32_t level, const Traversal &traversal) {
+    const auto triangle_hit = triangles.intersect(traversal.origin, traversal.direction, traversal.max_distance);
+    if (!triangle_hit) {
+        return std::nullopt;
+    }
+    RayHit hit;
+    Nodes::set_hit(hit, node);
+    hit.t = triangle_hit->first;
+    hit.normal = triangle_hit->second;
+    hit.level = level;
+    return hit;
+}
+
+template <typename Nodes>
+std::optional<RayHit> traverse(const Nodes &nodes, const typename Nodes::Node node, const glm::vec3 &t0,
+                               const glm::vec3 &t1, const std::uint32_t level, const Traversal &traversal) {
+    const float t_enter = std::max({t0.x, t0.y, t0.z});
+    const float t_exit = std::min({t1.x, t1.y, t1.z});
+    if (t_exit < 0.0f || t_enter > t_exit || t_enter > traversal.max_distance) {
+        return std::nullopt;
+    }
+
+    const bool max_depth_reached = traversal.max_depth && level >= *traversal.max_depth;
+    const Cube::Type type = nodes.type(node);
+    if (type == Cube::Type::SOLID || (type == Cube::Type::OCTANT && max_depth_reached)) {
+        RayHit hit;
+        Nodes::set_hit(hit, node);
+        hit.t = std::max(t_enter, 0.0f);
+        hit.level = level;
+        if (t_enter >= 0.0f) {
+            int entry_axis = 0;
+            for (int axis = 1; axis < 3; axis++) {
+                if (t0[axis] > t0[entry_axis]) {
+                    entry_axis = axis;
+                }
+            }
+            hit.normal[entry_axis] = traversal.direction[entry_axis] < 0.0f ? 1.0f : -1.0f;
+        }
+        return hit;
+    }
+    if (type == Cube::Type::NORMAL) {
+        // The ray passes through the bounding box of the cube, which is the pre-test for its triangles.
+        return normal_cube_hit<Nodes>(CubeTriangles(nodes, node), node, level, traversal);
+    }
+    if (type != Cube::Type::OCTANT) {
+        return std::nullopt;
+    }
+
+    const glm::vec3 tm = 0.5f * (t0 + t1);
+    std::uint8_t child = first_child(t0, tm);
+    while (child < Cube::SUB_CUBES) {
+        glm::vec3 child_t0;
+        glm::vec3 child_t1;
+        for (int axis = 0; axis < 3; axis++) {
+            const bool upper_half = (child & AXIS_BITS[axis]) != 0;
+            child_t0[axis] = upper_half ? tm[axis] : t0[axis];
+            child_t1[axis] = upper_half ? t1[axis] : tm[axis];
+        }
+        if (auto hit = traverse(nodes, nodes.child(node, child ^ traversal.mirror_mask), child_t0, child_t1,
+                                level + 1, traversal)) {
+            return hit;
+        }
+        child = next_child(child, child_t1);
+    }
+    return std::nullopt;
+}
+
+/// The rays of a packet, whose directions have the same signs. The ray parameters of every axis are stored next to
+/// each other, so the lanes of a packet are processed with the same instructions.
+struct RayPacket {
+    static constexpr std::size_t SIZE{RayQuery::RAY_PACKET_SIZE};
+    using Lanes = std::array<float, SIZE>;
+    /// The lanes of every axis. The children of an octant share the lanes of the octant and of its center planes, so
+    /// they are referenced instead of copied.
+    using AxisLanes = std::array<const Lanes *, 3>;
+    static constexpr std::array<std::uint32_t, SIZE> LANE_BITS{1, 2, 4, 8, 16, 32, 64, 128};
+
+    /// The index of the ray of every lane in the batch.
+    std::array<std::size_t, SIZE> rays{};
+    std::array<glm::vec3, SIZE> origins{};
+    std::array<glm::vec3, SIZE> directions{};
+    /// The lanes whose ray has hit a cube.
+    std::uint32_t hit_mask{0};
+    std::array<RayHit, SIZE> hits{};
+};
+
+/// The lanes whose ray passes through a cube before the maximum distance.
+/// The lane loop has a fixed length and selects instead of branching, so the compiler turns it into vector
+/// instructions. std::min and std::max are avoided on purpose, as they select references instead of values.
+/// @param t0 The ray parameters at which the rays cross the lower planes of the cube
+/// @param t1 The ray parameters at which the rays cross the upper planes of the cube
+std::uint32_t passing_lanes(const RayPacket::AxisLanes &t0, const RayPacket::AxisLanes &t1, const float max_distance) {
+    const RayPacket::Lanes &x0 = *t0[0];
+    const RayPacket::Lanes &y0 = *t0[1];
+    const RayPacket::Lanes &z0 = *t0[2];
+    const RayPacket::Lanes &x1 = *t1[0];
+    const RayPacket::Lanes &y1 = *t1[1];
+    const RayPacket::Lanes &z1 = *t1[2];
+    std::uint32_t lanes = 0;
+    for (std::size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+        float t_enter = x0[lane] > y0[lane] ? x0[lane] : y0[lane];
+        t_enter = t_enter > z0[lane] ? t_enter : z0[lane];
+        float t_exit = x1[lane] < y1[lane] ? x1[lane] : y1[lane];
+        t_exit = t_exit < z1[lane] ? t_exit : z1[lane];
+        const std::uint32_t passing = (t_exit >= 0.0f) & (t_enter <= t_exit) & (t_enter <= max_distance);
+        lanes |= passing * RayPacket::LANE_BITS[lane];
+    }
+    return lanes;
+}
+
+/// Traverse the children of the octants in the order of their index. This is front to back for every ray of the
+/// packet: all directions are positive after mirroring, so a ray only moves from a child to a child with more axis
+/// bits set, which has a higher index. The children a ray passes through are therefore visited in the order in which
+/// the ray passes through them, and the first hit of every lane is its nearest hit.
+/// @param lanes The lanes whose ray passes through the cube and has not hit a cube yet
+template <typename Nodes>
+void traverse_packet(const Nodes &nodes, const typename Nodes::Node node, const RayPacket::AxisLanes &t0,
+                     const RayPacket::AxisLanes &t1, const std::uint32_t lanes, const std::uint32_t level,
+                     const Traversal &traversal, RayPacket &packet) {
+    // The ray of a single lane, which shares everything but the origin and the direction with the packet.
+    auto lane_traversal = [&](const std::size_t lane) {
+        Traversal result = traversal;
+        result.origin = packet.origins[lane];
+        result.direction = packet.directions[lane];
+        return result;
+    };
+
+    // Once the rays of a packet have diverged, the lanes which are left are cheaper to traverse on their own.
+    if (std::popcount(lanes) == 1) {
+        const auto lane = static_cast<std::size_t>(std::countr_zero(lanes));
+        const auto hit = traverse(nodes, node, {(*t0[0])[lane], (*t0[1])[lane], (*t0[2])[lane]},
+                                  {(*t1[0])[lane], (*t1[1])[lane], (*t1[2])[lane]}, level, lane_traversal(lane));
+        if (hit) {
+            packet.hits[lane] = *hit;
+            packet.hit_mask |= lanes;
+        }
+        return;
+    }
+
+    const bool max_depth_reached = traversal.max_depth && level >= *traversal.max_depth;
+    const Cube::Type type = nodes.type(node);
+    if (type == Cube::Type::SOLID || (type == Cube::Type::OCTANT && max_depth_reached)) {
+        for (std::size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+            if ((lanes & RayPacket::LANE_BITS[lane]) == 0) {
+                continue;
+            }
+            int entry_axis = 0;
+            for (int axis = 1; axis < 3; axis++) {
+                if ((*t0[axis])[lane] > (*t0[entry_axis])[lane]) {
+                    entry_axis = axis;
+                }
+            }
+            const float t_enter = (*t0[entry_axis])[lane];
+            RayHit &hit = packet.hits[lane];
+            Nodes::set_hit(hit, node);
+            hit.t = std::max(t_enter, 0.0f);
+            hit.level = level;
+            if (t_enter >= 0.0f) {
+                hit.normal[entry_axis] = traversal.direction[entry_axis] < 0.0f ? 1.0f : -1.0f;
+            }
+        }
+        packet.hit_mask |= lanes;
+        return;
+    }
+    if (type == Cube::Type::NORMAL) {
+        const CubeTriangles triangles(nodes, node);
+        for (std::size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+            if ((lanes & RayPacket::LANE_BITS[lane]) == 0) {
+                continue;
+            }
+            if (const auto hit = normal_cube_hit<Nodes>(triangles, node, level, lane_traversal(lane))) {
+                packet.hits[lane] = *hit;
+                packet.hit_mask |= RayPacket::LANE_BITS[lane];
+            }
+        }
+        return;
+    }
+    if (type != Cube::Type::OCTANT) {
+        return;
+    }
+
+    std::array<RayPacket::Lanes, 3> tm;
+    for (std::size_t axis = 0; axis < 3; axis++) {
+        const RayPacket::Lanes &axis_t0 = *t0[axis];
+        const RayPacket::Lanes &axis_t1 = *t1[axis];
+        for (std::size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+            tm[axis][lane] = 0.5f * (axis_t0[lane] + axis_t1[lane]);
+        }
+    }
+    for (std::uint8_t child = 0; child < Cube::SUB_CUBES; child++) {
+        RayPacket::AxisLanes child_t0;
+        RayPacket::AxisLanes child_t1;
+        for (std::size_t axis = 0; axis < 3; axis++) {
+            const bool upper_half = (child & AXIS_BITS[axis]) != 0;
+            child_t0[axis] = upper_half ? &tm[axis] : t0[axis];
+            child_t1[axis] = upper_half ? t1[axis] : &tm[axis];
+        }
+        // Testing the lanes here instead of in the child skips the children which no ray passes through early.
+        const std::uint32_t child_lanes =
+            passing_lanes(child_t0, child_t1, traversal.max_distance) & lanes & ~packet.hit_mask;
+        if (child_lanes != 0) {
+            traverse_packet(nodes, nodes.child(node, child ^ traversal.mirror_mask), child_t0, child_t1, child_lanes,
+                            level + 1, traversal, packet);
+            if ((packet.hit_mask & lanes) == lanes) {
+                return;
+            }
+        }
+    }
+}
+
+} // namespace
+
+void RayBatch::add(const glm::vec3 &origin, const glm::vec3 &direction) {
+    origin_x.push_back(origin.x);
+    origin_y.push_back(origin.y);
+    origin_z.push_back(origin.z);
+    direction_x.push_back(direction.x);
+    direction_y.push_back(direction.y);
+    direction_z.push_back(direction.z);
+}
+
+void RayBatch::reserve(const std::size_t size) {
+    for (auto *values : {&origin_x, &origin_y, &origin_z, &direction_x, &direction_y, &direction_z}) {
+        values->reserve(size);
+    }
+}
+
+std::optional<RayHit> RayQuery::cast(const glm::vec3 &origin, const glm::vec3 &direction,
+                                     const float max_distance) const {
+    Traversal traversal{
+        .mirror_mask = 0,
+        .origin = origin,
+        .direction = direction,
+        .max_distance = max_distance,
+        .max_depth = m_max_depth,
+    };
+    // The octree is mirrored on every axis on which the ray goes into the negative direction, which is undone by
+    // mirroring the child indices. This way, the children are always entered from the lower planes.
+    const glm::vec3 position = m_root != nullptr ? m_root->position() : m_compact_octree->position();
+    const float size = m_root != nullptr ? m_root->size() : m_compact_octree->size();
+    const std::array<glm::vec3, 2> bounding_box{position, position + size};
+    glm::vec3 t0;
+    glm::vec3 t1;
+    for (int axis = 0; axis < 3; axis++) {
+        float mirrored_origin = origin[axis];
+        float mirrored_direction = direction[axis];
+        if (mirrored_direction < 0.0f) {
+            mirrored_origin = bounding_box[0][axis] + bounding_box[1][axis] - mirrored_origin;
+            mirrored_direction = -mirrored_direction;
+            traversal.mirror_mask |= AXIS_BITS[axis];
+        }
+        mirrored_direction = std::max(mirrored_direction, MIN_DIRECTION);
+        t0[axis] = (bounding_box[0][axis] - mirrored_origin) / mirrored_direction;
+        t1[axis] = (bounding_box[1][axis] - mirrored_origin) / mirrored_direction;
+    }
+    if (m_root != nullptr) {
+        return traverse(CubeNodes{}, m_root, t0, t1, 0, traversal);
+    }
+    return traverse(CompactNodes{*m_compact_octree}, CompactOctree::ROOT, t0, t1, 0, traversal);
+}
+
+std::vector<std::optional<RayHit>> RayQuery::cast(const RayBatch &rays, const float max_distance,
+                                                  const std::size_t thread_count) const {
+    const std::size_t ray_count = rays.size();
+    for (const auto *values : {&rays.origin_y, &rays.origin_z, &rays.direction_x, &rays.direction_y,
+                               &rays.direction_z}) {
+        if (values->size() != ray_count) {
+            throw std::invalid_argument("Error: The arrays of the ray batch have different sizes");
+        }
+    }
+    const std::array<const std::vector<float> *, 3> origins{&rays.origin_x, &rays.origin_y, &rays.origin_z};
+    const std::array<const std::vector<float> *, 3> directions{&rays.direction_x, &rays.direction_y,
+                                                                &rays.direction_z};
+
+    // Group the rays by the signs of their directions, as the rays of a packet must be mirrored the same way.
+    std::array<std::vector<std::size_t>, Cube::SUB_CUBES> groups;
+    for (std::size_t ray = 0; ray < ray_count; ray++) {
+        std::uint8_t mirror_mask = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            if ((*directions[axis])[ray] < 0.0f) {
+                mirror_mask |= AXIS_BITS[axis];
+            }
+        }
+        groups[mirror_mask].push_back(ray);
+    }
+    struct PacketRange {
+        std::uint8_t mirror_mask;
+        std::size_t begin;
+        std::size_t end;
+    };
+    std::vector<PacketRange> packets;
+    packets.reserve(ray_count / RAY_PACKET_SIZE + Cube::SUB_CUBES);
+    for (std::uint8_t mirror_mask = 0; mirror_mask < Cube::SUB_CUBES; mirror_mask++) {
+        for (std::size_t begin = 0; begin < groups[mirror_mask].size(); begin += RAY_PACKET_SIZE) {
+            packets.push_back({mirror_mask, begin, std::min(begin + RAY_PACKET_SIZE, groups[mirror_mask].size())});
+        }
+    }
+
+    const glm::vec3 position = m_root != nullptr ? m_root->position() : m_compact_octree->position();
+    const float size = m_root != nullptr ? m_root->size() : m_compact_octree->size();
+    const std::array<glm::vec3, 2> bounding_box{position, position + size};
+
+    std::vector<std::optional<RayHit>> hits(ray_count);
+    auto cast_packet = [&](const std::size_t packet_index) {
+        const PacketRange &range = packets[packet_index];
+        const Traversal traversal{
+            .mirror_mask = range.mirror_mask,
+            .origin = {},
+            // Only the signs of the directions are needed for the hit normals, and they are the same for the packet.
+            .direction = glm::vec3((range.mirror_mask & AXIS_BITS[0]) != 0 ? -1.0f : 1.0f,
+                                   (range.mirror_mask & AXIS_BITS[1]) != 0 ? -1.0f : 1.0f,
+                                   (range.mirror_mask & AXIS_BITS[2]) != 0 ? -1.0f : 1.0f),
+            .max_distance = max_distance,
+            .max_depth = m_max_depth,
+        };
+        RayPacket packet;
+        std::array<RayPacket::Lanes, 3> t0{};
+        std::array<RayPacket::Lanes, 3> t1{};
+        std::uint32_t filled_lanes = 0;
+        for (std::size_t lane = 0; lane < range.end - range.begin; lane++) {
+            const std::size_t ray = groups[range.mirror_mask][range.begin + lane];
+            packet.rays[lane] = ray;
+            packet.origins[lane] = {rays.origin_x[ray], rays.origin_y[ray], rays.origin_z[ray]};
+            packet.directions[lane] = {rays.direction_x[ray], rays.direction_y[ray], rays.direction_z[ray]};
+            filled_lanes |= RayPacket::LANE_BITS[lane];
+            for (int axis = 0; axis < 3; axis++) {
+                float origin = (*origins[axis])[ray];
+                float direction = (*directions[axis])[ray];
+                if ((range.mirror_mask & AXIS_BITS[axis]) != 0) {
+                    origin = bounding_box[0][axis] + bounding_box[1][axis] - origin;
+                    direction = -direction;
+                }
+                direction = std::max(direction, MIN_DIRECTION);
+                t0[axis][lane] = (bounding_box[0][axis] - origin) / direction;
+                t1[axis][lane] = (bounding_box[1][axis] - origin) / direction;
+            }
+        }
+        const RayPacket::AxisLanes root_t0{&t0[0], &t0[1], &t0[2]};
+        const RayPacket::AxisLanes root_t1{&t1[0], &t1[1], &t1[2]};
+        const std::uint32_t lanes = passing_lanes(root_t0, root_t1, max_distance) & filled_lanes;
+        if (lanes != 0 && m_root != nullptr) {
+            traverse_packet(CubeNodes{}, m_root, root_t0, root_t1, lanes, 0, traversal, packet);
+        } else if (lanes != 0) {
+            traverse_packet(CompactNodes{*m_compact_octree}, CompactOctree::ROOT, root_t0, root_t1, lanes, 0,
+                            traversal, packet);
+        }
+        for (std::size_t lane = 0; lane < range.end - range.begin; lane++) {
+            if ((packet.hit_mask & RayPacket::LANE_BITS[lane]) != 0) {
+                hits[packet.rays[lane]] = packet.hits[lane];
+            }
+        }
+    };
+
+    // Small batches are not worth starting threads for.
+    constexpr std::size_t MIN_PACKETS_PER_THREAD{64};
+    tools::parallel_for(packets.size(), cast_packet,
+                        packets.size() < 2 * MIN_PACKETS_PER_THREAD ? 1 : thread_count);
+    return hits;
+}
+
+} // namespace inexor::vulkan_renderer::octree
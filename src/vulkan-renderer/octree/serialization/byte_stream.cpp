@@ -2,39 +2,197 @@
 
 #include "inexor/vulkan-renderer/octree/cube.hpp"
 
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#endif
 
 namespace inexor::vulkan_renderer::serialization {
 
-std::vector<std::uint8_t> ByteStream::read_file(const std::filesystem::path &path) {
-    std::ifstream stream(path, std::ios::in | std::ios::binary);
-    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+namespace {
+
+/// A read-only mapping of a whole file, the mapping is released when the last copy of the owner is destroyed.
+struct FileMapping {
+    std::shared_ptr<const void> owner;
+    std::span<const std::uint8_t> data;
+};
+
+FileMapping map_file(const std::filesystem::path &path) {
+    const auto open_error = [&]() { return std::runtime_error("Error: Could not open file " + path.string()); };
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw open_error();
+    }
+    LARGE_INTEGER file_size{};
+    if (GetFileSizeEx(file, &file_size) == 0) {
+        CloseHandle(file);
+        throw open_error();
+    }
+    if (file_size.QuadPart == 0) {
+        // Empty files can not be mapped.
+        CloseHandle(file);
+        return {};
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        throw std::runtime_error("Error: CreateFileMappingW failed for file " + path.string());
+    }
+    const void *address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the mapping alive.
+    CloseHandle(mapping);
+    if (address == nullptr) {
+        throw std::runtime_error("Error: MapViewOfFile failed for file " + path.string());
+    }
+    const auto size = static_cast<std::size_t>(file_size.QuadPart);
+    return {
+        .owner = std::shared_ptr<const void>(address, [](const void *view) { UnmapViewOfFile(view); }),
+        .data = {static_cast<const std::uint8_t *>(address), size},
+    };
+#else
+    const int file = open(path.c_str(), O_RDONLY); // NOLINT
+    if (file == -1) {
+        throw open_error();
+    }
+    struct stat file_status {};
+    if (fstat(file, &file_status) == -1) {
+        close(file);
+        throw open_error();
+    }
+    const auto size = static_cast<std::size_t>(file_status.st_size);
+    if (size == 0) {
+        // Empty files can not be mapped.
+        close(file);
+        return {};
+    }
+    void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping stays valid after the file has been closed.
+    close(file);
+    if (address == MAP_FAILED) { // NOLINT
+        throw std::runtime_error("Error: mmap failed for file " + path.string());
+    }
+    // The octree is parsed front to back, so the kernel can read ahead aggressively.
+    madvise(address, size, MADV_SEQUENTIAL);
+    return {
+        .owner = std::shared_ptr<const void>(address, [size](const void *mapping) {
+            munmap(const_cast<void *>(mapping), size); // NOLINT
+        }),
+        .data = {static_cast<const std::uint8_t *>(address), size},
+    };
+#endif
+}
+
+#if defined(__SSSE3__) || defined(__AVX__)
+/// The start and end of the uids, in the order of Indentation: start, then end. The table is padded to 48 uids, which
+/// are looked up in 3 shuffles of 16 entries.
+struct UidShuffleTables {
+    std::array<std::array<std::uint8_t, 16>, 3> start{};
+    std::array<std::array<std::uint8_t, 16>, 3> end{};
+};
+
+constexpr UidShuffleTables create_uid_shuffle_tables() {
+    UidShuffleTables tables;
+    std::size_t uid = 0;
+    for (std::uint8_t start = 0; start <= octree::Indentation::MAX; start++) {
+        for (std::uint8_t end = start; end <= octree::Indentation::MAX; end++, uid++) {
+            tables.start[uid / 16][uid % 16] = start;
+            tables.end[uid / 16][uid % 16] = end;
+        }
+    }
+    return tables;
+}
+
+constexpr UidShuffleTables UID_SHUFFLE_TABLES{create_uid_shuffle_tables()};
+
+/// Decode 16 packed indentations from 12 bytes with SSSE3, 16 bytes must be readable.
+/// @return A mask which has bits set for invalid uids, the indentations of invalid uids are undefined
+__m128i decode_indentations_ssse3(const std::uint8_t *bytes, octree::Indentation *indentations) {
+    static_assert(sizeof(octree::Indentation) == 2, "The indentations are stored as pairs of start and end");
+    const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes)); // NOLINT
+    // Move the 3 bytes of every word into a 32 bit lane of its own, with the first byte as the most significant one.
+    const __m128i words = _mm_shuffle_epi8(data, _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1));
+    // Move the 4 uids of a lane into its 4 bytes.
+    const __m128i uids = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(_mm_srli_epi32(words, 18), _mm_set1_epi32(0x3f)),
+                     _mm_and_si128(_mm_srli_epi32(words, 4), _mm_set1_epi32(0x3f00))),
+        _mm_or_si128(_mm_and_si128(_mm_slli_epi32(words, 10), _mm_set1_epi32(0x3f0000)),
+                     _mm_and_si128(_mm_slli_epi32(words, 24), _mm_set1_epi32(0x3f000000))));
+
+    // A shuffle looks up the lowest 4 bits of an index and returns 0 if the highest bit is set. Adding 0x70 with
+    // saturation keeps the indices of the table and sets the highest bit for all others.
+    __m128i start = _mm_setzero_si128();
+    __m128i end = _mm_setzero_si128();
+    for (std::size_t table = 0; table < 3; table++) {
+        const __m128i index = _mm_adds_epu8(_mm_sub_epi8(uids, _mm_set1_epi8(static_cast<char>(16 * table))),
+                                            _mm_set1_epi8(0x70));
+        const auto lookup = [&](const std::array<std::uint8_t, 16> &entries) {
+            const __m128i table_entries = _mm_loadu_si128(reinterpret_cast<const __m128i *>(entries.data())); // NOLINT
+            return _mm_shuffle_epi8(table_entries, index);
+        };
+        start = _mm_or_si128(start, lookup(UID_SHUFFLE_TABLES.start[table]));
+        end = _mm_or_si128(end, lookup(UID_SHUFFLE_TABLES.end[table]));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(indentations), _mm_unpacklo_epi8(start, end));    // NOLINT
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(indentations + 8), _mm_unpackhi_epi8(start, end)); // NOLINT
+    return _mm_cmpgt_epi8(uids, _mm_set1_epi8(static_cast<char>(octree::Indentation::UID_COUNT - 1)));
 }
+#endif
+
+} // namespace
 
 ByteStream::ByteStream(std::vector<std::uint8_t> buffer) : m_buffer(std::move(buffer)) {}
 
-ByteStream::ByteStream(const std::filesystem::path &path) : ByteStream(read_file(path)) {}
+ByteStream::ByteStream(const std::span<const std::uint8_t> data) : m_view(data) {}
+
+ByteStream::ByteStream(const std::filesystem::path &path) {
+    auto mapping = map_file(path);
+    m_view = mapping.data;
+    m_view_owner = std::move(mapping.owner);
+}
 
-const std::vector<std::uint8_t> &ByteStream::buffer() const {
-    return m_buffer;
+std::span<const std::uint8_t> ByteStream::data() const {
+    return m_view ? *m_view : std::span<const std::uint8_t>(m_buffer);
 }
 
 std::size_t ByteStream::size() const {
-    return m_buffer.size();
+    return data().size();
 }
 
 void ByteStreamReader::check_end(const std::size_t size) const {
-    if (static_cast<std::size_t>(std::distance(m_iter, m_stream.buffer().end())) < size) {
+    if (static_cast<std::size_t>(m_end - m_iter) < size) {
         throw std::runtime_error("Error: end of byte stream would be overrun");
     }
 }
 
-ByteStreamReader::ByteStreamReader(const ByteStream &stream) : m_stream(stream), m_iter(stream.buffer().begin()) {}
+ByteStreamReader::ByteStreamReader(const ByteStream &stream) : ByteStreamReader(stream.data()) {}
+
+ByteStreamReader::ByteStreamReader(const std::span<const std::uint8_t> data)
+    : m_iter(data.data()), m_end(data.data() + data.size()) {}
 
 void ByteStreamReader::skip(const std::size_t size) {
-    const std::size_t skip = std::min(
-        size, std::size_t(std::distance<std::vector<std::uint8_t>::const_iterator>(m_iter, m_stream.buffer().end())));
-    std::advance(m_iter, skip);
+    m_iter += std::min(size, remaining());
 }
 
 template <>
@@ -43,20 +201,38 @@ std::uint8_t ByteStreamReader::read() {
     return *m_iter++;
 }
 
+template <>
+std::uint16_t ByteStreamReader::read() {
+    check_end(2);
+    const auto value = static_cast<std::uint16_t>((m_iter[0] << 0u) | (m_iter[1] << 8u));
+    m_iter += 2;
+    return value;
+}
+
 template <>
 std::uint32_t ByteStreamReader::read() {
     check_end(4);
-    return (*m_iter++ << 0u) | (*m_iter++ << 8u) | (*m_iter++ << 16u) | (*m_iter++ << 24u);
+    const std::uint32_t value = (m_iter[0] << 0u) | (m_iter[1] << 8u) | (m_iter[2] << 16u) | (m_iter[3] << 24u);
+    m_iter += 4;
+    return value;
 }
 
 template <>
 std::string ByteStreamReader::read(const std::size_t &size) {
     check_end(size);
-    auto start = m_iter;
-    std::advance(m_iter, size);
+    const auto *start = m_iter;
+    m_iter += size;
     return {start, m_iter};
 }
 
+template <>
+std::span<const std::uint8_t> ByteStreamReader::read(const std::size_t &size) {
+    check_end(size);
+    const std::span<const std::uint8_t> data(m_iter, size);
+    m_iter += size;
+    return data;
+}
+
 template <>
 octree::Cube::Type ByteStreamReader::read() {
     return static_cast<octree::Cube::Type>(read<std::uint8_t>());
@@ -64,39 +240,140 @@ octree::Cube::Type ByteStreamReader::read() {
 
 template <>
 std::array<octree::Indentation, 12> ByteStreamReader::read() {
-    check_end(9);
     std::array<octree::Indentation, 12> indentations;
-    auto writer = indentations.begin(); // NOLINT
-    const auto end = m_iter + 9;
-    while (m_iter != end) {
-        *writer++ = octree::Indentation(*m_iter >> 2u);
-        *writer++ = octree::Indentation(((*m_iter & 0b00000011u) << 4u) | (*(++m_iter) >> 4u));
-        *writer++ = octree::Indentation(((*m_iter & 0b00001111u) << 2u) | (*(++m_iter) >> 6u));
-        *writer++ = octree::Indentation(*m_iter++ & 0b00111111u);
-    }
+    read_indentations(indentations);
     return indentations;
 }
 
+void ByteStreamReader::read_indentations(const std::span<octree::Indentation> indentations) {
+    if (indentations.size() % 4 != 0) {
+        throw std::invalid_argument("Error: The number of indentations must be a multiple of 4");
+    }
+    check_end(indentations.size() / 4 * 3);
+    // The loops have no branches: invalid uids are collected in a flag, which is checked once all indentations are
+    // decoded. The indentations are undefined if an exception is thrown.
+    const std::uint8_t *bytes = m_iter;
+    const std::size_t word_count = indentations.size() / 4;
+    std::size_t word = 0;
+    std::uint32_t invalid = 0;
+#if defined(__SSSE3__) || defined(__AVX__)
+    // 4 words are decoded at once, as long as the 16 bytes which are loaded lie in the stream.
+    __m128i invalid_uids = _mm_setzero_si128();
+    for (; word + 4 <= word_count && 3 * word + 16 <= remaining(); word += 4) {
+        invalid_uids = _mm_or_si128(invalid_uids, decode_indentations_ssse3(bytes + 3 * word, &indentations[4 * word]));
+    }
+    invalid = static_cast<std::uint32_t>(_mm_movemask_epi8(invalid_uids));
+#endif
+    // Each group of 3 bytes is read as one word, so the 4 uids are extracted without carrying bits between bytes.
+    // A uid is invalid if adding 64 - UID_COUNT carries out of its 6 bits. Adding this to all 4 uids of a word at once
+    // carries into bit 6, 12, 18 or 24 if any uid is invalid. A carry can make the next uid carry as well, but never
+    // hides an invalid uid.
+    constexpr std::uint32_t UID_OFFSET{64 - octree::Indentation::UID_COUNT};
+    constexpr std::uint32_t OFFSETS{UID_OFFSET << 18u | UID_OFFSET << 12u | UID_OFFSET << 6u | UID_OFFSET};
+    constexpr std::uint32_t CARRIES{1u << 24u | 1u << 18u | 1u << 12u | 1u << 6u};
+    for (; word < word_count; word++) {
+        const std::uint32_t bits = (bytes[3 * word] << 16u) | (bytes[3 * word + 1] << 8u) | bytes[3 * word + 2];
+        invalid |= ((bits + OFFSETS) ^ bits ^ OFFSETS) & CARRIES;
+        for (std::size_t idx = 0; idx < 4; idx++) {
+            const auto uid = static_cast<std::uint8_t>((bits >> (18 - 6 * idx)) & 0b00111111u);
+            indentations[4 * word + idx] = octree::Indentation::from_packed_uid(uid);
+        }
+    }
+    if (invalid != 0) {
+        throw std::runtime_error("Error: Invalid indentation uid");
+    }
+    m_iter += word_count * 3;
+}
+
 std::size_t ByteStreamReader::remaining() const {
-    return std::distance<std::vector<std::uint8_t>::const_iterator>(m_iter, m_stream.buffer().end());
+    return static_cast<std::size_t>(m_end - m_iter);
+}
+
+FileByteSink::FileByteSink(const std::filesystem::path &path)
+    : m_file(path, std::ios::out | std::ios::binary | std::ios::trunc) {
+    if (!m_file) {
+        throw std::runtime_error("Error: Could not open file " + path.string());
+    }
+}
+
+void FileByteSink::write(const std::span<const std::uint8_t> data) {
+    m_file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size())); // NOLINT
+    if (!m_file) {
+        throw std::runtime_error("Error: Could not write to file");
+    }
+}
+
+ByteStreamWriter::ByteStreamWriter(std::vector<std::uint8_t> buffer) : ByteStream(std::move(buffer)) {}
+
+ByteStreamWriter::ByteStreamWriter(ByteSink &sink, const std::size_t buffer_size)
+    : m_sink(&sink), m_sink_buffer_size(std::max<std::size_t>(buffer_size, 1)) {
+    m_buffer.reserve(m_sink_buffer_size);
+}
+
+void ByteStreamWriter::append(const std::span<const std::uint8_t> data) {
+    if (m_sink != nullptr && m_buffer.size() + data.size() > m_sink_buffer_size) {
+        flush();
+        if (data.size() > m_sink_buffer_size) {
+            // Larger blocks are passed on directly instead of splitting them.
+            m_sink->write(data);
+            return;
+        }
+    }
+    m_buffer.insert(m_buffer.end(), data.begin(), data.end());
+}
+
+void ByteStreamWriter::flush() {
+    if (m_sink == nullptr || m_buffer.empty()) {
+        return;
+    }
+    m_sink->write(m_buffer);
+    m_buffer.clear();
+}
+
+void ByteStreamWriter::reserve(const std::size_t size) {
+    if (m_sink == nullptr) {
+        m_buffer.reserve(size);
+    }
 }
 
 template <>
 void ByteStreamWriter::write(const std::uint8_t &value) {
-    m_buffer.emplace_back(value);
+    if (m_sink != nullptr && m_buffer.size() == m_sink_buffer_size) {
+        flush();
+    }
+    m_buffer.push_back(value);
+}
+
+template <>
+void ByteStreamWriter::write(const std::uint16_t &value) {
+    // Little endian, like ByteStreamReader::read<std::uint16_t>
+    const std::array<std::uint8_t, 2> bytes{
+        static_cast<std::uint8_t>(value),
+        static_cast<std::uint8_t>(value >> 8u),
+    };
+    append(bytes);
 }
 
 template <>
 void ByteStreamWriter::write(const std::uint32_t &value) {
-    m_buffer.emplace_back(value >> 24u);
-    m_buffer.emplace_back(value >> 16u);
-    m_buffer.emplace_back(value >> 8u);
-    m_buffer.emplace_back(value);
+    // Little endian, like ByteStreamReader::read<std::uint32_t>
+    const std::array<std::uint8_t, 4> bytes{
+        static_cast<std::uint8_t>(value),
+        static_cast<std::uint8_t>(value >> 8u),
+        static_cast<std::uint8_t>(value >> 16u),
+        static_cast<std::uint8_t>(value >> 24u),
+    };
+    append(bytes);
+}
+
+template <>
+void ByteStreamWriter::write(const std::span<const std::uint8_t> &value) {
+    append(value);
 }
 
 template <>
 void ByteStreamWriter::write(const std::string &value) {
-    std::copy(value.begin(), value.end(), std::back_inserter(m_buffer));
+    append({reinterpret_cast<const std::uint8_t *>(value.data()), value.size()}); // NOLINT
 }
 
 template <>
@@ -106,10 +383,27 @@ void ByteStreamWriter::write(const octree::Cube::Type &value) {
 
 template <>
 void ByteStreamWriter::write(const std::array<octree::Indentation, 12> &value) {
-    for (auto iter = value.begin(); iter != value.end(); iter++) { // NOLINT
-        write<std::uint8_t>((iter->uid() << 2u) | ((++iter)->uid() >> 4));
-        write<std::uint8_t>((iter->uid() << 4u) | ((++iter)->uid() >> 2));
-        write<std::uint8_t>((iter->uid() << 6u) | ((++iter)->uid()));
+    write_indentations(value);
+}
+
+void ByteStreamWriter::write_indentations(const std::span<const octree::Indentation> indentations) {
+    if (indentations.size() % 4 != 0) {
+        throw std::invalid_argument("Error: The number of indentations must be a multiple of 4");
+    }
+    // The bytes are collected in blocks, so the buffer is not resized for every group of 4 indentations.
+    std::array<std::uint8_t, 3 * 64> bytes; // NOLINT
+    std::size_t size = 0;
+    for (std::size_t idx = 0; idx < indentations.size(); idx += 4) {
+        const std::uint32_t bits = (indentations[idx].uid() << 18u) | (indentations[idx + 1].uid() << 12u) |
+                                   (indentations[idx + 2].uid() << 6u) | indentations[idx + 3].uid();
+        bytes[size++] = static_cast<std::uint8_t>(bits >> 16u);
+        bytes[size++] = static_cast<std::uint8_t>(bits >> 8u);
+        bytes[size++] = static_cast<std::uint8_t>(bits);
+        if (size == bytes.size()) {
+            append(bytes);
+            size = 0;
+        }
     }
+    append(std::span<const std::uint8_t>(bytes).first(size));
 }
 } // namespace inexor::vulkan_renderer::serialization
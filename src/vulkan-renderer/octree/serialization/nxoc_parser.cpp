@@ -2,13 +2,156 @@
 
 #include "inexor/vulkan-renderer/octree/cube.hpp"
 #include "inexor/vulkan-renderer/octree/serialization/byte_stream.hpp"
+#include "inexor/vulkan-renderer/octree/serialization/rans_coder.hpp"
+#include "inexor/vulkan-renderer/tools/parallel.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace inexor::vulkan_renderer::serialization {
 
+namespace {
+
+/// The symbols of the cube type stream of version 2 are the 4 cube types, followed by RUN_SYMBOLS symbols which repeat
+/// the previous cube type 2^0 up to 2^(RUN_SYMBOLS - 1) times.
+constexpr std::uint16_t CUBE_TYPES{4};
+constexpr std::uint16_t RUN_SYMBOLS{16};
+constexpr std::uint16_t TYPE_SYMBOLS{CUBE_TYPES + RUN_SYMBOLS};
+/// The symbols of the indentation stream of version 2 are the indentation uids.
+constexpr std::uint16_t INDENTATION_SYMBOLS{45};
+
+/// Write a rANS coded symbol stream: the symbol frequencies, the number of encoded bytes and the encoded bytes.
+void write_rans_stream(ByteStreamWriter &writer, const std::span<const std::uint16_t> symbols,
+                       const std::size_t symbol_count) {
+    std::vector<std::uint64_t> counts(symbol_count, 0);
+    for (const auto symbol : symbols) {
+        counts[symbol]++;
+    }
+    const auto table = RansFrequencyTable::from_counts(counts);
+    for (const auto frequency : table.frequencies()) {
+        writer.write(frequency);
+    }
+    const auto bytes = rans_encode(symbols, table);
+    if (bytes.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Error: Octree is too large for octree version 2");
+    }
+    writer.write(static_cast<std::uint32_t>(bytes.size()));
+    writer.write(std::span<const std::uint8_t>(bytes));
+}
+
+/// Read the frequencies of a rANS coded symbol stream.
+RansFrequencyTable read_rans_table(ByteStreamReader &reader, const std::size_t symbol_count) {
+    std::vector<std::uint16_t> frequencies(symbol_count);
+    for (auto &frequency : frequencies) {
+        frequency = reader.read<std::uint16_t>();
+    }
+    return RansFrequencyTable(std::move(frequencies));
+}
+
+/// Write a subtree of a random world in pre-order, without the byte sizes of indexed levels.
+/// @param code The locational code of the root of the subtree
+/// @param max_depth The maximum of nested octants of the world
+/// @param seed The seed of the world
+/// @param writer The writer
+void write_random_subtree(const octree::LocationalCode &code, const std::uint32_t max_depth, const std::uint32_t seed,
+                          ByteStreamWriter &writer) {
+    if (code.level() <= max_depth) {
+        writer.write(octree::Cube::Type::OCTANT);
+        for (std::size_t idx = 0; idx < octree::Cube::SUB_CUBES; idx++) {
+            write_random_subtree(code.child(idx), max_depth, seed, writer);
+        }
+        return;
+    }
+    const auto cube = octree::random_world_cube(seed, code);
+    writer.write(cube.type);
+    if (cube.type == octree::Cube::Type::NORMAL) {
+        writer.write(cube.indentations);
+    }
+}
+
+/// The number of bytes which write_random_subtree writes.
+std::size_t random_subtree_size(const octree::LocationalCode &code, const std::uint32_t max_depth,
+                                const std::uint32_t seed) {
+    if (code.level() <= max_depth) {
+        std::size_t size = 1;
+        for (std::size_t idx = 0; idx < octree::Cube::SUB_CUBES; idx++) {
+            size += random_subtree_size(code.child(idx), max_depth, seed);
+        }
+        return size;
+    }
+    return octree::random_world_cube(seed, code).type == octree::Cube::Type::NORMAL ? 1 + 9 : 1;
+}
+
+} // namespace
+
+void NXOCParser::deserialize_subtree(octree::Cube &cube, ByteStreamReader &reader) {
+    // pre-order traversal
+    cube.change_type(reader.read<octree::Cube::Type>());
+    if (cube.type() == octree::Cube::Type::OCTANT) {
+        for (const auto &child : cube.children()) {
+            deserialize_subtree(*child, reader);
+        }
+        return;
+    }
+    if (cube.type() == octree::Cube::Type::NORMAL) {
+        cube.m_indentations = reader.read<std::array<octree::Indentation, octree::Cube::EDGES>>();
+    }
+}
+
+void NXOCParser::serialize_subtree(const octree::Cube &cube, ByteStreamWriter &writer, const std::size_t level,
+                                   const std::size_t indexed_levels) {
+    // pre-order traversal, the octants on the indexed levels store the byte sizes of their children first
+    writer.write(cube.type());
+    if (cube.type() == octree::Cube::Type::OCTANT) {
+        if (level < indexed_levels) {
+            for (const auto &child : cube.children()) {
+                const std::size_t size = serialized_size(*child, level + 1, indexed_levels);
+                if (size > std::numeric_limits<std::uint32_t>::max()) {
+                    throw std::runtime_error("Error: Subtree is too large for octree version 1");
+                }
+                writer.write(static_cast<std::uint32_t>(size));
+            }
+        }
+        for (const auto &child : cube.children()) {
+            serialize_subtree(*child, writer, level + 1, indexed_levels);
+        }
+        return;
+    }
+    if (cube.type() == octree::Cube::Type::NORMAL) {
+        writer.write(cube.indentations());
+    }
+}
+
+std::size_t NXOCParser::serialized_size(const octree::Cube &cube, const std::size_t level,
+                                        const std::size_t indexed_levels) {
+    switch (cube.type()) {
+    case octree::Cube::Type::EMPTY:
+    case octree::Cube::Type::SOLID:
+        return 1;
+    case octree::Cube::Type::NORMAL:
+        return 1 + 9;
+    case octree::Cube::Type::OCTANT:
+        std::size_t size = 1;
+        if (level < indexed_levels) {
+            size += octree::Cube::SUB_CUBES * sizeof(std::uint32_t);
+        }
+        for (const auto &child : cube.children()) {
+            size += serialized_size(*child, level + 1, indexed_levels);
+        }
+        return size;
+    }
+    return 1;
+}
+
 template <>
-std::shared_ptr<octree::Cube> NXOCParser::deserialize_impl<0>(const ByteStream &stream) {
+std::shared_ptr<octree::Cube>
+NXOCParser::deserialize_impl<0>(const ByteStream &stream,
+                                const std::optional<std::array<glm::vec3, 2>> & /*region*/) {
     ByteStreamReader reader(stream);
     std::shared_ptr<octree::Cube> root = std::make_shared<octree::Cube>();
 
@@ -17,70 +160,371 @@ std::shared_ptr<octree::Cube> NXOCParser::deserialize_impl<0>(const ByteStream &
     // Skip version.
     reader.skip(4);
 
-    std::function<void(std::shared_ptr<octree::Cube> &)> iter_func;
-    // pre-order traversal
-    iter_func = [&iter_func, &reader](std::shared_ptr<octree::Cube> &cube) {
-        cube->set_type(reader.read<octree::Cube::Type>());
-        if (cube->type() == octree::Cube::Type::OCTANT) {
-            for (auto child : cube->children()) {
-                iter_func(child);
+    deserialize_subtree(*root, reader);
+    return root;
+}
+
+template <>
+std::shared_ptr<octree::Cube>
+NXOCParser::deserialize_impl<1>(const ByteStream &stream, const std::optional<std::array<glm::vec3, 2>> &region) {
+    ByteStreamReader reader(stream);
+    std::shared_ptr<octree::Cube> root = std::make_shared<octree::Cube>();
+
+    // Skip identifier and version, which are already checked.
+    reader.skip(13 + 4);
+    const auto indexed_levels = reader.read<std::uint8_t>();
+    if (indexed_levels > MAX_INDEXED_LEVELS) {
+        throw std::runtime_error("Error: Invalid number of indexed octree levels");
+    }
+
+    auto overlaps_region = [&region](const octree::Cube &cube) {
+        if (!region) {
+            return true;
+        }
+        const auto bounding_box = cube.bounding_box();
+        for (int axis = 0; axis < 3; axis++) {
+            if (bounding_box[0][axis] > (*region)[1][axis] || bounding_box[1][axis] < (*region)[0][axis]) {
+                return false;
             }
-            return;
         }
-        if (cube->type() == octree::Cube::Type::NORMAL) {
-            cube->m_indentations = reader.read<std::array<octree::Indentation, octree::Cube::EDGES>>();
+        return true;
+    };
+
+    struct Subtree {
+        octree::Cube *cube;
+        std::span<const std::uint8_t> data;
+        std::size_t level;
+    };
+    // The indexed levels are decoded on this thread, the subtrees below them are collected and decoded in parallel.
+    std::vector<Subtree> pending{{root.get(), reader.read<std::span<const std::uint8_t>>(reader.remaining()), 0}};
+    std::vector<Subtree> subtrees;
+    while (!pending.empty()) {
+        const Subtree subtree = pending.back();
+        pending.pop_back();
+        if (subtree.level == indexed_levels) {
+            subtrees.push_back(subtree);
+            continue;
+        }
+        ByteStreamReader subtree_reader(subtree.data);
+        octree::Cube &cube = *subtree.cube;
+        cube.change_type(subtree_reader.read<octree::Cube::Type>());
+        if (cube.type() == octree::Cube::Type::OCTANT) {
+            std::array<std::uint32_t, octree::Cube::SUB_CUBES> sizes{};
+            for (auto &size : sizes) {
+                size = subtree_reader.read<std::uint32_t>();
+            }
+            for (std::size_t idx = 0; idx < octree::Cube::SUB_CUBES; idx++) {
+                const auto data = subtree_reader.read<std::span<const std::uint8_t>>(std::size_t{sizes[idx]});
+                // Skipped subtrees stay empty.
+                if (overlaps_region(*cube.children()[idx])) {
+                    pending.push_back({cube.children()[idx].get(), data, subtree.level + 1});
+                }
+            }
+        } else if (cube.type() == octree::Cube::Type::NORMAL) {
+            cube.m_indentations = subtree_reader.read<std::array<octree::Indentation, octree::Cube::EDGES>>();
+        }
+        if (subtree_reader.remaining() != 0) {
+            throw std::runtime_error("Error: Subtree size does not match its content");
         }
+    }
+
+    // The subtrees are disjoint and change_type does not touch the parents, so they can be built concurrently.
+    tools::parallel_for(
+        subtrees.size(),
+        [&subtrees](const std::size_t idx) {
+            ByteStreamReader subtree_reader(subtrees[idx].data);
+            deserialize_subtree(*subtrees[idx].cube, subtree_reader);
+            if (subtree_reader.remaining() != 0) {
+                throw std::runtime_error("Error: Subtree size does not match its content");
+            }
+        },
+        m_thread_count);
+    return root;
+}
+
+template <>
+std::shared_ptr<octree::Cube>
+NXOCParser::deserialize_impl<2>(const ByteStream &stream,
+                                const std::optional<std::array<glm::vec3, 2>> & /*region*/) {
+    ByteStreamReader reader(stream);
+    std::shared_ptr<octree::Cube> root = std::make_shared<octree::Cube>();
+
+    // Skip identifier and version, which are already checked.
+    reader.skip(13 + 4);
+    auto remaining_types = reader.read<std::uint32_t>();
+    auto remaining_indentations = reader.read<std::uint32_t>();
+    const auto type_table = read_rans_table(reader, TYPE_SYMBOLS);
+    RansDecoder types(type_table, reader.read<std::span<const std::uint8_t>>(std::size_t{reader.read<std::uint32_t>()}));
+    const auto indentation_table = read_rans_table(reader, INDENTATION_SYMBOLS);
+    RansDecoder indentations(indentation_table,
+                             reader.read<std::span<const std::uint8_t>>(std::size_t{reader.read<std::uint32_t>()}));
+
+    octree::Cube::Type previous_type{octree::Cube::Type::EMPTY};
+    std::size_t repeats = 0;
+    auto next_type = [&]() {
+        if (repeats == 0) {
+            if (remaining_types == 0) {
+                throw std::runtime_error("Error: Octree stream ended unexpectedly");
+            }
+            remaining_types--;
+            const auto symbol = types.decode();
+            if (symbol < CUBE_TYPES) {
+                previous_type = static_cast<octree::Cube::Type>(symbol);
+                return previous_type;
+            }
+            repeats = std::size_t{1} << (symbol - CUBE_TYPES);
+        }
+        repeats--;
+        return previous_type;
     };
-    iter_func(root);
+
+    // pre-order traversal
+    std::vector<octree::Cube *> stack{root.get()};
+    while (!stack.empty()) {
+        octree::Cube &cube = *stack.back();
+        stack.pop_back();
+        cube.change_type(next_type());
+        if (cube.type() == octree::Cube::Type::OCTANT) {
+            for (auto child = cube.children().rbegin(); child != cube.children().rend(); child++) {
+                stack.push_back(child->get());
+            }
+        } else if (cube.type() == octree::Cube::Type::NORMAL) {
+            if (remaining_indentations < octree::Cube::EDGES) {
+                throw std::runtime_error("Error: Octree stream ended unexpectedly");
+            }
+            remaining_indentations -= octree::Cube::EDGES;
+            for (auto &indentation : cube.m_indentations) {
+                indentation = octree::Indentation(static_cast<std::uint8_t>(indentations.decode()));
+            }
+        }
+    }
+    if (remaining_types != 0 || repeats != 0 || remaining_indentations != 0 || !types.finished() ||
+        !indentations.finished()) {
+        throw std::runtime_error("Error: Octree stream contains more data than cubes");
+    }
     return root;
 }
 
 template <>
-ByteStream NXOCParser::serialize_impl<0>(const std::shared_ptr<const octree::Cube> cube) { // NOLINT
-    ByteStreamWriter writer;
+void NXOCParser::serialize_impl<0>(const octree::Cube &cube, ByteStreamWriter &writer) {
     writer.write<std::string>("Inexor Octree");
     writer.write<std::uint32_t>(0);
+    serialize_subtree(cube, writer, 0, 0);
+}
+
+template <>
+void NXOCParser::serialize_impl<1>(const octree::Cube &cube, ByteStreamWriter &writer) {
+    writer.write<std::string>("Inexor Octree");
+    writer.write<std::uint32_t>(1);
+    writer.write<std::uint8_t>(INDEXED_LEVELS);
+    serialize_subtree(cube, writer, 0, INDEXED_LEVELS);
+}
+
+template <>
+void NXOCParser::serialize_impl<2>(const octree::Cube &cube, ByteStreamWriter &writer) {
+    // The cube types are run length coded before they are entropy coded, which turns the long runs of Type::EMPTY and
+    // Type::SOLID cubes of uniform subtrees into a few symbols.
+    std::vector<std::uint16_t> type_symbols;
+    std::vector<std::uint16_t> indentation_symbols;
+    std::size_t run = 0;
+    auto end_run = [&]() {
+        while (run > 0) {
+            const auto exponent = std::min<std::size_t>(std::bit_width(run) - 1, RUN_SYMBOLS - 1);
+            type_symbols.push_back(static_cast<std::uint16_t>(CUBE_TYPES + exponent));
+            run -= std::size_t{1} << exponent;
+        }
+    };
 
-    std::function<void(const std::shared_ptr<const octree::Cube> &)> iter_func;
     // pre-order traversal
-    iter_func = [&iter_func, &writer](const std::shared_ptr<const octree::Cube> &cube) {
-        writer.write(cube->type());
-        if (cube->type() == octree::Cube::Type::OCTANT) {
-            for (const auto &child : cube->children()) {
-                iter_func(child);
-            }
-            return;
+    std::vector<const octree::Cube *> stack{&cube};
+    std::optional<octree::Cube::Type> previous_type;
+    while (!stack.empty()) {
+        const octree::Cube &current = *stack.back();
+        stack.pop_back();
+        if (current.type() == previous_type) {
+            run++;
+        } else {
+            end_run();
+            type_symbols.push_back(static_cast<std::uint16_t>(current.type()));
+            previous_type = current.type();
         }
-        if (cube->type() == octree::Cube::Type::NORMAL) {
-            writer.write(cube->indentations());
+        if (current.type() == octree::Cube::Type::OCTANT) {
+            for (auto child = current.children().rbegin(); child != current.children().rend(); child++) {
+                stack.push_back(child->get());
+            }
+        } else if (current.type() == octree::Cube::Type::NORMAL) {
+            for (const auto &indentation : current.indentations()) {
+                indentation_symbols.push_back(indentation.uid());
+            }
         }
-    };
+    }
+    end_run();
+    if (type_symbols.size() > std::numeric_limits<std::uint32_t>::max() ||
+        indentation_symbols.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Error: Octree is too large for octree version 2");
+    }
 
-    iter_func(cube);
-    return writer;
+    writer.write<std::string>("Inexor Octree");
+    writer.write<std::uint32_t>(2);
+    writer.write(static_cast<std::uint32_t>(type_symbols.size()));
+    writer.write(static_cast<std::uint32_t>(indentation_symbols.size()));
+    write_rans_stream(writer, type_symbols, TYPE_SYMBOLS);
+    write_rans_stream(writer, indentation_symbols, INDENTATION_SYMBOLS);
 }
 
 std::shared_ptr<octree::Cube> NXOCParser::deserialize(const ByteStream &stream) {
+    return deserialize_version(stream, std::nullopt);
+}
+
+std::shared_ptr<octree::Cube> NXOCParser::deserialize_region(const ByteStream &stream, const glm::vec3 &point,
+                                                             const float radius) {
+    return deserialize_version(stream, std::array{point - radius, point + radius});
+}
+
+std::shared_ptr<octree::Cube> NXOCParser::deserialize_version(const ByteStream &stream,
+                                                              const std::optional<std::array<glm::vec3, 2>> &region) {
     ByteStreamReader reader(stream);
-    if (reader.read<std::string>(13ull) != "Inexor Octree") {
+    if (reader.read<std::string>(std::size_t{13}) != "Inexor Octree") {
         throw std::runtime_error("Error: Wrong identifier");
     }
     const auto version = reader.read<std::uint32_t>();
     switch (version) { // NOLINT
     case 0:
-        return deserialize_impl<0>(stream);
+        return deserialize_impl<0>(stream, region);
+    case 1:
+        return deserialize_impl<1>(stream, region);
+    case 2:
+        return deserialize_impl<2>(stream, region);
     default:
         throw std::runtime_error("Error: Unsupported octree version");
     }
 }
 
 ByteStream NXOCParser::serialize(const std::shared_ptr<const octree::Cube> cube, const std::uint32_t version) {
+    ByteStreamWriter writer;
+    if (cube != nullptr && version < 2) {
+        // The size is known in advance, so the buffer never has to grow. Version 1 also stores the number of indexed
+        // levels in the header.
+        const std::size_t header_size = 13 + 4 + (version == 1 ? 1 : 0);
+        writer.reserve(header_size + serialized_size(*cube, 0, version == 1 ? INDEXED_LEVELS : 0));
+    }
+    serialize_version(cube, version, writer);
+    return writer;
+}
+
+void NXOCParser::serialize(const std::shared_ptr<const octree::Cube> &cube, const std::uint32_t version,
+                           ByteSink &sink, const std::size_t buffer_size) {
+    ByteStreamWriter writer(sink, buffer_size);
+    serialize_version(cube, version, writer);
+    writer.flush();
+}
+
+void NXOCParser::serialize_random_world(const std::uint32_t max_depth, const std::uint32_t seed,
+                                        const std::uint32_t version, ByteSink &sink, const std::size_t buffer_size) {
+    if (version > 1) {
+        throw std::invalid_argument("Error: Random worlds can only be written as octree version 0 or 1!");
+    }
+    if (max_depth >= octree::LocationalCode::MAX_LEVEL) {
+        throw std::invalid_argument("Error: The depth of a random world must be smaller than the maximum level!");
+    }
+    const std::size_t indexed_levels = version == 1 ? INDEXED_LEVELS : 0;
+
+    // The subtrees below the split level are generated on multiple threads, the octants above are written on this
+    // thread. The subtrees are collected in pre-order.
+    const std::size_t split_level = std::min<std::size_t>(INDEXED_LEVELS, max_depth + 1);
+    std::vector<octree::LocationalCode> subtrees{octree::LocationalCode()};
+    while (subtrees.front().level() < split_level) {
+        std::vector<octree::LocationalCode> children;
+        children.reserve(subtrees.size() * octree::Cube::SUB_CUBES);
+        for (const auto &code : subtrees) {
+            for (std::size_t idx = 0; idx < octree::Cube::SUB_CUBES; idx++) {
+                children.push_back(code.child(idx));
+            }
+        }
+        subtrees = std::move(children);
+    }
+    std::vector<std::size_t> subtree_sizes;
+    if (indexed_levels > 0) {
+        subtree_sizes.resize(subtrees.size());
+        tools::parallel_for(
+            subtrees.size(),
+            [&](const std::size_t idx) { subtree_sizes[idx] = random_subtree_size(subtrees[idx], max_depth, seed); },
+            m_thread_count);
+    }
+    auto subtree_index = [&](const octree::LocationalCode &code) {
+        return static_cast<std::size_t>(code.value() - subtrees.front().value());
+    };
+    std::function<std::size_t(const octree::LocationalCode &)> octant_size = [&](const octree::LocationalCode &code) {
+        if (code.level() == split_level) {
+            return subtree_sizes[subtree_index(code)];
+        }
+        std::size_t size = 1 + (code.level() < indexed_levels ? octree::Cube::SUB_CUBES * sizeof(std::uint32_t) : 0);
+        for (std::size_t idx = 0; idx < octree::Cube::SUB_CUBES; idx++) {
+            size += octant_size(code.child(idx));
+        }
+        return size;
+    };
+
+    ByteStreamWriter writer(sink, buffer_size);
+    writer.write<std::string>("Inexor Octree");
+    writer.write<std::uint32_t>(version);
+    if (version == 1) {
+        writer.write<std::uint8_t>(INDEXED_LEVELS);
+    }
+
+    // The subtrees are generated in batches of one subtree per thread, which are written in order.
+    const std::size_t batch_size = m_thread_count == 0 ? tools::default_thread_count() : m_thread_count;
+    std::vector<ByteStreamWriter> batch;
+    std::size_t batch_begin = 0;
+    std::size_t next_subtree = 0;
+    std::function<void(const octree::LocationalCode &)> write_octant = [&](const octree::LocationalCode &code) {
+        if (code.level() == split_level) {
+            if (next_subtree == batch_begin + batch.size()) {
+                batch_begin = next_subtree;
+                batch.assign(std::min(batch_size, subtrees.size() - batch_begin), ByteStreamWriter());
+                tools::parallel_for(
+                    batch.size(),
+                    [&](const std::size_t idx) {
+                        write_random_subtree(subtrees[batch_begin + idx], max_depth, seed, batch[idx]);
+                    },
+                    m_thread_count);
+            }
+            writer.write(batch[next_subtree++ - batch_begin].data());
+            return;
+        }
+        writer.write(octree::Cube::Type::OCTANT);
+        if (code.level() < indexed_levels) {
+            for (std::size_t idx = 0; idx < octree::Cube::SUB_CUBES; idx++) {
+                const std::size_t size = octant_size(code.child(idx));
+                if (size > std::numeric_limits<std::uint32_t>::max()) {
+                    throw std::runtime_error("Error: Subtree is too large for octree version 1");
+                }
+                writer.write(static_cast<std::uint32_t>(size));
+            }
+        }
+        for (std::size_t idx = 0; idx < octree::Cube::SUB_CUBES; idx++) {
+            write_octant(code.child(idx));
+        }
+    };
+    write_octant(octree::LocationalCode());
+    writer.flush();
+}
+
+void NXOCParser::serialize_version(const std::shared_ptr<const octree::Cube> &cube, const std::uint32_t version,
+                                   ByteStreamWriter &writer) {
     if (cube == nullptr) {
         throw std::invalid_argument("Error: Cube cannot be a nullptr");
     }
     switch (version) { // NOLINT
     case 0:
-        return serialize_impl<0>(cube);
+        serialize_impl<0>(*cube, writer);
+        return;
+    case 1:
+        serialize_impl<1>(*cube, writer);
+        return;
+    case 2:
+        serialize_impl<2>(*cube, writer);
+        return;
     default:
         throw std::runtime_error("Error: Unsupported octree version");
     }
@@ -0,0 +1,93 @@
+#include "inexor/vulkan-renderer/octree/serialization/rans_coder.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace inexor::vulkan_renderer::serialization {
+
+RansFrequencyTable::RansFrequencyTable(std::vector<std::uint16_t> frequencies)
+    : m_frequencies(std::move(frequencies)), m_cumulative(m_frequencies.size()),
+      m_slot_symbols(PROBABILITY_SCALE, 0) {
+    std::uint32_t sum = 0;
+    for (std::size_t symbol = 0; symbol < m_frequencies.size(); symbol++) {
+        m_cumulative[symbol] = static_cast<std::uint16_t>(std::min(sum, PROBABILITY_SCALE));
+        sum += m_frequencies[symbol];
+    }
+    if (sum != PROBABILITY_SCALE && sum != 0) {
+        throw std::runtime_error("Error: rANS frequencies do not sum up to the probability scale");
+    }
+    for (std::size_t symbol = 0; symbol < m_frequencies.size(); symbol++) {
+        std::fill_n(m_slot_symbols.begin() + m_cumulative[symbol], m_frequencies[symbol],
+                    static_cast<std::uint16_t>(symbol));
+    }
+}
+
+RansFrequencyTable RansFrequencyTable::from_counts(const std::span<const std::uint64_t> counts) {
+    if (counts.size() > PROBABILITY_SCALE) {
+        throw std::invalid_argument("Error: Too many symbols for the rANS probability scale");
+    }
+    const std::uint64_t total = std::accumulate(counts.begin(), counts.end(), std::uint64_t{0});
+    std::vector<std::uint16_t> frequencies(counts.size(), 0);
+    if (total == 0) {
+        return RansFrequencyTable(std::move(frequencies));
+    }
+    std::int64_t sum = 0;
+    for (std::size_t symbol = 0; symbol < counts.size(); symbol++) {
+        if (counts[symbol] > 0) {
+            frequencies[symbol] = static_cast<std::uint16_t>(
+                std::max<std::uint64_t>(1, counts[symbol] * PROBABILITY_SCALE / total));
+            sum += frequencies[symbol];
+        }
+    }
+    // Rounding leaves a small difference, which is taken from or given to the most frequent symbols, as this changes
+    // their probability the least.
+    auto most_frequent = [&frequencies]() {
+        return static_cast<std::size_t>(std::max_element(frequencies.begin(), frequencies.end()) - frequencies.begin());
+    };
+    if (sum < PROBABILITY_SCALE) {
+        frequencies[most_frequent()] += static_cast<std::uint16_t>(PROBABILITY_SCALE - sum);
+    }
+    while (sum > PROBABILITY_SCALE) {
+        // The most frequent symbol always has a frequency greater than 1 here, because there are fewer symbols than
+        // PROBABILITY_SCALE.
+        frequencies[most_frequent()]--;
+        sum--;
+    }
+    return RansFrequencyTable(std::move(frequencies));
+}
+
+std::vector<std::uint8_t> rans_encode(const std::span<const std::uint16_t> symbols, const RansFrequencyTable &table) {
+    constexpr std::uint32_t LOWER_BOUND{1u << 23};
+    std::vector<std::uint8_t> bytes;
+    bytes.reserve(symbols.size() / 2 + 4);
+
+    // rANS is last in first out, so the symbols are encoded backwards and the bytes are reversed at the end.
+    std::uint32_t state = LOWER_BOUND;
+    for (auto symbol = symbols.rbegin(); symbol != symbols.rend(); symbol++) {
+        const std::uint32_t frequency = table.frequency(*symbol);
+        const std::uint32_t upper_bound = ((LOWER_BOUND >> RansFrequencyTable::PROBABILITY_BITS) << 8u) * frequency;
+        while (state >= upper_bound) {
+            bytes.push_back(static_cast<std::uint8_t>(state));
+            state >>= 8u;
+        }
+        state = ((state / frequency) << RansFrequencyTable::PROBABILITY_BITS) + (state % frequency) +
+                table.cumulative(*symbol);
+    }
+    for (std::uint32_t shift = 32; shift > 0; shift -= 8) {
+        bytes.push_back(static_cast<std::uint8_t>(state >> (shift - 8)));
+    }
+    std::reverse(bytes.begin(), bytes.end());
+    return bytes;
+}
+
+RansDecoder::RansDecoder(const RansFrequencyTable &table, const std::span<const std::uint8_t> data)
+    : m_table(table), m_iter(data.data()), m_end(data.data() + data.size()) {
+    if (data.size() < 4) {
+        throw std::runtime_error("Error: rANS stream is too short");
+    }
+    m_state = (m_iter[0] << 0u) | (m_iter[1] << 8u) | (m_iter[2] << 16u) | (m_iter[3] << 24u);
+    m_iter += 4;
+}
+
+} // namespace inexor::vulkan_renderer::serialization
@@ -0,0 +1,364 @@
+#include "inexor/vulkan-renderer/octree/shape_query.hpp"
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+#include "inexor/vulkan-renderer/octree/cube_triangles.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace inexor::vulkan_renderer::octree {
+
+namespace {
+
+using detail::AXIS_BITS;
+using Box = std::array<glm::vec3, 2>;
+using NormalCubeTriangles = std::array<Polygon, Cube::EDGES>;
+
+/// Visit all geometry cubes whose bounding box overlaps or touches a box. The children of an octant which overlap the
+/// box are selected from the halves of the octant it overlaps on every axis, so the other children are never fetched.
+/// @param cube The cube to start at, which must overlap the box
+/// @param bounds The box
+/// @param visitor Called with every Type::SOLID and Type::NORMAL cube
+template <typename Visitor>
+void visit_geometry(const Cube &cube, const Box &bounds, Visitor &visitor) {
+    switch (cube.type()) {
+    case Cube::Type::SOLID:
+    case Cube::Type::NORMAL:
+        visitor(cube);
+        break;
+    case Cube::Type::OCTANT: {
+        const glm::vec3 middle = cube.center();
+        // The axis bits of the children which overlap the box go from those of first to those of last.
+        std::uint8_t first = 0;
+        std::uint8_t last = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            if (bounds[0][axis] > middle[axis]) {
+                first |= AXIS_BITS[axis];
+            }
+            if (bounds[1][axis] >= middle[axis]) {
+                last |= AXIS_BITS[axis];
+            }
+        }
+        for (std::uint8_t child = 0; child < Cube::SUB_CUBES; child++) {
+            if ((child & first) == first && (child | last) == last) {
+                visit_geometry(*cube.children()[child], bounds, visitor);
+            }
+        }
+        break;
+    }
+    case Cube::Type::EMPTY:
+        break;
+    }
+}
+
+/// Visit all geometry cubes of an octree whose bounding box overlaps or touches a box.
+/// @param root The root of the octree
+/// @param bounds The box
+/// @param visitor Called with every Type::SOLID and Type::NORMAL cube
+template <typename Visitor>
+void visit_geometry_in(const Cube &root, const Box &bounds, Visitor &visitor) {
+    const Box box = root.bounding_box();
+    for (int axis = 0; axis < 3; axis++) {
+        if (box[1][axis] < bounds[0][axis] || bounds[1][axis] < box[0][axis]) {
+            return;
+        }
+    }
+    visit_geometry(root, bounds, visitor);
+}
+
+/// The triangles of a Type::NORMAL cube.
+NormalCubeTriangles normal_cube_triangles(const Cube &cube) {
+    const auto indentations = cube.indentations();
+    NormalCubeTriangles triangles;
+    detail::for_each_normal_cube_triangle(
+        Cube::vertices(Cube::Type::NORMAL, cube.position(), cube.size(), indentations), indentations,
+        [&](const std::size_t triangle, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+            triangles[triangle] = {a, b, c};
+        });
+    return triangles;
+}
+
+/// The normal of a triangle of a cube, pointing out of the cube. The triangles of cubes are wound such that the
+/// cross product of their edges points into the cube. Degenerated triangles have a zero normal.
+glm::vec3 outward_normal(const Polygon &triangle) {
+    const glm::vec3 normal = glm::cross(triangle[2] - triangle[0], triangle[1] - triangle[0]);
+    const float length = glm::length(normal);
+    return length > 0.0f ? normal / length : glm::vec3(0.0f);
+}
+
+/// The point of a triangle which is closest to a point.
+/// @see Ericson, C. (2004) Real-Time Collision Detection, section 5.1.5.
+glm::vec3 closest_point_on_triangle(const glm::vec3 &point, const Polygon &triangle) {
+    const glm::vec3 &a = triangle[0];
+    const glm::vec3 &b = triangle[1];
+    const glm::vec3 &c = triangle[2];
+    const glm::vec3 ab = b - a;
+    const glm::vec3 ac = c - a;
+    const glm::vec3 ap = point - a;
+    const float d1 = glm::dot(ab, ap);
+    const float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        return a;
+    }
+    const glm::vec3 bp = point - b;
+    const float d3 = glm::dot(ab, bp);
+    const float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        return b;
+    }
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        return a + (d1 / (d1 - d3)) * ab;
+    }
+    const glm::vec3 cp = point - c;
+    const float d5 = glm::dot(ab, cp);
+    const float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        return c;
+    }
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        return a + (d2 / (d2 - d6)) * ac;
+    }
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        return b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b);
+    }
+    const float denominator = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+/// Whether a point is inside of the geometry of a Type::NORMAL cube, which is the case if a ray from the point crosses
+/// its triangles an odd number of times.
+bool inside_normal_cube(const glm::vec3 &point, const NormalCubeTriangles &triangles) {
+    // A direction which is not parallel to any edge or side of the cube, so the ray does not run along them.
+    const glm::vec3 DIRECTION{0.8017f, 0.5165f, 0.3009f};
+    bool inside = false;
+    for (const auto &triangle : triangles) {
+        const glm::vec3 edge1 = triangle[1] - triangle[0];
+        const glm::vec3 edge2 = triangle[2] - triangle[0];
+        const glm::vec3 p = glm::cross(DIRECTION, edge2);
+        const float determinant = glm::dot(edge1, p);
+        if (determinant == 0.0f) {
+            continue;
+        }
+        const glm::vec3 s = point - triangle[0];
+        const float u = glm::dot(s, p) / determinant;
+        const glm::vec3 q = glm::cross(s, edge1);
+        const float v = glm::dot(DIRECTION, q) / determinant;
+        const float t = glm::dot(edge2, q) / determinant;
+        if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > 0.0f) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+/// The face of a box which is closest to a point inside of the box.
+/// @param point The point
+/// @param box The box
+/// @param distance Receives the distance of the point to the face
+/// @return The outward normal of the face
+glm::vec3 closest_box_face(const glm::vec3 &point, const Box &box, float &distance) {
+    glm::vec3 normal{0.0f};
+    distance = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; axis++) {
+        const float lower = point[axis] - box[0][axis];
+        const float upper = box[1][axis] - point[axis];
+        if (lower < distance) {
+            distance = lower;
+            normal = glm::vec3(0.0f);
+            normal[axis] = -1.0f;
+        }
+        if (upper < distance) {
+            distance = upper;
+            normal = glm::vec3(0.0f);
+            normal[axis] = 1.0f;
+        }
+    }
+    return normal;
+}
+
+/// Append a contact to the contacts which fit into the span.
+void add_contact(const ShapeContact &contact, const std::span<ShapeContact> contacts, std::size_t &count) {
+    if (count < contacts.size()) {
+        contacts[count] = contact;
+    }
+    count++;
+}
+
+/// The geometry which limits how far a moving sphere can advance.
+struct ApproachedGeometry {
+    const Cube *cube{nullptr};
+    glm::vec3 point{0.0f};
+    glm::vec3 normal{0.0f};
+};
+
+} // namespace
+
+std::size_t ShapeQuery::overlap_box(const std::array<glm::vec3, 2> &box, const std::span<ShapeContact> contacts) const {
+    std::size_t count = 0;
+    auto visitor = [&](const Cube &cube) {
+        Box geometry = cube.bounding_box();
+        if (cube.type() == Cube::Type::NORMAL) {
+            const auto vertices = Cube::vertices(Cube::Type::NORMAL, cube.position(), cube.size(), cube.indentations());
+            geometry = {vertices[0], vertices[0]};
+            for (const auto &vertex : vertices) {
+                geometry[0] = glm::min(geometry[0], vertex);
+                geometry[1] = glm::max(geometry[1], vertex);
+            }
+        }
+        ShapeContact contact;
+        contact.cube = &cube;
+        contact.depth = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; axis++) {
+            if (geometry[1][axis] <= box[0][axis] || box[1][axis] <= geometry[0][axis]) {
+                return;
+            }
+            contact.point[axis] =
+                0.5f * (std::max(geometry[0][axis], box[0][axis]) + std::min(geometry[1][axis], box[1][axis]));
+            // The box can either be pushed to the upper or to the lower side of the geometry.
+            const float upper = geometry[1][axis] - box[0][axis];
+            const float lower = box[1][axis] - geometry[0][axis];
+            if (std::min(upper, lower) < contact.depth) {
+                contact.depth = std::min(upper, lower);
+                contact.normal = glm::vec3(0.0f);
+                contact.normal[axis] = upper < lower ? 1.0f : -1.0f;
+            }
+        }
+        add_contact(contact, contacts, count);
+    };
+    visit_geometry_in(*m_root, box, visitor);
+    return count;
+}
+
+std::size_t ShapeQuery::overlap_sphere(const glm::vec3 &center, const float radius,
+                                       const std::span<ShapeContact> contacts) const {
+    std::size_t count = 0;
+    auto visitor = [&](const Cube &cube) {
+        ShapeContact contact;
+        contact.cube = &cube;
+        if (cube.type() == Cube::Type::SOLID) {
+            const Box box = cube.bounding_box();
+            contact.point = glm::clamp(center, box[0], box[1]);
+            const float distance = glm::length(center - contact.point);
+            if (distance > 0.0f) {
+                if (distance >= radius) {
+                    return;
+                }
+                contact.normal = (center - contact.point) / distance;
+                contact.depth = radius - distance;
+            } else {
+                // The center is inside of the box, so the sphere is pushed out through the closest face.
+                float face_distance = 0.0f;
+                contact.normal = closest_box_face(center, box, face_distance);
+                contact.point = center + contact.normal * face_distance;
+                contact.depth = radius + face_distance;
+            }
+            add_contact(contact, contacts, count);
+            return;
+        }
+
+        const auto triangles = normal_cube_triangles(cube);
+        float distance = std::numeric_limits<float>::max();
+        const Polygon *closest_triangle = nullptr;
+        for (const auto &triangle : triangles) {
+            const glm::vec3 point = closest_point_on_triangle(center, triangle);
+            const float triangle_distance = glm::length(center - point);
+            if (triangle_distance < distance) {
+                distance = triangle_distance;
+                contact.point = point;
+                closest_triangle = &triangle;
+            }
+        }
+        const bool inside = inside_normal_cube(center, triangles);
+        if (!inside && distance >= radius) {
+            return;
+        }
+        if (distance > 0.0f) {
+            contact.normal = (inside ? contact.point - center : center - contact.point) / distance;
+        } else {
+            contact.normal = outward_normal(*closest_triangle);
+        }
+        contact.depth = inside ? radius + distance : radius - distance;
+        add_contact(contact, contacts, count);
+    };
+    visit_geometry_in(*m_root, {center - radius, center + radius}, visitor);
+    return count;
+}
+
+std::optional<SweepHit> ShapeQuery::sweep_sphere(const glm::vec3 &center, const float radius,
+                                                 const glm::vec3 &motion) const {
+    const float length = glm::length(motion);
+    if (length == 0.0f) {
+        return std::nullopt;
+    }
+    const glm::vec3 direction = motion / length;
+
+    // Conservative advancement: every triangle and box is convex, so the distance of the sphere to one of them shrinks
+    // at most as fast as the sphere moves towards its closest point. The sphere can therefore move by the gap to each
+    // piece of geometry divided by that speed without touching any of them, which reaches planes in a single step.
+    // The sphere stops SWEEP_TOLERANCE before the geometry, which keeps a sphere that slides along a floor after a hit
+    // from being caught on the edges between the cubes of the floor.
+    float travelled = 0.0f;
+    ApproachedGeometry closest;
+    for (std::uint32_t step = 0; step < MAX_SWEEP_STEPS; step++) {
+        const glm::vec3 position = center + travelled * direction;
+        const float remaining = length - travelled;
+        const float search_radius = radius + remaining;
+        closest = ApproachedGeometry{};
+        float advance = remaining;
+
+        // The sphere can not get closer to geometry whose closest point it does not move towards.
+        auto approach = [&](const Cube &cube, const glm::vec3 &point, const glm::vec3 &normal, const float distance) {
+            const float speed = -glm::dot(normal, direction);
+            if (speed > 0.0f && (distance - radius) / speed < advance) {
+                advance = std::max((distance - radius) / speed, 0.0f);
+                closest = ApproachedGeometry{&cube, point, normal};
+            }
+        };
+        auto visitor = [&](const Cube &cube) {
+            if (cube.type() == Cube::Type::SOLID) {
+                const Box box = cube.bounding_box();
+                const glm::vec3 point = glm::clamp(position, box[0], box[1]);
+                const float distance = glm::length(position - point);
+                if (distance > 0.0f) {
+                    approach(cube, point, (position - point) / distance, distance);
+                } else {
+                    float face_distance = 0.0f;
+                    const glm::vec3 normal = closest_box_face(position, box, face_distance);
+                    approach(cube, position + normal * face_distance, normal, 0.0f);
+                }
+                return;
+            }
+            for (const auto &triangle : normal_cube_triangles(cube)) {
+                const glm::vec3 point = closest_point_on_triangle(position, triangle);
+                const float distance = glm::length(position - point);
+                approach(cube, point, distance > 0.0f ? (position - point) / distance : outward_normal(triangle),
+                         distance);
+            }
+        };
+        visit_geometry_in(*m_root, {position - search_radius, position + search_radius}, visitor);
+
+        if (closest.cube == nullptr) {
+            return std::nullopt;
+        }
+        if (advance <= SWEEP_TOLERANCE) {
+            break;
+        }
+        travelled += advance - SWEEP_TOLERANCE;
+    }
+    // If the sphere has not reached the geometry after the maximum number of steps, it stops where it is, which is
+    // always in front of the geometry.
+    SweepHit hit;
+    hit.cube = closest.cube;
+    hit.t = travelled / length;
+    hit.point = closest.point;
+    hit.normal = closest.normal;
+    return hit;
+}
+
+} // namespace inexor::vulkan_renderer::octree
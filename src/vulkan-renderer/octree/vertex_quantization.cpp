@@ -0,0 +1,66 @@
+#include "inexor/vulkan-renderer/octree/vertex_quantization.hpp"
+
+#include "inexor/vulkan-renderer/octree/cube.hpp"
+#include "inexor/vulkan-renderer/octree/indentation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace inexor::vulkan_renderer::octree {
+
+namespace {
+
+/// The size of the smallest geometry cube, or the size of the cube itself if it has no geometry.
+float smallest_geometry_cube_size(const Cube &cube) {
+    if (cube.type() != Cube::Type::OCTANT) {
+        return cube.size();
+    }
+    float size = cube.size();
+    for (const auto &child : cube.children()) {
+        size = std::min(size, smallest_geometry_cube_size(*child));
+    }
+    return size;
+}
+
+} // namespace
+
+QuantizationGrid::QuantizationGrid(const glm::vec3 &origin, const float step) : m_origin(origin), m_step(step) {
+    if (!(step > 0.0f)) {
+        throw std::invalid_argument("Error: Quantization step must be greater than 0");
+    }
+}
+
+QuantizationGrid QuantizationGrid::from_octree(const Cube &cube) {
+    return {cube.position(), smallest_geometry_cube_size(cube) / Indentation::MAX};
+}
+
+glm::vec3 QuantizationGrid::dequantize(const std::array<std::uint16_t, 3> &coordinates) const noexcept {
+    return {m_origin.x + static_cast<float>(coordinates[0]) * m_step,
+            m_origin.y + static_cast<float>(coordinates[1]) * m_step,
+            m_origin.z + static_cast<float>(coordinates[2]) * m_step};
+}
+
+bool QuantizationGrid::fits(const glm::vec3 &min, const glm::vec3 &max) const noexcept {
+    const float range = static_cast<float>(MAX_COORDINATE) * m_step;
+    for (int axis = 0; axis < 3; axis++) {
+        if (min[axis] < m_origin[axis] || max[axis] > m_origin[axis] + range) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::array<std::uint16_t, 3> QuantizationGrid::quantize(const glm::vec3 &position) const {
+    std::array<std::uint16_t, 3> coordinates{};
+    for (int axis = 0; axis < 3; axis++) {
+        const float coordinate = std::round((position[axis] - m_origin[axis]) / m_step);
+        if (!(coordinate >= 0.0f && coordinate <= static_cast<float>(MAX_COORDINATE))) {
+            throw std::out_of_range("Error: Position is outside of the quantization grid");
+        }
+        coordinates[static_cast<std::size_t>(axis)] = static_cast<std::uint16_t>(coordinate);
+    }
+    return coordinates;
+}
+
+} // namespace inexor::vulkan_renderer::octree
@@ -0,0 +1,299 @@
+#include "inexor/vulkan-renderer/octree/world_editor.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace inexor::vulkan_renderer::octree {
+
+namespace {
+
+/// The number of levels of octants below a cube, 0 for a leaf.
+std::size_t subtree_depth(const Cube &cube) {
+    if (cube.type() != Cube::Type::OCTANT) {
+        return 0;
+    }
+    std::size_t depth = 0;
+    for (const auto &child : cube.children()) {
+        depth = std::max(depth, subtree_depth(*child));
+    }
+    return depth + 1;
+}
+
+} // namespace
+
+WorldEditor::WorldEditor(std::shared_ptr<Cube> world, const std::size_t journal_budget)
+    : m_world(std::move(world)), m_journal_budget(journal_budget) {
+    if (!m_world) {
+        throw std::invalid_argument("Error: The world of the editor is nullptr!");
+    }
+    if (!m_world->is_root()) {
+        throw std::invalid_argument("Error: The world of the editor must be the root of its octree!");
+    }
+}
+
+EditStatistics WorldEditor::apply(const std::span<const CubeEdit> edits) {
+    EditRecord record;
+    record.codes.reserve(edits.size());
+    record.types.reserve(edits.size());
+    for (const auto &edit : edits) {
+        if (edit.type == Cube::Type::OCTANT) {
+            throw std::invalid_argument("Error: Cube edits must not create octants, use WorldEditor::paste instead!");
+        }
+        record.codes.push_back(edit.code);
+        record.types.push_back(edit.type);
+        if (edit.type == Cube::Type::NORMAL) {
+            for (const auto &indentation : edit.indentations) {
+                record.indentations.push_back(indentation.uid());
+            }
+        }
+    }
+    EditStatistics statistics;
+    if (record.codes.empty()) {
+        return statistics;
+    }
+    push_undo(write(record, true, statistics));
+    statistics.journal_bytes = m_undo.empty() ? 0 : m_undo.back().memory_usage();
+    return statistics;
+}
+
+void WorldEditor::encode(const Cube &cube, EditRecord &record) {
+    record.types.push_back(cube.m_type);
+    if (cube.m_type == Cube::Type::NORMAL) {
+        for (const auto &indentation : cube.m_indentations) {
+            record.indentations.push_back(indentation.uid());
+        }
+    } else if (cube.m_type == Cube::Type::OCTANT) {
+        for (const auto &child : cube.m_children) {
+            encode(*child, record);
+        }
+    }
+}
+
+EditStatistics WorldEditor::fill(const std::array<glm::vec3, 2> &box, const std::size_t level, const Cube::Type type) {
+    if (type != Cube::Type::EMPTY && type != Cube::Type::SOLID) {
+        throw std::invalid_argument("Error: Only empty and solid cubes can be filled!");
+    }
+    if (level > LocationalCode::MAX_LEVEL) {
+        throw std::invalid_argument("Error: The fill level exceeds LocationalCode::MAX_LEVEL!");
+    }
+    std::vector<CubeEdit> edits;
+    // The cubes are visited by their codes, as they do not need to exist yet. The existing cube is the cube of the code
+    // if it exists, otherwise the leaf which contains it.
+    std::function<void(const LocationalCode &, const Cube &, const glm::vec3 &, float)> collect =
+        [&](const LocationalCode &code, const Cube &existing, const glm::vec3 &min, const float size) {
+            const glm::vec3 max = min + size;
+            if (max.x <= box[0].x || max.y <= box[0].y || max.z <= box[0].z || min.x >= box[1].x ||
+                min.y >= box[1].y || min.z >= box[1].z) {
+                return;
+            }
+            if (existing.m_type == type) {
+                // The cube is already filled.
+                return;
+            }
+            const bool inside = box[0].x <= min.x && box[0].y <= min.y && box[0].z <= min.z && max.x <= box[1].x &&
+                                max.y <= box[1].y && max.z <= box[1].z;
+            if (inside) {
+                edits.push_back({code, type});
+                return;
+            }
+            if (code.level() == level) {
+                const glm::vec3 center = min + 0.5f * size;
+                if (box[0].x <= center.x && box[0].y <= center.y && box[0].z <= center.z && center.x < box[1].x &&
+                    center.y < box[1].y && center.z < box[1].z) {
+                    edits.push_back({code, type});
+                }
+                return;
+            }
+            const float half_size = 0.5f * size;
+            const bool descend = existing.m_type == Cube::Type::OCTANT && existing.m_code == code;
+            for (std::uint8_t idx = 0; idx < Cube::SUB_CUBES; idx++) {
+                const glm::vec3 offset(static_cast<float>((idx >> 2) & 1u), static_cast<float>((idx >> 1) & 1u),
+                                       static_cast<float>(idx & 1u));
+                collect(code.child(idx), descend ? *existing.m_children[idx] : existing, min + offset * half_size,
+                        half_size);
+            }
+        };
+    collect(m_world->m_code, *m_world, m_world->m_position, m_world->m_size);
+    return apply(edits);
+}
+
+EditStatistics WorldEditor::paste(const Cube &source, const LocationalCode &target) {
+    // This must be checked before anything is written, as a half pasted subtree could not be undone.
+    if (target.level() + subtree_depth(source) > LocationalCode::MAX_LEVEL) {
+        throw std::invalid_argument("Error: The pasted cube would exceed LocationalCode::MAX_LEVEL!");
+    }
+    EditRecord record;
+    record.codes.push_back(target);
+    encode(source, record);
+    EditStatistics statistics;
+    push_undo(write(record, true, statistics));
+    statistics.journal_bytes = m_undo.empty() ? 0 : m_undo.back().memory_usage();
+    return statistics;
+}
+
+void WorldEditor::push_undo(EditRecord record) {
+    for (const auto &redo : m_redo) {
+        m_journal_usage -= redo.memory_usage();
+    }
+    m_redo.clear();
+    m_journal_usage += record.memory_usage();
+    m_undo.push_back(std::move(record));
+    trim_journal();
+}
+
+void WorldEditor::trim_journal() {
+    while (!m_undo.empty() && m_journal_usage > m_journal_budget) {
+        m_journal_usage -= m_undo.front().memory_usage();
+        m_undo.pop_front();
+    }
+    // The redo journal is only trimmed if it exceeds the budget on its own. Its first record is the last one to redo.
+    while (!m_redo.empty() && m_journal_usage > m_journal_budget) {
+        m_journal_usage -= m_redo.front().memory_usage();
+        m_redo.erase(m_redo.begin());
+    }
+}
+
+EditStatistics WorldEditor::redo() {
+    EditStatistics statistics;
+    if (m_redo.empty()) {
+        return statistics;
+    }
+    EditRecord record = std::move(m_redo.back());
+    m_redo.pop_back();
+    m_journal_usage -= record.memory_usage();
+    EditRecord reverse = write(record, false, statistics);
+    statistics.journal_bytes = reverse.memory_usage();
+    m_journal_usage += statistics.journal_bytes;
+    m_undo.push_back(std::move(reverse));
+    // The reverse of a batch can be larger than the batch, e.g. when redoing a fill which replaced detailed geometry.
+    trim_journal();
+    return statistics;
+}
+
+EditStatistics WorldEditor::undo() {
+    EditStatistics statistics;
+    if (m_undo.empty()) {
+        return statistics;
+    }
+    EditRecord record = std::move(m_undo.back());
+    m_undo.pop_back();
+    m_journal_usage -= record.memory_usage();
+    EditRecord reverse = write(record, false, statistics);
+    statistics.journal_bytes = reverse.memory_usage();
+    m_journal_usage += statistics.journal_bytes;
+    m_redo.push_back(std::move(reverse));
+    // The reverse of a batch can be larger than the batch, e.g. when undoing a paste of detailed geometry.
+    trim_journal();
+    return statistics;
+}
+
+WorldEditor::EditRecord WorldEditor::write(const EditRecord &record, const bool collapse, EditStatistics &statistics) {
+    // The previous content of every changed subtree, in the order in which they have been changed.
+    EditRecord previous;
+    std::vector<std::array<std::size_t, 2>> previous_offsets;
+    auto save = [&](const Cube &cube) {
+        previous.codes.push_back(cube.m_code);
+        previous_offsets.push_back({previous.types.size(), previous.indentations.size()});
+        encode(cube, previous);
+    };
+    auto is_uniform = [](const Cube &cube) {
+        const Cube::Type type = cube.m_children[0]->m_type;
+        return (type == Cube::Type::EMPTY || type == Cube::Type::SOLID) &&
+               std::all_of(cube.m_children.begin(), cube.m_children.end(),
+                           [&](const auto &child) { return child->m_type == type; });
+    };
+
+    std::size_t next_type = 0;
+    std::size_t next_indentation = 0;
+    std::function<void(Cube &)> decode = [&](Cube &cube) {
+        const Cube::Type type = record.types[next_type++];
+        cube.change_type(type);
+        cube.m_polygon_cache_valid = false;
+        statistics.written_cubes++;
+        if (type == Cube::Type::NORMAL) {
+            for (auto &indentation : cube.m_indentations) {
+                indentation = Indentation(record.indentations[next_indentation++]);
+            }
+        } else if (type == Cube::Type::OCTANT) {
+            for (const auto &child : cube.m_children) {
+                decode(*child);
+            }
+            // The previous content of the subtree has been saved as a whole, so this does not need to be journaled.
+            if (collapse && is_uniform(cube)) {
+                cube.change_type(cube.m_children[0]->m_type);
+                statistics.collapsed_octants++;
+            }
+        }
+    };
+
+    for (const auto &code : record.codes) {
+        Cube *cube = m_world->find(code);
+        save(*cube);
+        // Subdivide the leaf which contains the code, its other children keep its content as well as possible.
+        while (cube->m_code.level() < code.level()) {
+            const Cube::Type child_type = cube->m_type == Cube::Type::EMPTY ? Cube::Type::EMPTY : Cube::Type::SOLID;
+            cube->change_type(Cube::Type::OCTANT);
+            for (const auto &child : cube->m_children) {
+                child->change_type(child_type);
+            }
+            cube = cube->m_children[code.child_index(cube->m_code.level() + 1)].get();
+        }
+        decode(*cube);
+        statistics.written_subtrees++;
+    }
+
+    if (collapse) {
+        for (const auto &code : record.codes) {
+            // The cube may have been collapsed into one of its parents already.
+            for (Cube *parent = m_world->find(code)->m_parent; parent != nullptr && is_uniform(*parent);
+                 parent = parent->m_parent) {
+                save(*parent);
+                parent->change_type(parent->m_children[0]->m_type);
+                statistics.collapsed_octants++;
+            }
+        }
+    }
+
+    // Mark the topmost changed cubes as edited. Sorting the codes aligned to the deepest level puts every cube right
+    // in front of its descendants.
+    auto aligned = [](const LocationalCode &code) {
+        return std::make_pair(code.value() << (3 * (LocationalCode::MAX_LEVEL - code.level())), code.level());
+    };
+    std::vector<LocationalCode> changed;
+    changed.reserve(previous.codes.size());
+    for (const auto &code : previous.codes) {
+        // Collapsed cubes have been merged into their parent.
+        changed.push_back(m_world->find(code)->m_code);
+    }
+    std::sort(changed.begin(), changed.end(),
+              [&](const auto &lhs, const auto &rhs) { return aligned(lhs) < aligned(rhs); });
+    const LocationalCode *last_marked = nullptr;
+    for (const auto &code : changed) {
+        if (last_marked != nullptr && LocationalCode::common_level(*last_marked, code) == last_marked->level()) {
+            continue;
+        }
+        m_world->find(code)->mark_dirty();
+        statistics.dirty_cubes++;
+        last_marked = &code;
+    }
+
+    // The subtrees have to be restored in reverse order, as a subtree may have been saved after a leaf which contains
+    // it has been subdivided.
+    EditRecord reverse;
+    reverse.codes.assign(previous.codes.rbegin(), previous.codes.rend());
+    reverse.types.reserve(previous.types.size());
+    reverse.indentations.reserve(previous.indentations.size());
+    previous_offsets.push_back({previous.types.size(), previous.indentations.size()});
+    for (std::size_t idx = previous.codes.size(); idx-- > 0;) {
+        const auto &begin = previous_offsets[idx];
+        const auto &end = previous_offsets[idx + 1];
+        reverse.types.insert(reverse.types.end(), previous.types.begin() + begin[0], previous.types.begin() + end[0]);
+        reverse.indentations.insert(reverse.indentations.end(), previous.indentations.begin() + begin[1],
+                                    previous.indentations.begin() + end[1]);
+    }
+    return reverse;
+}
+
+} // namespace inexor::vulkan_renderer::octree
@@ -12,7 +12,7 @@ using wrapper::InexorException;
 
 GraphicsPass::GraphicsPass(
     std::string name, std::function<void(const CommandBuffer &)> on_record_cmd_buffer,
-    std::vector<std::weak_ptr<Buffer>> buffer_reads,
+    std::vector<std::weak_ptr<Buffer>> buffer_reads, std::vector<std::weak_ptr<Buffer>> buffer_writes,
     std::vector<std::pair<std::weak_ptr<Texture>, std::optional<VkClearValue>>> texture_writes,
     std::vector<std::pair<std::weak_ptr<Swapchain>, std::optional<VkClearValue>>> swapchain_writes,
     const wrapper::DebugLabelColor pass_debug_label_color) {
@@ -40,6 +40,8 @@ GraphicsPass::GraphicsPass(
     m_name = std::move(name);
     m_on_record_cmd_buffer = std::move(on_record_cmd_buffer);
     m_debug_label_color = wrapper::get_debug_label_color(pass_debug_label_color);
+    m_buffer_reads = std::move(buffer_reads);
+    m_buffer_writes = std::move(buffer_writes);
     m_texture_writes = std::move(texture_writes);
     m_swapchain_writes = std::move(swapchain_writes);
 }
@@ -51,11 +53,14 @@ GraphicsPass::GraphicsPass(GraphicsPass &&other) noexcept {
     m_descriptor_set_layout = std::exchange(other.m_descriptor_set_layout, nullptr);
     m_descriptor_set = std::exchange(other.m_descriptor_set, VK_NULL_HANDLE);
     m_rendering_info = std::move(other.m_rendering_info);
+    m_buffer_reads = std::move(other.m_buffer_reads);
+    m_buffer_writes = std::move(other.m_buffer_writes);
     m_texture_writes = std::move(other.m_texture_writes);
     m_swapchain_writes = std::move(other.m_swapchain_writes);
     m_color_attachments = std::move(other.m_color_attachments);
     m_depth_attachment = std::move(other.m_depth_attachment);
     m_stencil_attachment = std::move(other.m_stencil_attachment);
+    m_barriers = std::move(other.m_barriers);
     m_debug_label_color = other.m_debug_label_color;
 }
 
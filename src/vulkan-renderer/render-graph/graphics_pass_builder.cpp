@@ -18,12 +18,13 @@ GraphicsPassBuilder::GraphicsPassBuilder(GraphicsPassBuilder &&other) noexcept {
     m_swapchain_writes = std::move(other.m_swapchain_writes);
     m_texture_writes = std::move(other.m_texture_writes);
     m_buffer_reads = std::move(other.m_buffer_reads);
+    m_buffer_writes = std::move(other.m_buffer_writes);
 }
 
 std::shared_ptr<GraphicsPass> GraphicsPassBuilder::build(std::string name, const DebugLabelColor pass_debug_color) {
-    auto graphics_pass =
-        std::make_shared<GraphicsPass>(std::move(name), std::move(m_on_record_cmd_buffer), std::move(m_buffer_reads),
-                                       std::move(m_texture_writes), std::move(m_swapchain_writes), pass_debug_color);
+    auto graphics_pass = std::make_shared<GraphicsPass>(
+        std::move(name), std::move(m_on_record_cmd_buffer), std::move(m_buffer_reads), std::move(m_buffer_writes),
+        std::move(m_texture_writes), std::move(m_swapchain_writes), pass_debug_color);
     // NOTE: We could use RAII here to bind the call of reset() to some destructor call like a scope_guard does.
     reset();
     return graphics_pass;
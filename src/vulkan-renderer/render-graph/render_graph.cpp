@@ -1,11 +1,104 @@
 #include "inexor/vulkan-renderer/render-graph/render_graph.hpp"
 
+#include "inexor/vulkan-renderer/tools/exception.hpp"
+
+#include <spdlog/spdlog.h>
+
 #include <functional>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
 namespace inexor::vulkan_renderer::render_graph {
 
+// Using declaration
+using wrapper::InexorException;
+
+namespace {
+
+/// Lock a resource which is accessed by a graphics pass
+/// @param resource The resource
+/// @param pass_name The name of the graphics pass, which is used in the error message
+/// @param resource_kind The kind of the resource, which is used in the error message
+/// @exception InexorException The resource has already been destroyed
+template <typename T>
+std::shared_ptr<T> lock_pass_resource(const std::weak_ptr<T> &resource, const std::string &pass_name,
+                                      const char *resource_kind) {
+    auto locked = resource.lock();
+    if (!locked) {
+        throw InexorException("Error: Graphics pass " + pass_name + " accesses a " + resource_kind +
+                              " which has already been destroyed!");
+    }
+    return locked;
+}
+
+/// The pipeline stages of a set of resource accesses
+/// @param accesses The resource accesses
+/// @param no_access_stages The pipeline stages if the set is empty
+VkPipelineStageFlags pipeline_stages(const ResourceAccessMask accesses, const VkPipelineStageFlags no_access_stages) {
+    VkPipelineStageFlags stages = 0;
+    if ((accesses & (access_bit(ResourceAccess::VERTEX_BUFFER_READ) | access_bit(ResourceAccess::INDEX_BUFFER_READ))) !=
+        0) {
+        stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    }
+    if ((accesses & (access_bit(ResourceAccess::UNIFORM_BUFFER_READ) | access_bit(ResourceAccess::BUFFER_WRITE))) !=
+        0) {
+        stages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+    if ((accesses & access_bit(ResourceAccess::COLOR_ATTACHMENT_WRITE)) != 0) {
+        stages |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    }
+    if ((accesses & access_bit(ResourceAccess::DEPTH_STENCIL_ATTACHMENT_WRITE)) != 0) {
+        stages |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    }
+    if ((accesses & access_bit(ResourceAccess::PRESENT)) != 0) {
+        stages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    }
+    return stages != 0 ? stages : no_access_stages;
+}
+
+/// The memory accesses of a set of resource accesses
+VkAccessFlags access_flags(const ResourceAccessMask accesses) {
+    VkAccessFlags flags = 0;
+    if ((accesses & access_bit(ResourceAccess::VERTEX_BUFFER_READ)) != 0) {
+        flags |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    }
+    if ((accesses & access_bit(ResourceAccess::INDEX_BUFFER_READ)) != 0) {
+        flags |= VK_ACCESS_INDEX_READ_BIT;
+    }
+    if ((accesses & access_bit(ResourceAccess::UNIFORM_BUFFER_READ)) != 0) {
+        flags |= VK_ACCESS_UNIFORM_READ_BIT;
+    }
+    if ((accesses & access_bit(ResourceAccess::BUFFER_WRITE)) != 0) {
+        flags |= VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    // Attachments are read as well if they are loaded instead of cleared
+    if ((accesses & access_bit(ResourceAccess::COLOR_ATTACHMENT_WRITE)) != 0) {
+        flags |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    }
+    if ((accesses & access_bit(ResourceAccess::DEPTH_STENCIL_ATTACHMENT_WRITE)) != 0) {
+        flags |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    }
+    // Presenting is synchronized with a semaphore, so it needs no memory access
+    return flags;
+}
+
+VkImageLayout vk_image_layout(const ImageLayout layout) {
+    switch (layout) {
+    case ImageLayout::COLOR_ATTACHMENT:
+        return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    case ImageLayout::DEPTH_STENCIL_ATTACHMENT:
+        return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    case ImageLayout::PRESENT:
+        return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    default:
+        return VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+}
+
+} // namespace
+
 RenderGraph::RenderGraph(Device &device, const PipelineCache &pipeline_cache)
     : m_device(device), m_descriptor_set_allocator(device), m_write_descriptor_set_builder(device),
       m_graphics_pipeline_builder(device, pipeline_cache), m_descriptor_set_layout_builder(device) {}
@@ -62,6 +155,84 @@ std::weak_ptr<Texture> RenderGraph::add_texture(std::string name, const TextureU
                                                              channels, sample_count, std::move(on_update)));
 }
 
+RenderGraphCompiler RenderGraph::create_compiler() {
+    m_pass_resources.clear();
+    std::vector<RenderGraphResource> resources;
+    // A resource which is accessed by several passes is described only once
+    std::unordered_map<const void *, std::size_t> resource_indices;
+    auto resource_index = [&](const void *key, PassResource resource, RenderGraphResource description) {
+        const auto [iter, inserted] = resource_indices.try_emplace(key, resources.size());
+        if (inserted) {
+            m_pass_resources.push_back(std::move(resource));
+            resources.push_back(std::move(description));
+        }
+        return iter->second;
+    };
+
+    std::vector<RenderGraphPassNode> passes;
+    passes.reserve(m_graphics_passes.size());
+    for (const auto &pass : m_graphics_passes) {
+        auto &node = passes.emplace_back(RenderGraphPassNode{.name = pass->m_name});
+        // NOTE: Buffers are updated in update_buffers() before the passes are recorded, so only the buffers which are
+        // written by passes cause dependencies between the passes
+        for (const auto &buffer_read : pass->m_buffer_reads) {
+            const auto buffer = lock_pass_resource(buffer_read, pass->m_name, "buffer");
+            const auto access = [&]() {
+                switch (buffer->m_buffer_type) {
+                case BufferType::VERTEX_BUFFER:
+                    return ResourceAccess::VERTEX_BUFFER_READ;
+                case BufferType::INDEX_BUFFER:
+                    return ResourceAccess::INDEX_BUFFER_READ;
+                default:
+                    return ResourceAccess::UNIFORM_BUFFER_READ;
+                }
+            }();
+            node.uses.push_back({resource_index(buffer.get(), buffer_read, {.name = buffer->m_name}), access});
+        }
+        for (const auto &buffer_write : pass->m_buffer_writes) {
+            const auto buffer = lock_pass_resource(buffer_write, pass->m_name, "buffer");
+            node.uses.push_back(
+                {resource_index(buffer.get(), buffer_write, {.name = buffer->m_name}), ResourceAccess::BUFFER_WRITE});
+        }
+        for (const auto &texture_write : pass->m_texture_writes) {
+            const auto texture = lock_pass_resource(texture_write.first, pass->m_name, "texture");
+            if (texture->usage() == TextureUsage::DEFAULT) {
+                // The texture is no attachment, see fill_graphics_pass_rendering_info
+                continue;
+            }
+            const bool color = texture->usage() == TextureUsage::COLOR_ATTACHMENT;
+            // Color and depth attachments are transitioned into their layout when they are created. The textures are
+            // read through descriptors which are not known to rendergraph, so the passes writing them are never culled.
+            const RenderGraphResource description{
+                .name = texture->name(),
+                .type = ResourceType::IMAGE,
+                .initial_layout = color ? ImageLayout::COLOR_ATTACHMENT
+                                  : texture->usage() == TextureUsage::DEPTH_ATTACHMENT
+                                      ? ImageLayout::DEPTH_STENCIL_ATTACHMENT
+                                      : ImageLayout::UNDEFINED,
+                .external = true,
+            };
+            node.uses.push_back({resource_index(texture.get(), texture_write.first, description),
+                                 color ? ResourceAccess::COLOR_ATTACHMENT_WRITE
+                                       : ResourceAccess::DEPTH_STENCIL_ATTACHMENT_WRITE});
+        }
+        for (const auto &swapchain_write : pass->m_swapchain_writes) {
+            const auto swapchain = lock_pass_resource(swapchain_write.first, pass->m_name, "swapchain");
+            // Swapchain images come back in undefined layout after presenting
+            const RenderGraphResource description{
+                .name = "Swapchain",
+                .type = ResourceType::IMAGE,
+                .initial_layout = ImageLayout::UNDEFINED,
+                .presented = true,
+                .external = true,
+            };
+            node.uses.push_back({resource_index(swapchain.get(), swapchain_write.first, description),
+                                 ResourceAccess::COLOR_ATTACHMENT_WRITE});
+        }
+    }
+    return RenderGraphCompiler(std::move(resources), std::move(passes));
+}
+
 void RenderGraph::create_descriptor_set_layouts() {
     for (const auto &descriptor : m_resource_descriptors) {
         std::invoke(std::get<0>(descriptor), m_descriptor_set_layout_builder);
@@ -75,7 +246,7 @@ void RenderGraph::create_graphics_pipelines() {
 }
 
 void RenderGraph::check_for_cycles() {
-    // @TODO Implement!
+    create_compiler().check_for_cycles();
 }
 
 void RenderGraph::compile() {
@@ -190,14 +361,9 @@ void RenderGraph::record_command_buffer_for_pass(const CommandBuffer &cmd_buf, G
     // Fill the VKRenderingInfo of the graphics pass
     fill_graphics_pass_rendering_info(pass);
 
-    // If there are writes to swapchains, the image layout of the swapchain must be changed because it comes back in
-    // undefined layout after presenting
-    for (const auto &swapchain : pass.m_swapchain_writes) {
-        // NOTE: We don't need to check if the previous pass wrote to this swapchain because we already check in the
-        // code below if the next pass (if any) will write to this swapchain again, so if the last pass already wrote to
-        // this swapchain, calling change_image_layout_to_prepare_for_rendering will not do anything.
-        swapchain.first.lock()->change_image_layout_to_prepare_for_rendering(cmd_buf);
-    }
+    // Wait for the previous passes and change the image layouts, e.g. of swapchain images which come back in undefined
+    // layout after presenting
+    record_barriers(cmd_buf, pass.m_barriers);
 
     // Start dynamic rendering with the compiled rendering info
     cmd_buf.begin_rendering(pass.m_rendering_info);
@@ -212,18 +378,6 @@ void RenderGraph::record_command_buffer_for_pass(const CommandBuffer &cmd_buf, G
     // End dynamic rendering
     cmd_buf.end_rendering();
 
-    // TODO: Not only check for next pass, but check all following passes! For example if pass A writes to swapchain,
-    // pass B doesn't, but pass C does again, we would unnecessarily transition between A and B, then B and C, and after
-    // C again!
-
-    // Change the swapchain image layouts to prepare the swapchains for presenting
-    for (const auto &swapchain : pass.m_swapchain_writes) {
-        // TODO: Check if next pass (if any) writes to that swapchain as well!
-        // If the next pass writes to this swapchain as well, we can keep it in the current image layout.
-        // Only otherwise, we change the image layout to prepare the swapchain image for presenting.
-        // @TODO Compare the underlying VkSwapchainKHR pointers?
-        swapchain.first.lock()->change_image_layout_to_prepare_for_presenting(cmd_buf);
-    }
     // End the debug label for this graphics pass
     cmd_buf.end_debug_label_region();
 }
@@ -238,32 +392,102 @@ void RenderGraph::render() {
     m_device.execute(
         "RenderGraph::render()", VK_QUEUE_GRAPHICS_BIT, DebugLabelColor::CYAN,
         [&](const CommandBuffer &cmd_buf) {
-            // Call the command buffer recording function of every graphics pass
-            for (const auto &pass : m_graphics_passes) {
-                record_command_buffer_for_pass(cmd_buf, *pass);
+            // Call the command buffer recording function of every graphics pass which has not been culled
+            for (const std::size_t pass : m_pass_order) {
+                record_command_buffer_for_pass(cmd_buf, *m_graphics_passes[pass]);
             }
+            // Prepare the swapchain images for presenting
+            record_barriers(cmd_buf, m_final_barriers);
         },
         m_swapchains_imgs_available);
 
-    // @TODO We should store the swapchains in a vector during swapchain compilation though!
-    for (const auto &pass : m_graphics_passes) {
-        for (const auto &swapchain : pass->m_swapchain_writes) {
-            swapchain.first.lock()->present();
+    // Every swapchain is presented once, even if several passes write to it
+    for (const auto &resource : m_pass_resources) {
+        if (const auto *swapchain = std::get_if<std::weak_ptr<Swapchain>>(&resource)) {
+            swapchain->lock()->present();
         }
     }
     // @TODO I am terrible, remove me instantly!
     m_device.wait_idle();
 }
 
+void RenderGraph::record_barriers(const CommandBuffer &cmd_buf, const std::span<const ResourceBarrier> barriers) {
+    if (barriers.empty()) {
+        return;
+    }
+    VkPipelineStageFlags src_stage_flags = 0;
+    VkPipelineStageFlags dst_stage_flags = 0;
+    std::vector<VkImageMemoryBarrier> img_mem_barriers;
+    img_mem_barriers.reserve(barriers.size());
+    // NOTE: The barriers of all buffers are merged into one global memory barrier
+    auto mem_barrier = wrapper::make_info<VkMemoryBarrier>();
+    for (const auto &barrier : barriers) {
+        // NOTE: Images which have not been accessed in this frame only wait for the swapchain image to be acquired
+        src_stage_flags |= pipeline_stages(barrier.src_access, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        dst_stage_flags |= pipeline_stages(barrier.dst_access, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        const auto &resource = m_pass_resources[barrier.resource];
+        if (std::holds_alternative<std::weak_ptr<Buffer>>(resource)) {
+            mem_barrier.srcAccessMask |= access_flags(barrier.src_access);
+            mem_barrier.dstAccessMask |= access_flags(barrier.dst_access);
+            continue;
+        }
+        VkImage img = VK_NULL_HANDLE;
+        VkImageSubresourceRange subres_range{
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        };
+        if (const auto *texture = std::get_if<std::weak_ptr<Texture>>(&resource)) {
+            const auto &image = *texture->lock()->m_image;
+            img = image.m_img;
+            subres_range = image.m_img_view_ci.subresourceRange;
+        } else {
+            img = std::get<std::weak_ptr<Swapchain>>(resource).lock()->current_swapchain_image();
+        }
+        img_mem_barriers.push_back(wrapper::make_info<VkImageMemoryBarrier>({
+            .srcAccessMask = access_flags(barrier.src_access),
+            .dstAccessMask = access_flags(barrier.dst_access),
+            .oldLayout = vk_image_layout(barrier.old_layout),
+            .newLayout = vk_image_layout(barrier.new_layout),
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = img,
+            .subresourceRange = subres_range,
+        }));
+    }
+    const bool any_buffer_barrier = mem_barrier.srcAccessMask != 0 || mem_barrier.dstAccessMask != 0;
+    cmd_buf.pipeline_barrier(src_stage_flags, dst_stage_flags, img_mem_barriers,
+                             {&mem_barrier, any_buffer_barrier ? std::size_t{1} : std::size_t{0}});
+}
+
 void RenderGraph::reset() {
     m_buffers.clear();
     m_textures.clear();
     m_graphics_passes.clear();
+    m_pass_order.clear();
     m_resource_descriptors.clear();
+    m_pass_resources.clear();
+    m_final_barriers.clear();
 }
 
 void RenderGraph::sort_graphics_passes_by_order() {
-    // @TODO Implement!
+    const auto compiled = create_compiler().compile();
+    for (const std::size_t pass : compiled.culled_passes) {
+        spdlog::trace("Culling graphics pass {} because its results are never used", m_graphics_passes[pass]->m_name);
+    }
+    // The culled passes are kept, so compiling the rendergraph again still sees all passes in the order in which they
+    // have been added
+    for (const auto &pass : m_graphics_passes) {
+        pass->m_barriers.clear();
+    }
+    for (std::size_t position = 0; position < compiled.pass_order.size(); position++) {
+        m_graphics_passes[compiled.pass_order[position]]->m_barriers = compiled.pass_barriers[position];
+    }
+    m_pass_order = compiled.pass_order;
+    m_final_barriers = compiled.final_barriers;
 }
 
 void RenderGraph::update_buffers() {
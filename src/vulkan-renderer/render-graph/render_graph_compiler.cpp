@@ -0,0 +1,330 @@
+#include "inexor/vulkan-renderer/render-graph/render_graph_compiler.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace inexor::vulkan_renderer::render_graph {
+
+namespace {
+
+/// All accesses which write to a resource.
+constexpr ResourceAccessMask WRITE_ACCESSES{access_bit(ResourceAccess::BUFFER_WRITE) |
+                                            access_bit(ResourceAccess::COLOR_ATTACHMENT_WRITE) |
+                                            access_bit(ResourceAccess::DEPTH_STENCIL_ATTACHMENT_WRITE)};
+
+/// The layout of an image for a set of accesses which all require the same layout.
+ImageLayout mask_layout(const ResourceAccessMask mask) {
+    for (std::uint32_t access = 0; access <= static_cast<std::uint32_t>(ResourceAccess::PRESENT); access++) {
+        if ((mask & access_bit(static_cast<ResourceAccess>(access))) != 0) {
+            return image_layout(static_cast<ResourceAccess>(access));
+        }
+    }
+    return ImageLayout::UNDEFINED;
+}
+
+/// Sort a graph topologically with Kahn's algorithm, where the node with the smallest index is taken first if several
+/// nodes are ready. The result is incomplete if the graph contains a cycle.
+std::vector<std::size_t> kahn_sort(const std::vector<std::vector<std::size_t>> &successors,
+                                   const std::vector<std::vector<std::size_t>> &predecessors) {
+    std::vector<std::size_t> remaining_predecessors(predecessors.size());
+    std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<>> ready;
+    for (std::size_t node = 0; node < predecessors.size(); node++) {
+        remaining_predecessors[node] = predecessors[node].size();
+        if (remaining_predecessors[node] == 0) {
+            ready.push(node);
+        }
+    }
+    std::vector<std::size_t> order;
+    order.reserve(successors.size());
+    while (!ready.empty()) {
+        const std::size_t node = ready.top();
+        ready.pop();
+        order.push_back(node);
+        for (const std::size_t successor : successors[node]) {
+            if (--remaining_predecessors[successor] == 0) {
+                ready.push(successor);
+            }
+        }
+    }
+    return order;
+}
+
+/// The accesses of a pass merged per resource, sorted by resource index.
+std::vector<std::pair<std::size_t, ResourceAccessMask>> merge_uses(const RenderGraphPassNode &pass) {
+    std::vector<std::pair<std::size_t, ResourceAccessMask>> merged;
+    for (const auto &use : pass.uses) {
+        const auto iter = std::find_if(merged.begin(), merged.end(),
+                                       [&](const auto &entry) { return entry.first == use.resource; });
+        if (iter == merged.end()) {
+            merged.emplace_back(use.resource, access_bit(use.access));
+        } else {
+            iter->second |= access_bit(use.access);
+        }
+    }
+    std::sort(merged.begin(), merged.end());
+    return merged;
+}
+
+} // namespace
+
+bool is_write_access(const ResourceAccess access) noexcept {
+    return (WRITE_ACCESSES & access_bit(access)) != 0;
+}
+
+ImageLayout image_layout(const ResourceAccess access) noexcept {
+    switch (access) {
+    case ResourceAccess::COLOR_ATTACHMENT_WRITE:
+        return ImageLayout::COLOR_ATTACHMENT;
+    case ResourceAccess::DEPTH_STENCIL_ATTACHMENT_WRITE:
+        return ImageLayout::DEPTH_STENCIL_ATTACHMENT;
+    case ResourceAccess::PRESENT:
+        return ImageLayout::PRESENT;
+    default:
+        return ImageLayout::UNDEFINED;
+    }
+}
+
+RenderGraphCompiler::RenderGraphCompiler(std::vector<RenderGraphResource> resources,
+                                         std::vector<RenderGraphPassNode> passes)
+    : m_resources(std::move(resources)), m_passes(std::move(passes)), m_successors(m_passes.size()),
+      m_predecessors(m_passes.size()), m_data_successors(m_passes.size()) {
+    // The passes which access every resource in the order in which they have been added, and whether they write it.
+    std::vector<std::vector<std::pair<std::size_t, bool>>> accesses(m_resources.size());
+    for (std::size_t pass = 0; pass < m_passes.size(); pass++) {
+        for (const auto &use : m_passes[pass].uses) {
+            if (use.resource >= m_resources.size()) {
+                throw std::invalid_argument("Error: Pass " + m_passes[pass].name +
+                                            " uses a resource which does not exist!");
+            }
+            const auto &resource = m_resources[use.resource];
+            if (use.access == ResourceAccess::PRESENT) {
+                throw std::invalid_argument("Error: Pass " + m_passes[pass].name + " can not present " + resource.name +
+                                            ", presenting is done after the last pass!");
+            }
+            if ((image_layout(use.access) != ImageLayout::UNDEFINED) != (resource.type == ResourceType::IMAGE)) {
+                throw std::invalid_argument("Error: Pass " + m_passes[pass].name + " accesses " + resource.name +
+                                            " in a way which does not match its resource type!");
+            }
+        }
+        for (const auto &[resource, mask] : merge_uses(m_passes[pass])) {
+            for (const auto &use : m_passes[pass].uses) {
+                if (use.resource == resource && image_layout(use.access) != mask_layout(mask)) {
+                    throw std::invalid_argument("Error: Pass " + m_passes[pass].name + " uses image " +
+                                                m_resources[resource].name + " in more than one layout!");
+                }
+            }
+            accesses[resource].emplace_back(pass, (mask & WRITE_ACCESSES) != 0);
+        }
+    }
+
+    auto add_edge = [&](const std::size_t from, const std::size_t to, const bool data) {
+        m_successors[from].push_back(to);
+        m_predecessors[to].push_back(from);
+        if (data) {
+            m_data_successors[from].push_back(to);
+        }
+    };
+    std::vector<std::size_t> readers;
+    for (const auto &resource_accesses : accesses) {
+        // Readers which have been added before all writers read the result of the last writer.
+        std::optional<std::size_t> last_writer;
+        for (const auto &[pass, writes] : resource_accesses) {
+            if (writes) {
+                last_writer = pass;
+            }
+        }
+        std::optional<std::size_t> writer;
+        readers.clear();
+        for (const auto &[pass, writes] : resource_accesses) {
+            if (writes) {
+                // Writers keep their order, and the readers of the previous write must be done before the next one.
+                if (writer) {
+                    add_edge(*writer, pass, true);
+                }
+                for (const std::size_t reader : readers) {
+                    add_edge(reader, pass, false);
+                }
+                readers.clear();
+                writer = pass;
+            } else if (writer) {
+                add_edge(*writer, pass, true);
+                readers.push_back(pass);
+            } else if (last_writer) {
+                add_edge(*last_writer, pass, true);
+            }
+        }
+    }
+    for (auto *edges : {&m_successors, &m_predecessors, &m_data_successors}) {
+        for (auto &nodes : *edges) {
+            std::sort(nodes.begin(), nodes.end());
+            nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+        }
+    }
+}
+
+void RenderGraphCompiler::check_for_cycles() const {
+    const auto cycle = find_cycle();
+    if (cycle.empty()) {
+        return;
+    }
+    std::string names;
+    for (const std::size_t pass : cycle) {
+        names += m_passes[pass].name + " -> ";
+    }
+    names += m_passes[cycle.front()].name;
+    throw std::runtime_error("Error: The passes of the rendergraph depend on each other in a cycle: " + names);
+}
+
+CompiledRenderGraph RenderGraphCompiler::compile() const {
+    const auto order = sort_passes();
+    CompiledRenderGraph compiled;
+
+    // Walking the passes backwards visits the passes which depend on a pass before the pass itself. Only the passes
+    // which use the results of a pass keep it, a pass which merely has to wait for it does not.
+    std::vector<bool> needed(m_passes.size(), false);
+    for (auto pass = order.rbegin(); pass != order.rend(); pass++) {
+        const auto uses = merge_uses(m_passes[*pass]);
+        needed[*pass] =
+            std::any_of(uses.begin(), uses.end(),
+                        [&](const auto &use) {
+                            return m_resources[use.first].external && (use.second & WRITE_ACCESSES) != 0;
+                        }) ||
+            std::any_of(m_data_successors[*pass].begin(), m_data_successors[*pass].end(),
+                        [&](const std::size_t successor) { return needed[successor]; });
+    }
+    for (const std::size_t pass : order) {
+        if (needed[pass]) {
+            compiled.pass_order.push_back(pass);
+        } else {
+            compiled.culled_passes.push_back(pass);
+        }
+    }
+    std::sort(compiled.culled_passes.begin(), compiled.culled_passes.end());
+
+    std::vector<std::vector<std::pair<std::size_t, ResourceAccessMask>>> executed_uses;
+    executed_uses.reserve(compiled.pass_order.size());
+    for (const std::size_t pass : compiled.pass_order) {
+        executed_uses.push_back(merge_uses(m_passes[pass]));
+    }
+
+    struct ResourceState {
+        /// The accesses of the last writing pass, which have not been made visible to all following accesses yet.
+        ResourceAccessMask writes{0};
+        /// The reads since the last write, which must be finished before the next write or layout change.
+        ResourceAccessMask reads{0};
+        /// The accesses for which the last write has been made visible.
+        ResourceAccessMask visible{0};
+        ImageLayout layout{ImageLayout::UNDEFINED};
+        bool used{false};
+    };
+    std::vector<ResourceState> states(m_resources.size());
+    for (std::size_t resource = 0; resource < m_resources.size(); resource++) {
+        states[resource].layout = m_resources[resource].initial_layout;
+    }
+
+    // The reads of the following passes which use the same layout and come before the next write. A barrier in front of
+    // the first of them makes the resource visible to all of them at once.
+    auto following_reads = [&](const std::size_t resource, const ImageLayout layout, const std::size_t first_position) {
+        ResourceAccessMask reads{0};
+        for (std::size_t position = first_position; position < executed_uses.size(); position++) {
+            const auto &uses = executed_uses[position];
+            const auto use = std::find_if(uses.begin(), uses.end(),
+                                          [&](const auto &entry) { return entry.first == resource; });
+            if (use == uses.end()) {
+                continue;
+            }
+            if ((use->second & WRITE_ACCESSES) != 0 || mask_layout(use->second) != layout) {
+                break;
+            }
+            reads |= use->second;
+        }
+        return reads;
+    };
+
+    compiled.pass_barriers.resize(compiled.pass_order.size());
+    for (std::size_t position = 0; position < executed_uses.size(); position++) {
+        for (const auto &[resource, mask] : executed_uses[position]) {
+            auto &state = states[resource];
+            const ImageLayout layout = mask_layout(mask);
+            const bool layout_change = m_resources[resource].type == ResourceType::IMAGE && layout != state.layout;
+            if ((mask & WRITE_ACCESSES) != 0) {
+                if (state.writes != 0 || state.reads != 0 || layout_change) {
+                    compiled.pass_barriers[position].push_back(
+                        {resource, state.writes | state.reads, mask, state.layout, layout});
+                }
+                state.writes = mask;
+                state.reads = 0;
+                state.visible = 0;
+            } else {
+                if (layout_change || (state.writes != 0 && (mask & ~state.visible) != 0)) {
+                    const ResourceAccessMask dst_access = mask | following_reads(resource, layout, position + 1);
+                    compiled.pass_barriers[position].push_back(
+                        {resource, state.writes | (layout_change ? state.reads : 0), dst_access, state.layout, layout});
+                    state.visible = layout_change ? dst_access : state.visible | dst_access;
+                }
+                state.reads |= mask;
+            }
+            state.layout = layout;
+            state.used = true;
+        }
+    }
+
+    for (std::size_t resource = 0; resource < m_resources.size(); resource++) {
+        const auto &state = states[resource];
+        const auto &description = m_resources[resource];
+        if (!state.used || description.type != ResourceType::IMAGE) {
+            continue;
+        }
+        if (description.presented) {
+            compiled.final_barriers.push_back(
+                {resource, state.writes | state.reads, access_bit(ResourceAccess::PRESENT), state.layout,
+                 ImageLayout::PRESENT});
+        } else if (description.initial_layout != ImageLayout::UNDEFINED && state.layout != description.initial_layout) {
+            // The next frame expects the image in its initial layout again.
+            compiled.final_barriers.push_back(
+                {resource, state.writes | state.reads, 0, state.layout, description.initial_layout});
+        }
+    }
+    return compiled;
+}
+
+std::vector<std::size_t> RenderGraphCompiler::find_cycle() const {
+    const auto order = kahn_sort(m_successors, m_predecessors);
+    if (order.size() == m_passes.size()) {
+        return {};
+    }
+    // Every pass which could not be sorted has a predecessor which could not be sorted either, so following them
+    // backwards must run into a cycle.
+    std::vector<bool> sorted(m_passes.size(), false);
+    for (const std::size_t pass : order) {
+        sorted[pass] = true;
+    }
+    const auto start = static_cast<std::size_t>(std::find(sorted.begin(), sorted.end(), false) - sorted.begin());
+    std::vector<std::optional<std::size_t>> path_position(m_passes.size());
+    std::vector<std::size_t> path;
+    std::size_t pass = start;
+    while (!path_position[pass]) {
+        path_position[pass] = path.size();
+        path.push_back(pass);
+        pass = *std::find_if(m_predecessors[pass].begin(), m_predecessors[pass].end(),
+                             [&](const std::size_t predecessor) { return !sorted[predecessor]; });
+    }
+    // The path follows the dependencies backwards.
+    std::vector<std::size_t> cycle(path.begin() + static_cast<std::ptrdiff_t>(*path_position[pass]), path.end());
+    std::reverse(cycle.begin(), cycle.end());
+    return cycle;
+}
+
+std::vector<std::size_t> RenderGraphCompiler::sort_passes() const {
+    auto order = kahn_sort(m_successors, m_predecessors);
+    if (order.size() != m_passes.size()) {
+        check_for_cycles();
+    }
+    return order;
+}
+
+} // namespace inexor::vulkan_renderer::render_graph
@@ -0,0 +1,43 @@
+#include "inexor/vulkan-renderer/tools/frustum.hpp"
+
+#include <glm/geometric.hpp>
+
+namespace inexor::vulkan_renderer::tools {
+
+Frustum::Frustum(const glm::mat4 &view_projection) {
+    // glm matrices are column major, so the rows have to be gathered from the columns.
+    auto row = [&](const int idx) {
+        return glm::vec4(view_projection[0][idx], view_projection[1][idx], view_projection[2][idx],
+                         view_projection[3][idx]);
+    };
+    m_planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2)};
+    for (auto &plane : m_planes) {
+        // Normalized planes are not required for the box test, but they give the distance of a point to the plane.
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+FrustumTest Frustum::test(const std::array<glm::vec3, 2> &box, std::uint8_t &plane_mask) const {
+    for (std::size_t idx = 0; idx < PLANES; idx++) {
+        const std::uint8_t plane_bit = static_cast<std::uint8_t>(1u << idx);
+        if ((plane_mask & plane_bit) == 0) {
+            continue;
+        }
+        const glm::vec4 &plane = m_planes[idx];
+        // The corner which is farthest on the inner side of the plane and the one which is farthest on the outer side.
+        const glm::vec3 inner_corner(plane.x >= 0.0f ? box[1].x : box[0].x, plane.y >= 0.0f ? box[1].y : box[0].y,
+                                     plane.z >= 0.0f ? box[1].z : box[0].z);
+        const glm::vec3 outer_corner(plane.x >= 0.0f ? box[0].x : box[1].x, plane.y >= 0.0f ? box[0].y : box[1].y,
+                                     plane.z >= 0.0f ? box[0].z : box[1].z);
+        if (glm::dot(glm::vec3(plane), inner_corner) + plane.w < 0.0f) {
+            return FrustumTest::OUTSIDE;
+        }
+        if (glm::dot(glm::vec3(plane), outer_corner) + plane.w >= 0.0f) {
+            // The box is inside of this plane, so boxes inside of it are as well.
+            plane_mask &= static_cast<std::uint8_t>(~plane_bit);
+        }
+    }
+    return plane_mask == 0 ? FrustumTest::INSIDE : FrustumTest::INTERSECTING;
+}
+
+} // namespace inexor::vulkan_renderer::tools
@@ -0,0 +1,61 @@
+#include "inexor/vulkan-renderer/tools/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace inexor::vulkan_renderer::tools {
+
+std::size_t default_thread_count() noexcept {
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void parallel_for(const std::size_t count, const std::function<void(std::size_t)> &task, std::size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = default_thread_count();
+    }
+    thread_count = std::min(thread_count, count);
+    if (thread_count <= 1) {
+        for (std::size_t idx = 0; idx < count; idx++) {
+            task(idx);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next_index{0};
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+
+    auto worker = [&]() {
+        for (std::size_t idx = next_index++; idx < count; idx = next_index++) {
+            try {
+                task(idx);
+            } catch (...) {
+                std::scoped_lock lock(exception_mutex);
+                if (!exception) {
+                    exception = std::current_exception();
+                }
+                // Make all threads stop taking new tasks.
+                next_index = count;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (std::size_t idx = 1; idx < thread_count; idx++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+} // namespace inexor::vulkan_renderer::tools
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "inexor/vulkan-renderer/tools/allocators/arena_allocator.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace inexor::vulkan_renderer::tools::allocators {
+
+TEST(ArenaAllocatorTests, SharedObjects) {
+    auto *arena = Arena::create(3);
+    const ArenaAllocator<std::uint64_t> allocator(arena);
+    std::vector<std::shared_ptr<std::uint64_t>> numbers;
+    for (std::uint64_t number = 0; number < 3; number++) {
+        numbers.push_back(std::allocate_shared<std::uint64_t>(allocator, number));
+    }
+    EXPECT_EQ(arena->live_objects(), 3);
+    // The objects lie next to each other.
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(numbers[2].get()) - reinterpret_cast<std::uintptr_t>(numbers[1].get()),
+              reinterpret_cast<std::uintptr_t>(numbers[1].get()) - reinterpret_cast<std::uintptr_t>(numbers[0].get()));
+    // The arena is full.
+    EXPECT_THROW(static_cast<void>(std::allocate_shared<std::uint64_t>(allocator, 3)), std::bad_alloc);
+
+    arena->seal();
+    numbers.erase(numbers.begin());
+    EXPECT_EQ(*numbers[0], 1);
+    EXPECT_EQ(arena->live_objects(), 2);
+    // The arena deletes itself with its last object.
+    numbers.clear();
+}
+
+TEST(ArenaAllocatorTests, EmptyArena) {
+    auto *arena = Arena::create(0);
+    const ArenaAllocator<std::uint32_t> allocator(arena);
+    EXPECT_THROW(static_cast<void>(std::allocate_shared<std::uint32_t>(allocator, 1)), std::bad_alloc);
+    arena->seal();
+}
+
+TEST(ArenaAllocatorTests, SealWhileDeallocating) {
+    // The last object may be deallocated on another thread at the same time as the arena is sealed, exactly one of
+    // them must delete the arena.
+    for (int round = 0; round < 100; round++) {
+        auto *arena = Arena::create(1);
+        auto number = std::allocate_shared<std::uint64_t>(ArenaAllocator<std::uint64_t>(arena), 1);
+        std::thread thread([number = std::move(number)]() mutable { number.reset(); });
+        arena->seal();
+        thread.join();
+    }
+}
+
+} // namespace inexor::vulkan_renderer::tools::allocators
@@ -0,0 +1,202 @@
+#include <inexor/vulkan-renderer/render-graph/render_graph_compiler.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace inexor::vulkan_renderer::render_graph;
+
+constexpr ResourceAccessMask COLOR = access_bit(ResourceAccess::COLOR_ATTACHMENT_WRITE);
+constexpr ResourceAccessMask VERTEX = access_bit(ResourceAccess::VERTEX_BUFFER_READ);
+constexpr ResourceAccessMask INDEX = access_bit(ResourceAccess::INDEX_BUFFER_READ);
+constexpr ResourceAccessMask UNIFORM = access_bit(ResourceAccess::UNIFORM_BUFFER_READ);
+constexpr ResourceAccessMask BUFFER_WRITE = access_bit(ResourceAccess::BUFFER_WRITE);
+constexpr ResourceAccessMask PRESENT = access_bit(ResourceAccess::PRESENT);
+
+RenderGraphResource swapchain() {
+    return {"swapchain", ResourceType::IMAGE, ImageLayout::UNDEFINED, true, true};
+}
+
+RenderGraphResource depth_buffer() {
+    return {"depth", ResourceType::IMAGE, ImageLayout::DEPTH_STENCIL_ATTACHMENT, false, false};
+}
+
+RenderGraphResource buffer(const char *name) {
+    return {name, ResourceType::BUFFER, ImageLayout::UNDEFINED, false, false};
+}
+
+TEST(RenderGraphCompiler, compile) {
+    // The vertex buffer is written by no pass, so reading it adds no dependencies.
+    const RenderGraphCompiler compiler({swapchain(), depth_buffer(), buffer("vertices")},
+                                       {
+                                           {"octree", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE},
+                                                       {1, ResourceAccess::DEPTH_STENCIL_ATTACHMENT_WRITE},
+                                                       {2, ResourceAccess::VERTEX_BUFFER_READ}}},
+                                           {"unused", {{2, ResourceAccess::VERTEX_BUFFER_READ}}},
+                                           {"imgui", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE}}},
+                                       });
+    EXPECT_NO_THROW(compiler.check_for_cycles());
+    EXPECT_EQ(compiler.sort_passes(), (std::vector<std::size_t>{0, 1, 2}));
+    EXPECT_EQ(compiler.successors(0), (std::vector<std::size_t>{2}));
+    EXPECT_TRUE(compiler.successors(1).empty());
+
+    const CompiledRenderGraph compiled = compiler.compile();
+    EXPECT_EQ(compiled.pass_order, (std::vector<std::size_t>{0, 2}));
+    EXPECT_EQ(compiled.culled_passes, (std::vector<std::size_t>{1}));
+    ASSERT_EQ(compiled.pass_barriers.size(), 2);
+    // The depth buffer already is in its layout, only the swapchain image needs a transition.
+    EXPECT_EQ(compiled.pass_barriers[0],
+              (std::vector<ResourceBarrier>{{0, 0, COLOR, ImageLayout::UNDEFINED, ImageLayout::COLOR_ATTACHMENT}}));
+    // The second pass draws on top of the first one, which needs a barrier but no layout transition.
+    EXPECT_EQ(compiled.pass_barriers[1], (std::vector<ResourceBarrier>{{0, COLOR, COLOR, ImageLayout::COLOR_ATTACHMENT,
+                                                                        ImageLayout::COLOR_ATTACHMENT}}));
+    EXPECT_EQ(compiled.final_barriers,
+              (std::vector<ResourceBarrier>{{0, COLOR, PRESENT, ImageLayout::COLOR_ATTACHMENT, ImageLayout::PRESENT}}));
+}
+
+TEST(RenderGraphCompiler, sort_passes_by_dependencies) {
+    // The pass which reads the particles has been added before the pass which writes them.
+    const RenderGraphCompiler compiler({swapchain(), buffer("particles")},
+                                       {
+                                           {"draw", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE},
+                                                     {1, ResourceAccess::VERTEX_BUFFER_READ}}},
+                                           {"simulate", {{1, ResourceAccess::BUFFER_WRITE}}},
+                                       });
+    EXPECT_EQ(compiler.sort_passes(), (std::vector<std::size_t>{1, 0}));
+
+    const CompiledRenderGraph compiled = compiler.compile();
+    EXPECT_EQ(compiled.pass_order, (std::vector<std::size_t>{1, 0}));
+    EXPECT_TRUE(compiled.culled_passes.empty());
+    ASSERT_EQ(compiled.pass_barriers.size(), 2);
+    EXPECT_TRUE(compiled.pass_barriers[0].empty());
+    EXPECT_EQ(compiled.pass_barriers[1],
+              (std::vector<ResourceBarrier>{
+                  {0, 0, COLOR, ImageLayout::UNDEFINED, ImageLayout::COLOR_ATTACHMENT},
+                  {1, BUFFER_WRITE, VERTEX, ImageLayout::UNDEFINED, ImageLayout::UNDEFINED}}));
+}
+
+TEST(RenderGraphCompiler, write_read_write_read) {
+    // Every draw pass reads the particles of the simulation step which has been added right before it.
+    const RenderGraphCompiler compiler({swapchain(), buffer("particles")},
+                                       {
+                                           {"simulate", {{1, ResourceAccess::BUFFER_WRITE}}},
+                                           {"draw", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE},
+                                                     {1, ResourceAccess::VERTEX_BUFFER_READ}}},
+                                           {"simulate again", {{1, ResourceAccess::BUFFER_WRITE}}},
+                                           {"draw again", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE},
+                                                           {1, ResourceAccess::VERTEX_BUFFER_READ}}},
+                                       });
+    EXPECT_EQ(compiler.successors(0), (std::vector<std::size_t>{1, 2}));
+    // The second simulation step must wait until the first draw pass has read the particles.
+    EXPECT_EQ(compiler.successors(1), (std::vector<std::size_t>{2, 3}));
+    EXPECT_EQ(compiler.successors(2), (std::vector<std::size_t>{3}));
+    EXPECT_EQ(compiler.sort_passes(), (std::vector<std::size_t>{0, 1, 2, 3}));
+
+    const CompiledRenderGraph compiled = compiler.compile();
+    EXPECT_EQ(compiled.pass_order, (std::vector<std::size_t>{0, 1, 2, 3}));
+    ASSERT_EQ(compiled.pass_barriers.size(), 4);
+    EXPECT_EQ(compiled.pass_barriers[1],
+              (std::vector<ResourceBarrier>{
+                  {0, 0, COLOR, ImageLayout::UNDEFINED, ImageLayout::COLOR_ATTACHMENT},
+                  {1, BUFFER_WRITE, VERTEX, ImageLayout::UNDEFINED, ImageLayout::UNDEFINED}}));
+    EXPECT_EQ(compiled.pass_barriers[2],
+              (std::vector<ResourceBarrier>{
+                  {1, BUFFER_WRITE | VERTEX, BUFFER_WRITE, ImageLayout::UNDEFINED, ImageLayout::UNDEFINED}}));
+    EXPECT_EQ(compiled.pass_barriers[3],
+              (std::vector<ResourceBarrier>{
+                  {0, COLOR, COLOR, ImageLayout::COLOR_ATTACHMENT, ImageLayout::COLOR_ATTACHMENT},
+                  {1, BUFFER_WRITE, VERTEX, ImageLayout::UNDEFINED, ImageLayout::UNDEFINED}}));
+}
+
+TEST(RenderGraphCompiler, merge_read_barriers) {
+    const RenderGraphCompiler compiler({swapchain(), buffer("particles")},
+                                       {
+                                           {"simulate", {{1, ResourceAccess::BUFFER_WRITE}}},
+                                           {"points", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE},
+                                                       {1, ResourceAccess::VERTEX_BUFFER_READ}}},
+                                           {"lines", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE},
+                                                      {1, ResourceAccess::INDEX_BUFFER_READ},
+                                                      {1, ResourceAccess::UNIFORM_BUFFER_READ}}},
+                                       });
+    const CompiledRenderGraph compiled = compiler.compile();
+    EXPECT_EQ(compiled.pass_order, (std::vector<std::size_t>{0, 1, 2}));
+    ASSERT_EQ(compiled.pass_barriers.size(), 3);
+    // One barrier makes the particles visible to both passes which read them.
+    EXPECT_EQ(compiled.pass_barriers[1],
+              (std::vector<ResourceBarrier>{
+                  {0, 0, COLOR, ImageLayout::UNDEFINED, ImageLayout::COLOR_ATTACHMENT},
+                  {1, BUFFER_WRITE, VERTEX | INDEX | UNIFORM, ImageLayout::UNDEFINED, ImageLayout::UNDEFINED}}));
+    EXPECT_EQ(compiled.pass_barriers[2], (std::vector<ResourceBarrier>{{0, COLOR, COLOR, ImageLayout::COLOR_ATTACHMENT,
+                                                                        ImageLayout::COLOR_ATTACHMENT}}));
+}
+
+TEST(RenderGraphCompiler, cull_passes) {
+    const RenderGraphResource color{"color", ResourceType::IMAGE, ImageLayout::COLOR_ATTACHMENT, false, true};
+    const RenderGraphCompiler compiler({color, depth_buffer(), buffer("particles")},
+                                       {
+                                           {"geometry", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE},
+                                                         {1, ResourceAccess::DEPTH_STENCIL_ATTACHMENT_WRITE}}},
+                                           {"depth only", {{1, ResourceAccess::DEPTH_STENCIL_ATTACHMENT_WRITE}}},
+                                           {"simulate", {{2, ResourceAccess::BUFFER_WRITE}}},
+                                       });
+    const CompiledRenderGraph compiled = compiler.compile();
+    // Nothing reads the depth buffer after the depth only pass, and nothing reads the particles at all.
+    EXPECT_EQ(compiled.pass_order, (std::vector<std::size_t>{0}));
+    EXPECT_EQ(compiled.culled_passes, (std::vector<std::size_t>{1, 2}));
+    ASSERT_EQ(compiled.pass_barriers.size(), 1);
+    EXPECT_TRUE(compiled.pass_barriers[0].empty());
+    EXPECT_TRUE(compiled.final_barriers.empty());
+
+    // The statistics are never read, so the pass which computes them is culled, although the draw pass would have to
+    // wait for it before overwriting the particles.
+    const RenderGraphCompiler overwrite({swapchain(), buffer("particles"), buffer("statistics")},
+                                       {
+                                           {"simulate", {{1, ResourceAccess::BUFFER_WRITE}}},
+                                           {"statistics", {{1, ResourceAccess::UNIFORM_BUFFER_READ},
+                                                           {2, ResourceAccess::BUFFER_WRITE}}},
+                                           {"draw", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE},
+                                                     {1, ResourceAccess::BUFFER_WRITE}}},
+                                       });
+    EXPECT_EQ(overwrite.successors(1), (std::vector<std::size_t>{2}));
+    const CompiledRenderGraph overwritten = overwrite.compile();
+    EXPECT_EQ(overwritten.pass_order, (std::vector<std::size_t>{0, 2}));
+    EXPECT_EQ(overwritten.culled_passes, (std::vector<std::size_t>{1}));
+}
+
+TEST(RenderGraphCompiler, cycle) {
+    const RenderGraphCompiler compiler({buffer("a"), buffer("b"), swapchain()},
+                                       {
+                                           {"x", {{0, ResourceAccess::VERTEX_BUFFER_READ},
+                                                  {1, ResourceAccess::BUFFER_WRITE},
+                                                  {2, ResourceAccess::COLOR_ATTACHMENT_WRITE}}},
+                                           {"y", {{1, ResourceAccess::UNIFORM_BUFFER_READ},
+                                                  {0, ResourceAccess::BUFFER_WRITE}}},
+                                       });
+    EXPECT_THROW(static_cast<void>(compiler.sort_passes()), std::runtime_error);
+    EXPECT_THROW(static_cast<void>(compiler.compile()), std::runtime_error);
+    try {
+        compiler.check_for_cycles();
+        FAIL();
+    } catch (const std::runtime_error &exception) {
+        EXPECT_NE(std::string(exception.what()).find("y -> x -> y"), std::string::npos);
+    }
+}
+
+TEST(RenderGraphCompiler, invalid_arguments) {
+    EXPECT_THROW(RenderGraphCompiler({buffer("vertices")}, {{"pass", {{1, ResourceAccess::VERTEX_BUFFER_READ}}}}),
+                 std::invalid_argument);
+    EXPECT_THROW(RenderGraphCompiler({buffer("vertices")}, {{"pass", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE}}}}),
+                 std::invalid_argument);
+    EXPECT_THROW(RenderGraphCompiler({swapchain()}, {{"pass", {{0, ResourceAccess::BUFFER_WRITE}}}}),
+                 std::invalid_argument);
+    EXPECT_THROW(RenderGraphCompiler({swapchain()}, {{"pass", {{0, ResourceAccess::PRESENT}}}}),
+                 std::invalid_argument);
+    EXPECT_THROW(RenderGraphCompiler({swapchain()}, {{"pass", {{0, ResourceAccess::COLOR_ATTACHMENT_WRITE},
+                                                               {0, ResourceAccess::DEPTH_STENCIL_ATTACHMENT_WRITE}}}}),
+                 std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,185 @@
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/indentation.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/byte_stream.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/nxoc_parser.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+using namespace inexor::vulkan_renderer;
+
+std::filesystem::path write_temporary_file(const std::string &name, const std::span<const std::uint8_t> data) {
+    const auto path = std::filesystem::temp_directory_path() / name;
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size())); // NOLINT
+    return path;
+}
+
+TEST(ByteStream, views) {
+    const std::vector<std::uint8_t> bytes{1, 2, 3, 4, 5, 6};
+    const serialization::ByteStream stream{std::span<const std::uint8_t>(bytes)};
+    EXPECT_EQ(stream.size(), 6);
+    EXPECT_EQ(stream.data().data(), bytes.data());
+
+    // Copies share the memory instead of copying it.
+    const serialization::ByteStream copy = stream; // NOLINT
+    EXPECT_EQ(copy.data().data(), bytes.data());
+
+    serialization::ByteStreamReader reader(copy);
+    EXPECT_EQ(reader.read<std::uint8_t>(), 1);
+    EXPECT_EQ(reader.read<std::uint32_t>(), 0x05040302u);
+    EXPECT_EQ(reader.remaining(), 1);
+    EXPECT_THROW(static_cast<void>(reader.read<std::uint32_t>()), std::runtime_error);
+    reader.skip(10);
+    EXPECT_EQ(reader.remaining(), 0);
+
+    // A writer appends to a buffer it owns, it can not write into a read-only view.
+    static_assert(!std::is_constructible_v<serialization::ByteStreamWriter, std::span<const std::uint8_t>>);
+    static_assert(!std::is_constructible_v<serialization::ByteStreamWriter, const std::filesystem::path &>);
+    serialization::ByteStreamWriter writer(bytes);
+    writer.write<std::uint8_t>(7);
+    ASSERT_EQ(writer.size(), 7);
+    EXPECT_EQ(writer.data()[6], 7);
+}
+
+TEST(ByteStream, indentations) {
+    // Every uid, padded to a multiple of 4.
+    std::vector<octree::Indentation> indentations;
+    for (std::uint8_t uid = 0; uid < 48; uid++) {
+        indentations.emplace_back(static_cast<std::uint8_t>(uid % octree::Indentation::UID_COUNT));
+        EXPECT_EQ(indentations.back().uid(), uid % octree::Indentation::UID_COUNT);
+    }
+    EXPECT_EQ(octree::Indentation(0), octree::Indentation(0, 0));
+    EXPECT_EQ(octree::Indentation(44), octree::Indentation(8, 8));
+
+    serialization::ByteStreamWriter writer;
+    writer.write_indentations(indentations);
+    ASSERT_EQ(writer.size(), 36);
+    EXPECT_EQ(writer.data()[0], 0b00000000u); // uids 0, 1, 2, 3
+    EXPECT_EQ(writer.data()[1], 0b00010000u);
+    EXPECT_EQ(writer.data()[2], 0b10000011u);
+
+    std::vector<octree::Indentation> read_back(indentations.size());
+    serialization::ByteStreamReader reader(writer);
+    reader.read_indentations(read_back);
+    EXPECT_EQ(read_back, indentations);
+    EXPECT_EQ(reader.remaining(), 0);
+
+    // The single cube overloads use the same format.
+    serialization::ByteStreamReader cube_reader(writer);
+    const auto cube_indentations = cube_reader.read<std::array<octree::Indentation, 12>>();
+    EXPECT_TRUE(std::equal(cube_indentations.begin(), cube_indentations.end(), indentations.begin()));
+
+    std::vector<octree::Indentation> wrong_count(5);
+    EXPECT_THROW(writer.write_indentations(wrong_count), std::invalid_argument);
+    EXPECT_THROW(serialization::ByteStreamReader(writer).read_indentations(wrong_count), std::invalid_argument);
+
+    // 6 bits can hold uids which are not valid.
+    const std::vector<std::uint8_t> invalid{0xff, 0xff, 0xff};
+    std::array<octree::Indentation, 4> invalid_indentations;
+    EXPECT_THROW(serialization::ByteStreamReader(invalid).read_indentations(invalid_indentations), std::runtime_error);
+
+    // Every uid in every position of a word, and an invalid uid in the first and in the last words, which may be
+    // decoded differently.
+    std::vector<octree::Indentation> all_uids;
+    for (std::uint8_t offset = 0; offset < 4; offset++) {
+        for (std::uint8_t uid = 0; uid < octree::Indentation::UID_COUNT + 3; uid++) {
+            all_uids.emplace_back(static_cast<std::uint8_t>((uid + offset) % octree::Indentation::UID_COUNT));
+        }
+    }
+    serialization::ByteStreamWriter all_uids_writer;
+    all_uids_writer.write_indentations(all_uids);
+    std::vector<octree::Indentation> all_uids_read_back(all_uids.size());
+    serialization::ByteStreamReader(all_uids_writer).read_indentations(all_uids_read_back);
+    EXPECT_EQ(all_uids_read_back, all_uids);
+    for (const std::size_t byte : {std::size_t{2}, all_uids.size() / 4 * 3 - 1}) {
+        std::vector<std::uint8_t> bytes(all_uids_writer.data().begin(), all_uids_writer.data().end());
+        // The last uid of the word, which is stored in the lowest 6 bits of its third byte, becomes 45.
+        bytes[byte] = static_cast<std::uint8_t>((bytes[byte] & 0b11000000u) | octree::Indentation::UID_COUNT);
+        EXPECT_THROW(serialization::ByteStreamReader(bytes).read_indentations(all_uids_read_back), std::runtime_error);
+    }
+}
+
+TEST(ByteStream, memory_mapped_file) {
+    const auto world = octree::create_random_world(3, {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    const auto serialized = parser.serialize(world, 0);
+    const auto path = write_temporary_file("inexor_byte_stream_test.nxoc", serialized.data());
+
+    const serialization::ByteStream mapped(path);
+    EXPECT_TRUE(std::ranges::equal(mapped.data(), serialized.data()));
+    const auto loaded = parser.deserialize(mapped);
+    EXPECT_EQ(loaded->count_geometry_cubes(), world->count_geometry_cubes());
+    EXPECT_TRUE(std::ranges::equal(parser.serialize(loaded, 0).data(), serialized.data()));
+    std::filesystem::remove(path);
+
+    const auto empty_path = write_temporary_file("inexor_byte_stream_test_empty.nxoc", {});
+    EXPECT_EQ(serialization::ByteStream(empty_path).size(), 0);
+    std::filesystem::remove(empty_path);
+
+    EXPECT_THROW(serialization::ByteStream(std::filesystem::temp_directory_path() / "inexor_missing_file.nxoc"),
+                 std::runtime_error);
+}
+
+/// A sink which keeps every chunk it receives.
+class RecordingSink : public serialization::ByteSink {
+public:
+    std::vector<std::vector<std::uint8_t>> chunks;
+
+    void write(const std::span<const std::uint8_t> data) override {
+        chunks.emplace_back(data.begin(), data.end());
+    }
+};
+
+TEST(ByteStream, sink_writer) {
+    const auto world = octree::create_random_world(3, {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    for (const std::uint32_t version : {0u, 1u}) {
+        const auto serialized = parser.serialize(world, version);
+
+        RecordingSink sink;
+        parser.serialize(world, version, sink, 64);
+        std::vector<std::uint8_t> written;
+        for (const auto &chunk : sink.chunks) {
+            EXPECT_LE(chunk.size(), 64);
+            written.insert(written.end(), chunk.begin(), chunk.end());
+        }
+        EXPECT_TRUE(std::ranges::equal(written, serialized.data()));
+    }
+
+    // Data which is larger than the buffer is passed on without copying it into the buffer first.
+    RecordingSink sink;
+    serialization::ByteStreamWriter writer(sink, 4);
+    writer.write<std::uint8_t>(1);
+    writer.write<std::string>("Inexor");
+    writer.flush();
+    ASSERT_EQ(sink.chunks.size(), 2);
+    EXPECT_EQ(sink.chunks[0], std::vector<std::uint8_t>{1});
+    EXPECT_EQ(sink.chunks[1].size(), 6);
+    EXPECT_EQ(writer.size(), 0);
+}
+
+TEST(ByteStream, file_sink) {
+    const auto world = octree::create_random_world(3, {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    const auto path = std::filesystem::temp_directory_path() / "inexor_file_sink_test.nxoc";
+    {
+        serialization::FileByteSink sink(path);
+        parser.serialize(world, 1, sink);
+    }
+    const serialization::ByteStream mapped(path);
+    EXPECT_TRUE(std::ranges::equal(mapped.data(), parser.serialize(world, 1).data()));
+    EXPECT_EQ(parser.deserialize(mapped)->count_geometry_cubes(), world->count_geometry_cubes());
+    std::filesystem::remove(path);
+
+    EXPECT_THROW(serialization::FileByteSink(std::filesystem::temp_directory_path() / "inexor_missing" / "file.nxoc"),
+                 std::runtime_error);
+}
+
+} // namespace
@@ -0,0 +1,174 @@
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/byte_stream.hpp>
+#include <inexor/vulkan-renderer/octree/serialization/nxoc_parser.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+using namespace inexor::vulkan_renderer;
+
+/// Compare two octrees through their version 0 serialization, which contains every cube in pre-order.
+bool equal_octrees(const std::shared_ptr<const octree::Cube> &lhs, const std::shared_ptr<const octree::Cube> &rhs) {
+    serialization::NXOCParser parser;
+    return std::ranges::equal(parser.serialize(lhs, 0).data(), parser.serialize(rhs, 0).data());
+}
+
+TEST(NXOCParser, round_trip) {
+    const auto world = octree::create_random_world(4, {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    for (const std::uint32_t version : {0u, 1u, 2u}) {
+        const auto loaded = parser.deserialize(parser.serialize(world, version));
+        EXPECT_TRUE(equal_octrees(world, loaded)) << "version " << version;
+        EXPECT_FALSE(loaded->is_dirty());
+    }
+
+    // Octrees which are not split on the indexed levels.
+    for (const auto type : {octree::Cube::Type::EMPTY, octree::Cube::Type::SOLID, octree::Cube::Type::NORMAL}) {
+        auto cube = std::make_shared<octree::Cube>();
+        cube->set_type(type);
+        EXPECT_TRUE(equal_octrees(cube, parser.deserialize(parser.serialize(cube, 1))));
+        EXPECT_TRUE(equal_octrees(cube, parser.deserialize(parser.serialize(cube, 2))));
+    }
+
+    EXPECT_THROW(static_cast<void>(parser.serialize(world, 3)), std::runtime_error);
+    EXPECT_THROW(static_cast<void>(parser.serialize(nullptr, 1)), std::invalid_argument);
+}
+
+TEST(NXOCParser, parallel_decode) {
+    const auto world = octree::create_random_world(4, {0.0f, 0.0f, 0.0f}, 42);
+    const auto stream = serialization::NXOCParser().serialize(world, 1);
+    for (const std::size_t thread_count : {1, 2, 8}) {
+        EXPECT_TRUE(equal_octrees(world, serialization::NXOCParser(thread_count).deserialize(stream)));
+    }
+}
+
+TEST(NXOCParser, random_world) {
+    /// A sink which appends all chunks to one buffer.
+    class VectorSink : public serialization::ByteSink {
+    public:
+        std::vector<std::uint8_t> bytes;
+
+        void write(const std::span<const std::uint8_t> data) override {
+            bytes.insert(bytes.end(), data.begin(), data.end());
+        }
+    };
+
+    // Worlds whose leaves are above, on and below the indexed levels.
+    for (const std::uint32_t max_depth : {0u, 1u, 3u}) {
+        const auto world = octree::create_random_world(max_depth, {0.0f, 0.0f, 0.0f}, 42);
+        for (const std::uint32_t version : {0u, 1u}) {
+            for (const std::size_t thread_count : {1, 3}) {
+                VectorSink sink;
+                serialization::NXOCParser(thread_count).serialize_random_world(max_depth, 42, version, sink, 256);
+                const auto serialized = serialization::NXOCParser().serialize(world, version);
+                EXPECT_TRUE(std::ranges::equal(sink.bytes, serialized.data()))
+                    << "depth " << max_depth << ", version " << version << ", " << thread_count << " threads";
+            }
+        }
+    }
+
+    VectorSink sink;
+    EXPECT_THROW(serialization::NXOCParser().serialize_random_world(2, 42, 2, sink), std::invalid_argument);
+    EXPECT_THROW(serialization::NXOCParser().serialize_random_world(octree::LocationalCode::MAX_LEVEL, 42, 0, sink),
+                 std::invalid_argument);
+    EXPECT_TRUE(sink.bytes.empty());
+}
+
+TEST(NXOCParser, region) {
+    auto world = std::make_shared<octree::Cube>();
+    world->set_type(octree::Cube::Type::OCTANT);
+    for (const auto &child : world->children()) {
+        child->set_type(octree::Cube::Type::OCTANT);
+        for (const auto &grandchild : child->children()) {
+            grandchild->set_type(octree::Cube::Type::SOLID);
+        }
+    }
+    serialization::NXOCParser parser;
+
+    // Only the grandchild of the first child in the corner at the origin is loaded.
+    const auto loaded = parser.deserialize_region(parser.serialize(world, 1), {1.0f, 1.0f, 1.0f}, 1.0f);
+    ASSERT_EQ(loaded->type(), octree::Cube::Type::OCTANT);
+    EXPECT_EQ(loaded->children()[0]->type(), octree::Cube::Type::OCTANT);
+    EXPECT_EQ(loaded->children()[0]->children()[0]->type(), octree::Cube::Type::SOLID);
+    EXPECT_EQ(loaded->children()[0]->children()[7]->type(), octree::Cube::Type::EMPTY);
+    EXPECT_EQ(loaded->children()[7]->type(), octree::Cube::Type::EMPTY);
+    EXPECT_EQ(loaded->count_geometry_cubes(), 1);
+
+    // Version 0 can not skip subtrees.
+    EXPECT_TRUE(equal_octrees(world, parser.deserialize_region(parser.serialize(world, 0), {1.0f, 1.0f, 1.0f}, 1.0f)));
+}
+
+TEST(NXOCParser, compression) {
+    // A terrain like world: the lower half is solid, the upper half is empty and the surface in between is indented.
+    auto world = std::make_shared<octree::Cube>();
+    const std::function<void(const std::shared_ptr<octree::Cube> &, std::size_t)> create_terrain =
+        [&](const std::shared_ptr<octree::Cube> &cube, const std::size_t depth) {
+            if (depth == 0) {
+                const float height = cube->center().y;
+                cube->set_type(height < 15.0f   ? octree::Cube::Type::SOLID
+                               : height < 17.0f ? octree::Cube::Type::NORMAL
+                                                : octree::Cube::Type::EMPTY);
+                return;
+            }
+            cube->set_type(octree::Cube::Type::OCTANT);
+            for (const auto &child : cube->children()) {
+                create_terrain(child, depth - 1);
+            }
+        };
+    create_terrain(world, 4);
+    serialization::NXOCParser parser;
+    const auto compressed = parser.serialize(world, 2);
+    EXPECT_TRUE(equal_octrees(world, parser.deserialize(compressed)));
+    EXPECT_LT(compressed.size() * 4, parser.serialize(world, 0).size());
+
+    // Random worlds have no uniform subtrees, but the cube types are still coded with less than a byte.
+    const auto random_world = octree::create_random_world(4, {0.0f, 0.0f, 0.0f}, 42);
+    EXPECT_LT(parser.serialize(random_world, 2).size(), parser.serialize(random_world, 0).size());
+}
+
+TEST(NXOCParser, invalid_streams) {
+    const auto world = octree::create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    serialization::NXOCParser parser;
+    const auto stream = parser.serialize(world, 1);
+    auto bytes = std::vector<std::uint8_t>(stream.data().begin(), stream.data().end());
+
+    auto wrong_identifier = bytes;
+    wrong_identifier[0] = 'X';
+    EXPECT_THROW(static_cast<void>(parser.deserialize(serialization::ByteStream(wrong_identifier))),
+                 std::runtime_error);
+
+    auto wrong_version = bytes;
+    wrong_version[13] = 42;
+    EXPECT_THROW(static_cast<void>(parser.deserialize(serialization::ByteStream(wrong_version))), std::runtime_error);
+
+    // The root is an octant, so the size of its first child follows its type.
+    auto wrong_size = bytes;
+    wrong_size[13 + 4 + 1 + 1]++;
+    EXPECT_THROW(static_cast<void>(parser.deserialize(serialization::ByteStream(wrong_size))), std::runtime_error);
+
+    bytes.pop_back();
+    EXPECT_THROW(static_cast<void>(parser.deserialize(serialization::ByteStream(bytes))), std::runtime_error);
+
+    const auto compressed = parser.serialize(world, 2);
+    auto compressed_bytes = std::vector<std::uint8_t>(compressed.data().begin(), compressed.data().end());
+    auto wrong_type_count = compressed_bytes;
+    wrong_type_count[13 + 4]++;
+    EXPECT_THROW(static_cast<void>(parser.deserialize(serialization::ByteStream(wrong_type_count))),
+                 std::runtime_error);
+
+    // The frequencies of the cube type symbols follow the symbol counts.
+    auto wrong_frequencies = compressed_bytes;
+    wrong_frequencies[13 + 4 + 4 + 4]++;
+    EXPECT_THROW(static_cast<void>(parser.deserialize(serialization::ByteStream(wrong_frequencies))),
+                 std::runtime_error);
+
+    compressed_bytes.pop_back();
+    EXPECT_THROW(static_cast<void>(parser.deserialize(serialization::ByteStream(compressed_bytes))),
+                 std::runtime_error);
+}
+
+} // namespace
@@ -0,0 +1,56 @@
+#include <inexor/vulkan-renderer/octree/serialization/rans_coder.hpp>
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+using namespace inexor::vulkan_renderer::serialization;
+
+TEST(RansCoder, frequency_table) {
+    const std::vector<std::uint64_t> counts{1, 0, 1000000, 3};
+    const auto table = RansFrequencyTable::from_counts(counts);
+    EXPECT_EQ(std::accumulate(table.frequencies().begin(), table.frequencies().end(), 0u),
+              RansFrequencyTable::PROBABILITY_SCALE);
+    // Rare symbols keep a frequency, symbols which do not occur get none.
+    EXPECT_EQ(table.frequency(0), 1);
+    EXPECT_EQ(table.frequency(1), 0);
+    EXPECT_EQ(table.frequency(3), 1);
+    EXPECT_EQ(table.symbol(0), 0);
+    EXPECT_EQ(table.symbol(RansFrequencyTable::PROBABILITY_SCALE - 1), 3);
+
+    EXPECT_THROW(RansFrequencyTable({1, 2, 3}), std::runtime_error);
+    EXPECT_THROW(static_cast<void>(RansFrequencyTable::from_counts(std::vector<std::uint64_t>(5000, 1))),
+                 std::invalid_argument);
+}
+
+TEST(RansCoder, round_trip) {
+    // A skewed distribution with 90% zeros.
+    std::vector<std::uint16_t> symbols(10000);
+    for (std::size_t idx = 0; idx < symbols.size(); idx++) {
+        symbols[idx] = idx % 10 == 0 ? static_cast<std::uint16_t>(1 + idx % 7) : 0;
+    }
+    std::vector<std::uint64_t> counts(8, 0);
+    for (const auto symbol : symbols) {
+        counts[symbol]++;
+    }
+    const auto table = RansFrequencyTable::from_counts(counts);
+    const auto bytes = rans_encode(symbols, table);
+    // The entropy is about 0.75 bits per symbol.
+    EXPECT_LT(bytes.size(), symbols.size() / 10);
+
+    RansDecoder decoder(table, bytes);
+    for (const auto symbol : symbols) {
+        ASSERT_EQ(decoder.decode(), symbol);
+    }
+    EXPECT_TRUE(decoder.finished());
+
+    // A stream without symbols only holds the coder state.
+    const auto empty = rans_encode({}, table);
+    EXPECT_EQ(empty.size(), 4);
+    EXPECT_TRUE(RansDecoder(table, empty).finished());
+    EXPECT_THROW(RansDecoder(table, std::span(empty).first(3)), std::runtime_error);
+}
+
+} // namespace
@@ -0,0 +1,214 @@
+#include <inexor/vulkan-renderer/octree/chunk_manager.hpp>
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+using namespace inexor::vulkan_renderer::octree;
+
+/// A world of size 8 whose 8 children are solid.
+std::shared_ptr<Cube> create_solid_world(const glm::vec3 &position = {0.0f, 0.0f, 0.0f}) {
+    auto world = std::make_shared<Cube>(8.0f, position);
+    world->set_type(Cube::Type::OCTANT);
+    for (const auto &child : world->children()) {
+        child->set_type(Cube::Type::SOLID);
+    }
+    return world;
+}
+
+/// The memory usage of the mesh of one solid cube: 8 vertices and 12 triangles.
+constexpr std::size_t SOLID_CHUNK_MEMORY{8 * sizeof(glm::vec3) + 36 * sizeof(std::uint32_t)};
+
+std::size_t count_loaded(const ChunkManager &manager) {
+    return std::count_if(manager.chunks().begin(), manager.chunks().end(),
+                         [](const Chunk &chunk) { return chunk.loaded; });
+}
+
+TEST(ChunkManager, partition) {
+    auto world = create_solid_world();
+    world->children()[2]->set_type(Cube::Type::OCTANT);
+    EXPECT_EQ(ChunkManager({world}, {.chunk_level = 0}).chunks().size(), 1);
+    EXPECT_EQ(ChunkManager({world}, {.chunk_level = 1}).chunks().size(), 8);
+    EXPECT_EQ(ChunkManager({world}, {.chunk_level = 2}).chunks().size(), 15);
+    EXPECT_EQ(ChunkManager({world, create_solid_world()}, {.chunk_level = 1}).chunks().size(), 16);
+
+    EXPECT_THROW(ChunkManager({world}, {.slot_count = 0}), std::invalid_argument);
+    EXPECT_THROW(ChunkManager({nullptr}), std::invalid_argument);
+}
+
+TEST(ChunkManager, streaming) {
+    const auto world = create_solid_world();
+    ChunkManager manager({world}, {.chunk_level = 1, .load_distance = 2.0f});
+
+    EXPECT_TRUE(manager.update({100.0f, 100.0f, 100.0f}).empty());
+    EXPECT_EQ(count_loaded(manager), 0);
+
+    // Only the child in the corner closest to the camera is within the load distance.
+    EXPECT_EQ(manager.update({-1.0f, -1.0f, -1.0f}), std::vector<std::size_t>{0});
+    EXPECT_EQ(count_loaded(manager), 1);
+    ASSERT_NE(manager.chunk_in_slot(0), nullptr);
+    EXPECT_EQ(manager.chunk_in_slot(0)->cube, world->children()[0]);
+    EXPECT_EQ(manager.chunk_in_slot(0)->mesh.indices.size(), 36);
+    EXPECT_EQ(manager.memory_usage(), SOLID_CHUNK_MEMORY);
+    EXPECT_EQ(manager.statistics().emitted_triangles, 12);
+    EXPECT_EQ(manager.chunk_in_slot(1), nullptr);
+
+    // Nothing changes if the camera does not move.
+    EXPECT_TRUE(manager.update({-1.0f, -1.0f, -1.0f}).empty());
+
+    // The slot of the evicted chunk is reused for the chunk in the opposite corner.
+    EXPECT_EQ(manager.update({9.0f, 9.0f, 9.0f}), std::vector<std::size_t>{0});
+    EXPECT_EQ(count_loaded(manager), 1);
+    ASSERT_NE(manager.chunk_in_slot(0), nullptr);
+    EXPECT_EQ(manager.chunk_in_slot(0)->cube, world->children()[7]);
+}
+
+TEST(ChunkManager, limits) {
+    const auto world = create_solid_world();
+    const glm::vec3 camera_position{-1.0f, -1.0f, -1.0f};
+
+    ChunkManager budget_manager({world}, {.chunk_level = 1, .memory_budget = 3 * SOLID_CHUNK_MEMORY + 1});
+    EXPECT_EQ(budget_manager.update(camera_position).size(), 3);
+    EXPECT_EQ(count_loaded(budget_manager), 3);
+    EXPECT_EQ(budget_manager.memory_usage(), 3 * SOLID_CHUNK_MEMORY);
+    EXPECT_TRUE(budget_manager.update(camera_position).empty());
+
+    // Vertices with a position and a color as two glm::vec3 take twice the memory, so only 2 chunks fit.
+    constexpr std::size_t COLORED_SOLID_CHUNK_MEMORY{8 * 2 * sizeof(glm::vec3) + 36 * sizeof(std::uint32_t)};
+    ChunkManager vertex_size_manager(
+        {world}, {.chunk_level = 1, .memory_budget = 3 * SOLID_CHUNK_MEMORY + 1, .vertex_size = 2 * sizeof(glm::vec3)});
+    EXPECT_EQ(vertex_size_manager.update(camera_position).size(), 2);
+    EXPECT_EQ(vertex_size_manager.memory_usage(), 2 * COLORED_SOLID_CHUNK_MEMORY);
+
+    ChunkManager slot_manager({world}, {.chunk_level = 1, .slot_count = 2});
+    EXPECT_EQ(slot_manager.update(camera_position), (std::vector<std::size_t>{0, 1}));
+    EXPECT_EQ(count_loaded(slot_manager), 2);
+    EXPECT_EQ(slot_manager.chunk_in_slot(0)->cube, world->children()[0]);
+
+    ChunkManager load_manager({world}, {.chunk_level = 1, .max_loads_per_update = 3});
+    EXPECT_EQ(load_manager.update(camera_position).size(), 3);
+    EXPECT_EQ(load_manager.update(camera_position).size(), 3);
+    EXPECT_EQ(load_manager.update(camera_position).size(), 2);
+    EXPECT_EQ(count_loaded(load_manager), 8);
+    EXPECT_EQ(load_manager.memory_usage(), 8 * SOLID_CHUNK_MEMORY);
+}
+
+TEST(ChunkManager, edits) {
+    const auto world = create_solid_world();
+    ChunkManager manager({world}, {.chunk_level = 1});
+    const glm::vec3 camera_position{-1.0f, -1.0f, -1.0f};
+    EXPECT_EQ(manager.update(camera_position).size(), 8);
+
+    auto slot_of = [&](const std::shared_ptr<Cube> &cube) {
+        for (std::size_t slot = 0; slot < manager.slot_count(); slot++) {
+            if (manager.chunk_in_slot(slot) != nullptr && manager.chunk_in_slot(slot)->cube == cube) {
+                return slot;
+            }
+        }
+        throw std::runtime_error("Error: The cube has no slot!");
+    };
+
+    // An edit inside a chunk only changes the slot of that chunk.
+    const std::size_t slot = slot_of(world->children()[5]);
+    world->children()[5]->set_type(Cube::Type::OCTANT);
+    world->children()[5]->children()[0]->set_type(Cube::Type::SOLID);
+    EXPECT_EQ(manager.update(camera_position), std::vector<std::size_t>{slot});
+    EXPECT_EQ(manager.chunk_in_slot(slot)->mesh.indices.size(), 36);
+
+    // A chunk without geometry releases its slot and gets one again once it has geometry.
+    world->children()[5]->set_type(Cube::Type::EMPTY);
+    EXPECT_EQ(manager.update(camera_position), std::vector<std::size_t>{slot});
+    EXPECT_EQ(manager.chunk_in_slot(slot), nullptr);
+    EXPECT_EQ(manager.memory_usage(), 7 * SOLID_CHUNK_MEMORY);
+    world->children()[5]->set_type(Cube::Type::SOLID);
+    EXPECT_EQ(manager.update(camera_position), std::vector<std::size_t>{slot});
+    EXPECT_EQ(slot_of(world->children()[5]), slot);
+
+    // An edit above the chunk level splits the world into chunks again.
+    world->set_type(Cube::Type::SOLID);
+    EXPECT_EQ(manager.update(camera_position).size(), 8);
+    EXPECT_EQ(manager.chunks().size(), 1);
+    ASSERT_NE(manager.chunk_in_slot(0), nullptr);
+    EXPECT_EQ(manager.chunk_in_slot(0)->cube, world);
+    EXPECT_EQ(manager.memory_usage(), SOLID_CHUNK_MEMORY);
+}
+
+TEST(ChunkManager, level_of_detail) {
+    const auto world = create_solid_world();
+    // An octant which is mostly empty, so it disappears if it is collapsed.
+    world->children()[2]->set_type(Cube::Type::OCTANT);
+    world->children()[2]->children()[0]->set_type(Cube::Type::SOLID);
+    ChunkManager manager({world}, {.chunk_level = 0, .load_distance = 100.0f, .lod_distances = {5.0f}});
+
+    EXPECT_EQ(manager.update({-1.0f, -1.0f, -1.0f}), std::vector<std::size_t>{0});
+    ASSERT_NE(manager.chunk_in_slot(0), nullptr);
+    EXPECT_EQ(manager.chunk_in_slot(0)->lod, 0);
+    const auto full_detail = manager.statistics();
+    EXPECT_EQ(full_detail.collapsed_octants, 0);
+
+    // Moving away from the world meshes it again with less detail.
+    EXPECT_EQ(manager.update({-20.0f, -1.0f, -1.0f}), std::vector<std::size_t>{0});
+    ASSERT_NE(manager.chunk_in_slot(0), nullptr);
+    EXPECT_EQ(manager.chunk_in_slot(0)->lod, 1);
+    EXPECT_EQ(manager.statistics().collapsed_octants, 1);
+    EXPECT_LT(manager.statistics().emitted_triangles, full_detail.emitted_triangles);
+    EXPECT_TRUE(manager.update({-20.0f, -1.0f, -1.0f}).empty());
+
+    // Coming back restores the full detail.
+    EXPECT_EQ(manager.update({-1.0f, -1.0f, -1.0f}), std::vector<std::size_t>{0});
+    EXPECT_EQ(manager.chunk_in_slot(0)->lod, 0);
+    EXPECT_EQ(manager.statistics().emitted_triangles, full_detail.emitted_triangles);
+}
+
+TEST(ChunkManager, culling) {
+    using inexor::vulkan_renderer::tools::Frustum;
+    const auto near_world = create_solid_world();
+    const auto far_world = create_solid_world({100.0f, 0.0f, 0.0f});
+    ChunkManager manager({near_world, far_world}, {.chunk_level = 1, .load_distance = 1000.0f});
+    const glm::vec3 camera_position{4.0f, 4.0f, -20.0f};
+    // Every update loads at most 8 chunks.
+    static_cast<void>(manager.update(camera_position));
+    static_cast<void>(manager.update(camera_position));
+
+    auto frustum = [&](const glm::vec3 &target, const float far_plane) {
+        return Frustum(glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, far_plane) *
+                       glm::lookAt(camera_position, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+    };
+
+    // The near world is completely inside of the frustum, so only the roots of the worlds are tested.
+    const auto all = manager.cull(frustum({4.0f, 4.0f, 4.0f}, 100.0f));
+    EXPECT_EQ(all.visible_chunks, 8);
+    EXPECT_EQ(all.culled_chunks, 8);
+    EXPECT_EQ(all.visible_triangles, 8 * 12);
+    EXPECT_EQ(all.tested_boxes, 2);
+    ASSERT_EQ(all.draw_ranges.size(), 8);
+    for (const auto &range : all.draw_ranges) {
+        ASSERT_NE(manager.chunk_in_slot(range.slot), nullptr);
+        EXPECT_EQ(manager.chunk_in_slot(range.slot)->world, 0);
+        EXPECT_EQ(range.first_index, 0);
+        EXPECT_EQ(range.index_count, 36);
+    }
+
+    // Looking past the near world, only the corner of the two children closest to the view direction is visible.
+    const auto corner = manager.cull(frustum({-16.0f, 4.0f, 4.0f}, 100.0f));
+    EXPECT_EQ(corner.visible_chunks, 2);
+    EXPECT_EQ(corner.culled_chunks, 14);
+    EXPECT_EQ(corner.tested_boxes, 10);
+    std::vector<std::shared_ptr<Cube>> visible_cubes;
+    for (const auto &range : corner.draw_ranges) {
+        visible_cubes.push_back(manager.chunk_in_slot(range.slot)->cube);
+    }
+    EXPECT_EQ(visible_cubes, (std::vector{near_world->children()[0], near_world->children()[2]}));
+
+    // Both worlds are beyond the far plane.
+    const auto none = manager.cull(frustum({4.0f, 4.0f, 4.0f}, 10.0f));
+    EXPECT_EQ(none.visible_chunks, 0);
+    EXPECT_EQ(none.culled_chunks, 16);
+    EXPECT_TRUE(none.draw_ranges.empty());
+}
+
+} // namespace
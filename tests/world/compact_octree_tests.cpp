@@ -0,0 +1,92 @@
+#include <inexor/vulkan-renderer/octree/collision_query.hpp>
+#include <inexor/vulkan-renderer/octree/compact_octree.hpp>
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+
+namespace {
+using namespace inexor::vulkan_renderer::octree;
+
+/// Flatten the polygon caches of a cube into one array.
+std::vector<Polygon> flatten(const std::vector<PolygonCache> &caches) {
+    std::vector<Polygon> polygons;
+    for (const auto &cache : caches) {
+        polygons.insert(polygons.end(), cache->begin(), cache->end());
+    }
+    return polygons;
+}
+
+/// Call a function for every cube together with the node of the compact octree which represents it.
+void for_each_node(const std::shared_ptr<Cube> &cube, const CompactOctree &octree, const CompactOctree::NodeIndex node,
+                   const std::function<void(const std::shared_ptr<Cube> &, CompactOctree::NodeIndex)> &func) {
+    func(cube, node);
+    if (cube->type() == Cube::Type::OCTANT) {
+        for (std::size_t idx = 0; idx < Cube::SUB_CUBES; idx++) {
+            for_each_node(cube->children()[idx], octree, octree.child(node, idx), func);
+        }
+    }
+}
+
+TEST(CompactOctree, conversion) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {1.0f, -2.0f, 3.0f}, 42);
+    const CompactOctree octree(*world);
+
+    EXPECT_EQ(octree.count_geometry_cubes(), world->count_geometry_cubes());
+    EXPECT_EQ(octree.position(), world->position());
+    EXPECT_EQ(octree.size(), world->size());
+    EXPECT_EQ(octree.polygons(), flatten(world->polygons(true)));
+
+    const std::shared_ptr<Cube> converted = octree.to_cube();
+    EXPECT_EQ(flatten(converted->polygons(true)), flatten(world->polygons(true)));
+
+    for_each_node(world, octree, CompactOctree::ROOT, [&](const std::shared_ptr<Cube> &cube, const auto node) {
+        EXPECT_EQ(octree.type(node), cube->type());
+        EXPECT_EQ(octree.bounding_box(node), cube->bounding_box());
+        if (cube->type() == Cube::Type::NORMAL) {
+            EXPECT_EQ(octree.indentations(node), cube->indentations());
+        }
+    });
+}
+
+TEST(CompactOctree, neighbor) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    const CompactOctree octree(*world);
+
+    constexpr std::array AXES{Cube::NeighborAxis::X, Cube::NeighborAxis::Y, Cube::NeighborAxis::Z};
+    constexpr std::array DIRECTIONS{Cube::NeighborDirection::POSITIVE, Cube::NeighborDirection::NEGATIVE};
+
+    for_each_node(world, octree, CompactOctree::ROOT, [&](const std::shared_ptr<Cube> &cube, const auto node) {
+        for (const auto axis : AXES) {
+            for (const auto direction : DIRECTIONS) {
+                const auto expected = cube->neighbor(axis, direction);
+                const auto neighbor = octree.neighbor(node, axis, direction);
+                if (expected == nullptr) {
+                    EXPECT_EQ(neighbor, CompactOctree::INVALID_NODE);
+                } else {
+                    ASSERT_NE(neighbor, CompactOctree::INVALID_NODE);
+                    EXPECT_EQ(octree.bounding_box(neighbor), expected->bounding_box());
+                }
+            }
+        }
+    });
+}
+
+TEST(CompactOctree, collision) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 60);
+    const CompactOctree octree(*world);
+
+    const glm::vec3 cam_pos{-2.0f, 1.1f, 1.3f};
+    for (const glm::vec3 cam_direction : {glm::vec3{1.0f, 0.1f, 0.2f}, glm::vec3{1.0f, 0.3f, 0.1f},
+                                          glm::vec3{1.0f, -0.5f, -0.5f}, glm::vec3{-1.0f, 0.1f, 0.2f}}) {
+        const auto expected = ray_cube_collision_check(*world, cam_pos, cam_direction);
+        const auto collision = ray_cube_collision_check(octree, cam_pos, cam_direction);
+        ASSERT_EQ(collision.has_value(), expected.has_value());
+        if (collision) {
+            EXPECT_EQ(octree.bounding_box(*collision), expected->cube().bounding_box());
+        }
+    }
+}
+
+} // namespace
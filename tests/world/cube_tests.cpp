@@ -1,10 +1,51 @@
 #include <inexor/vulkan-renderer/octree/cube.hpp>
 
+#include <glm/common.hpp>
 #include <gtest/gtest.h>
 
+#include <functional>
+
 namespace {
 using namespace inexor::vulkan_renderer::octree;
 
+TEST(LocationalCode, arithmetic) {
+    const LocationalCode root;
+    EXPECT_TRUE(root.is_root());
+    EXPECT_EQ(root.level(), 0);
+    EXPECT_EQ(root.parent(), root);
+
+    // The cube at the grid coordinates (x, y, z) = (1, 1, 2) of level 2.
+    const LocationalCode code = root.child(0b001).child(0b110);
+    EXPECT_EQ(code.value(), 0b1001110u);
+    EXPECT_EQ(code.level(), 2);
+    EXPECT_EQ(code.child_index(), 0b110);
+    EXPECT_EQ(code.child_index(1), 0b001);
+    EXPECT_EQ(code.parent(), root.child(0b001));
+    EXPECT_EQ(code.ancestor(0), root);
+
+    // The neighbors on the grid of level 2 with carries across levels.
+    EXPECT_EQ(code.neighbor(2, true), root.child(0b101).child(0b010));
+    EXPECT_EQ(code.neighbor(2, false), root.child(0b001).child(0b010));
+    EXPECT_EQ(code.neighbor(1, true), root.child(0b011).child(0b100));
+    EXPECT_EQ(code.neighbor(1, false), root.child(0b001).child(0b100));
+    EXPECT_EQ(code.neighbor(0, true), root.child(0b001).child(0b111));
+    EXPECT_EQ(code.neighbor(0, true)->neighbor(0, true), std::nullopt);
+    EXPECT_EQ(code.neighbor(0, false), root.child(0b000).child(0b111));
+    EXPECT_EQ(root.neighbor(0, true), std::nullopt);
+
+    EXPECT_EQ(LocationalCode::common_level(code, code), 2);
+    EXPECT_EQ(LocationalCode::common_level(code, root.child(0b001)), 1);
+    EXPECT_EQ(LocationalCode::common_level(code, *code.neighbor(2, true)), 0);
+
+    LocationalCode deepest;
+    for (std::size_t level = 0; level < LocationalCode::MAX_LEVEL; level++) {
+        deepest = deepest.child(7);
+    }
+    EXPECT_EQ(deepest.level(), LocationalCode::MAX_LEVEL);
+    EXPECT_EQ(deepest.neighbor(2, true), std::nullopt);
+    EXPECT_EQ(deepest.neighbor(2, false)->child_index(), 3);
+}
+
 TEST(Cube, neighbor) {
     std::shared_ptr<Cube> root = std::make_shared<Cube>(2.0f, glm::vec3{0, -1, -1});
     root->set_type(Cube::Type::OCTANT);
@@ -27,4 +68,199 @@ TEST(Cube, neighbor) {
               root->children()[0]->children()[3]);
 }
 
+TEST(Cube, locational_code) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    // Collapse some octants, so there are neighbors of different sizes.
+    world->children()[0]->set_type(Cube::Type::SOLID);
+    world->children()[5]->children()[3]->set_type(Cube::Type::EMPTY);
+
+    EXPECT_EQ(world->grid_level(), 0);
+    EXPECT_EQ(&world->root(), world.get());
+    EXPECT_EQ(world->find_neighbor(Cube::NeighborAxis::X, Cube::NeighborDirection::POSITIVE), nullptr);
+
+    constexpr std::array AXES{Cube::NeighborAxis::X, Cube::NeighborAxis::Y, Cube::NeighborAxis::Z};
+    constexpr std::array DIRECTIONS{Cube::NeighborDirection::POSITIVE, Cube::NeighborDirection::NEGATIVE};
+    auto contains = [](const std::array<glm::vec3, 2> &box, const glm::vec3 &point) {
+        return box[0].x < point.x && box[0].y < point.y && box[0].z < point.z && point.x < box[1].x &&
+               point.y < box[1].y && point.z < box[1].z;
+    };
+
+    std::function<void(const Cube &, std::size_t)> check = [&](const Cube &cube, const std::size_t level) {
+        EXPECT_EQ(cube.grid_level(), level);
+        EXPECT_EQ(&cube.root(), world.get());
+        EXPECT_EQ(cube.ancestor(0), world.get());
+        EXPECT_EQ(cube.ancestor(level), &cube);
+        EXPECT_EQ(cube.ancestor(level + 1), nullptr);
+        EXPECT_EQ(world->find(cube.locational_code()), &cube);
+
+        for (const auto axis : AXES) {
+            for (const auto direction : DIRECTIONS) {
+                // The neighbor is the smallest cube of at least the same size which contains a point just outside of
+                // the face.
+                glm::vec3 outside = cube.center();
+                const auto axis_index = 2 - static_cast<std::size_t>(axis);
+                const float offset = 0.5f * cube.size() + 0.01f;
+                outside[axis_index] += direction == Cube::NeighborDirection::POSITIVE ? offset : -offset;
+                const Cube *neighbor = cube.find_neighbor(axis, direction);
+                if (!contains(world->bounding_box(), outside)) {
+                    EXPECT_EQ(neighbor, nullptr);
+                    continue;
+                }
+                ASSERT_NE(neighbor, nullptr);
+                EXPECT_GE(neighbor->size(), cube.size());
+                EXPECT_TRUE(contains(neighbor->bounding_box(), outside));
+                EXPECT_TRUE(neighbor->type() != Cube::Type::OCTANT || neighbor->size() == cube.size());
+            }
+        }
+        if (cube.type() == Cube::Type::OCTANT) {
+            for (const auto &child : cube.children()) {
+                check(*child, level + 1);
+            }
+        }
+    };
+    check(*world, 0);
+
+    // A cube which outlives its parent becomes a root.
+    const std::shared_ptr<Cube> child = world->children()[7]->children()[1];
+    world->children()[7]->set_type(Cube::Type::EMPTY);
+    EXPECT_TRUE(child->is_root());
+    EXPECT_EQ(child->grid_level(), 0);
+    EXPECT_EQ(child->neighbor(Cube::NeighborAxis::Y, Cube::NeighborDirection::NEGATIVE), nullptr);
+}
+
+TEST(Cube, rotate_locational_code) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    const std::shared_ptr<Cube> moved = world->children()[0]->children()[0];
+    const std::vector<PolygonCache> polygons = world->polygons(true);
+    const std::size_t geometry_cubes = world->count_geometry_cubes();
+    world->rotate(Cube::RotationAxis::Y, 1);
+    world->children()[3]->rotate(Cube::RotationAxis::X, 2);
+    world->children()[5]->rotate(Cube::RotationAxis::Z, 3);
+
+    // Every cube has been moved to the position and locational code of the slot it has been rotated into.
+    std::function<void(const Cube &)> check = [&](const Cube &cube) {
+        EXPECT_EQ(world->find(cube.locational_code()), &cube);
+        if (cube.type() != Cube::Type::OCTANT) {
+            return;
+        }
+        for (std::uint8_t idx = 0; idx < Cube::SUB_CUBES; idx++) {
+            const Cube &child = *cube.children()[idx];
+            EXPECT_EQ(child.locational_code(), cube.locational_code().child(idx));
+            const glm::vec3 offset{static_cast<float>((idx >> 2) & 1u), static_cast<float>((idx >> 1) & 1u),
+                                   static_cast<float>(idx & 1u)};
+            EXPECT_EQ(child.position(), cube.position() + offset * (cube.size() / 2));
+            check(child);
+        }
+    };
+    check(*world);
+
+    EXPECT_NE(world->children()[0]->children()[0], moved);
+    const Cube *neighbor = moved->find_neighbor(Cube::NeighborAxis::X, Cube::NeighborDirection::POSITIVE);
+    ASSERT_NE(neighbor, nullptr);
+    EXPECT_EQ(neighbor->position().x, moved->position().x + moved->size());
+    EXPECT_EQ(neighbor->position().y, moved->position().y);
+    EXPECT_EQ(neighbor->position().z, moved->position().z);
+    EXPECT_EQ(moved->neighbor(Cube::NeighborAxis::X, Cube::NeighborDirection::POSITIVE).get(), neighbor);
+
+    // Rotating everything back restores the geometry.
+    EXPECT_EQ(world->count_geometry_cubes(), geometry_cubes);
+    EXPECT_NE(world->polygons(true), polygons);
+    world->children()[5]->rotate(Cube::RotationAxis::Z, 1);
+    world->children()[3]->rotate(Cube::RotationAxis::X, 2);
+    world->rotate(Cube::RotationAxis::Y, 3);
+    check(*world);
+    const std::vector<PolygonCache> rotated_back = world->polygons(true);
+    ASSERT_EQ(rotated_back.size(), polygons.size());
+    for (std::size_t idx = 0; idx < polygons.size(); idx++) {
+        EXPECT_EQ(*rotated_back[idx], *polygons[idx]);
+    }
+}
+
+TEST(Cube, parallel_polygons) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    const std::vector<PolygonCache> polygons = world->parallel_polygons(true, 1, 4);
+    EXPECT_EQ(polygons, world->polygons());
+    EXPECT_EQ(polygons.size(), world->count_geometry_cubes());
+
+    // Split deeper than the tree itself and with more threads than subtrees.
+    EXPECT_EQ(world->parallel_polygons(false, 8, 64), polygons);
+}
+
+TEST(Cube, dirty_tracking) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    // Creating the world subdivides the root, so the whole world is changed.
+    EXPECT_EQ(world->take_dirty_cubes(), std::vector<std::shared_ptr<Cube>>{world});
+    EXPECT_FALSE(world->is_dirty());
+    EXPECT_FALSE(world->dirty_bounds().has_value());
+    EXPECT_TRUE(world->take_dirty_cubes().empty());
+
+    const std::shared_ptr<Cube> first = world->children()[1]->children()[2]->children()[3];
+    const std::shared_ptr<Cube> second = world->children()[6]->children()[0]->children()[7];
+    second->set_type(second->type() == Cube::Type::SOLID ? Cube::Type::EMPTY : Cube::Type::SOLID);
+    first->set_type(Cube::Type::NORMAL);
+    first->indent(0, true, 2);
+    EXPECT_TRUE(world->is_dirty());
+    EXPECT_TRUE(world->children()[1]->is_dirty());
+    EXPECT_FALSE(world->children()[0]->is_dirty());
+
+    const std::array<glm::vec3, 2> expected_bounds{glm::min(first->bounding_box()[0], second->bounding_box()[0]),
+                                                   glm::max(first->bounding_box()[1], second->bounding_box()[1])};
+    EXPECT_EQ(world->dirty_bounds(), expected_bounds);
+    EXPECT_EQ(world->take_dirty_cubes(), (std::vector<std::shared_ptr<Cube>>{first, second}));
+    EXPECT_FALSE(world->children()[1]->is_dirty());
+
+    // If an octant itself is changed, its children are not returned separately.
+    const std::shared_ptr<Cube> octant = world->children()[4];
+    octant->children()[5]->children()[5]->set_type(Cube::Type::OCTANT);
+    octant->children()[5]->rotate(Cube::RotationAxis::X, 1);
+    EXPECT_EQ(world->take_dirty_cubes(), std::vector<std::shared_ptr<Cube>>{octant->children()[5]});
+}
+
+TEST(Cube, random_world) {
+    const std::shared_ptr<Cube> world = create_random_world(3, {0.0f, 0.0f, 0.0f}, 42, 1);
+    // The world does not depend on the number of threads which build it, and the polygons are equal as well.
+    const std::vector<PolygonCache> polygons = world->polygons(true);
+    const std::vector<PolygonCache> parallel_polygons =
+        create_random_world(3, {0.0f, 0.0f, 0.0f}, 42, 4)->polygons(true);
+    ASSERT_EQ(parallel_polygons.size(), polygons.size());
+    for (std::size_t idx = 0; idx < polygons.size(); idx++) {
+        EXPECT_EQ(*parallel_polygons[idx], *polygons[idx]);
+    }
+    EXPECT_NE(create_random_world(3, {0.0f, 0.0f, 0.0f}, 43)->count_geometry_cubes(), world->count_geometry_cubes());
+
+    // The leaves are generated from their locational code.
+    const Cube &leaf = *world->children()[5]->children()[1]->children()[7]->children()[2];
+    const RandomWorldCube expected = random_world_cube(42, leaf.locational_code());
+    EXPECT_EQ(leaf.type(), expected.type);
+    if (leaf.type() == Cube::Type::NORMAL) {
+        EXPECT_EQ(leaf.indentations(), expected.indentations);
+    }
+    EXPECT_EQ(world->take_dirty_cubes(), std::vector<std::shared_ptr<Cube>>{world});
+
+    EXPECT_THROW(static_cast<void>(create_random_world(LocationalCode::MAX_LEVEL, {0.0f, 0.0f, 0.0f}, 42)),
+                 std::invalid_argument);
+}
+
+TEST(Cube, clone) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    const std::vector<PolygonCache> polygons = world->polygons(true);
+    std::shared_ptr<Cube> clone = world->clone();
+    EXPECT_TRUE(clone->is_root());
+    EXPECT_EQ(clone->count_geometry_cubes(), world->count_geometry_cubes());
+    // The clone shares the polygon caches of the original.
+    EXPECT_EQ(clone->polygons(), polygons);
+
+    const std::shared_ptr<Cube> child = clone->children()[6]->children()[2];
+    EXPECT_EQ(child->locational_code(), LocationalCode().child(6).child(2));
+    EXPECT_EQ(&child->root(), clone.get());
+    EXPECT_EQ(clone->find(child->locational_code()), child.get());
+
+    // Changing the clone does not change the original, and the clone outlives its siblings.
+    child->set_type(Cube::Type::EMPTY);
+    EXPECT_EQ(world->polygons(), polygons);
+    clone.reset();
+    EXPECT_TRUE(child->is_root());
+    EXPECT_EQ(child->type(), Cube::Type::EMPTY);
+}
+
 } // namespace
@@ -0,0 +1,73 @@
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/indexed_mesh_builder.hpp>
+#include <inexor/vulkan-renderer/octree/mesh_extraction.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+using namespace inexor::vulkan_renderer::octree;
+
+/// Turn an indexed mesh back into a list of triangles.
+std::vector<Polygon> expand(const IndexedMesh &mesh) {
+    std::vector<Polygon> polygons;
+    for (std::size_t idx = 0; idx < mesh.indices.size(); idx += 3) {
+        polygons.push_back({{mesh.vertices[mesh.indices[idx]], mesh.vertices[mesh.indices[idx + 1]],
+                             mesh.vertices[mesh.indices[idx + 2]]}});
+    }
+    return polygons;
+}
+
+TEST(IndexedMeshBuilder, deduplication) {
+    IndexedMeshBuilder builder;
+    EXPECT_EQ(builder.add_vertex({0.0f, 1.0f, 2.0f}), 0);
+    EXPECT_EQ(builder.add_vertex({1.0f, 1.0f, 2.0f}), 1);
+    EXPECT_EQ(builder.add_vertex({0.0f, 1.0f, 2.0f}), 0);
+    EXPECT_EQ(builder.add_vertex({-0.0f, 1.0f, 2.0f}), 0);
+
+    // Two solid cubes next to each other share 4 corners.
+    const std::shared_ptr<Cube> world = std::make_shared<Cube>(2.0f, glm::vec3{0.0f, 0.0f, 0.0f});
+    world->set_type(Cube::Type::OCTANT);
+    world->children()[0]->set_type(Cube::Type::SOLID);
+    world->children()[4]->set_type(Cube::Type::SOLID);
+    builder.add_cube(*world);
+    EXPECT_EQ(builder.mesh().vertices.size(), 14);
+    EXPECT_EQ(builder.mesh().indices.size(), 72);
+
+    const IndexedMesh mesh = builder.build();
+    EXPECT_EQ(mesh.vertices.size(), 14);
+    EXPECT_TRUE(builder.mesh().vertices.empty());
+    EXPECT_TRUE(builder.mesh().indices.empty());
+    EXPECT_EQ(builder.add_vertex({1.0f, 1.0f, 2.0f}), 0);
+}
+
+TEST(IndexedMeshBuilder, extraction) {
+    const std::shared_ptr<Cube> world = create_random_world(3, {0.0f, 0.0f, 0.0f}, 42);
+    for (const bool merge_coplanar_faces : {false, true}) {
+        const MeshExtractionSettings settings{.merge_coplanar_faces = merge_coplanar_faces};
+        const OctreeMesh expected = extract_mesh(*world, settings);
+
+        IndexedMeshBuilder builder;
+        const MeshStatistics statistics = extract_mesh(*world, builder, settings);
+        const IndexedMesh mesh = builder.build();
+        EXPECT_EQ(statistics.emitted_triangles, expected.statistics.emitted_triangles);
+        EXPECT_EQ(expand(mesh), expected.polygons);
+        EXPECT_LT(mesh.vertices.size(), mesh.indices.size() / 4);
+    }
+}
+
+TEST(IndexedMeshBuilder, parallel_extraction) {
+    const std::shared_ptr<Cube> world = create_random_world(4, {0.0f, 0.0f, 0.0f}, 42);
+    for (const bool merge_coplanar_faces : {false, true}) {
+        IndexedMeshBuilder serial_builder;
+        extract_mesh(*world, serial_builder, {.merge_coplanar_faces = merge_coplanar_faces});
+        const IndexedMesh expected = serial_builder.build();
+
+        IndexedMeshBuilder builder;
+        extract_mesh(*world, builder, {.merge_coplanar_faces = merge_coplanar_faces, .thread_count = 3});
+        const IndexedMesh mesh = builder.build();
+        EXPECT_EQ(mesh.vertices, expected.vertices);
+        EXPECT_EQ(mesh.indices, expected.indices);
+    }
+}
+
+} // namespace
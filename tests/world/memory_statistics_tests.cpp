@@ -0,0 +1,56 @@
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/memory_statistics.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+using namespace inexor::vulkan_renderer::octree;
+
+TEST(MemoryStatistics, random_world) {
+    const std::shared_ptr<Cube> world = create_random_world(1, {0.0f, 0.0f, 0.0f}, 42);
+    const MemoryStatistics statistics = collect_memory_statistics(*world);
+    ASSERT_EQ(statistics.cubes_per_level.size(), 3);
+    EXPECT_EQ(statistics.cubes_per_level[0][static_cast<std::size_t>(Cube::Type::OCTANT)], 1);
+    EXPECT_EQ(statistics.cubes_per_level[1][static_cast<std::size_t>(Cube::Type::OCTANT)], 8);
+    EXPECT_EQ(statistics.cubes_per_level[2][static_cast<std::size_t>(Cube::Type::OCTANT)], 0);
+    EXPECT_EQ(statistics.cubes(), 1 + 8 + 64);
+    EXPECT_EQ(statistics.cubes_per_type[static_cast<std::size_t>(Cube::Type::OCTANT)], 9);
+
+    const std::size_t geometry_cubes = world->count_geometry_cubes();
+    const std::size_t normal_cubes = statistics.cubes_per_type[static_cast<std::size_t>(Cube::Type::NORMAL)];
+    EXPECT_EQ(statistics.cubes_per_type[static_cast<std::size_t>(Cube::Type::SOLID)] + normal_cubes, geometry_cubes);
+    EXPECT_GT(statistics.node_bytes, statistics.cubes() * sizeof(Cube));
+    EXPECT_EQ(statistics.unused_indentation_bytes,
+              statistics.indentation_bytes / statistics.cubes() * (statistics.cubes() - normal_cubes));
+    EXPECT_EQ(statistics.polygon_caches, 0);
+    EXPECT_EQ(statistics.invalid_polygon_caches, geometry_cubes);
+
+    // The caches which are returned by polygons() are owned by the caller as well, which must not change the result.
+    const std::vector<PolygonCache> polygons = world->polygons(true);
+    const MemoryStatistics cached = collect_memory_statistics(*world);
+    EXPECT_EQ(cached.polygon_caches, geometry_cubes);
+    EXPECT_EQ(cached.invalid_polygon_caches, 0);
+    EXPECT_GE(cached.polygon_cache_bytes, geometry_cubes * sizeof(Polygon));
+    EXPECT_EQ(cached.total_bytes(), cached.node_bytes + cached.polygon_cache_bytes);
+
+    // A clone shares the polygon caches, which are counted in full by both worlds.
+    const std::shared_ptr<Cube> clone = world->clone();
+    const MemoryStatistics shared = collect_memory_statistics(*world);
+    EXPECT_EQ(shared.polygon_cache_bytes, cached.polygon_cache_bytes);
+    const MemoryStatistics cloned = collect_memory_statistics(*clone);
+    EXPECT_EQ(cloned.polygon_cache_bytes, cached.polygon_cache_bytes);
+    EXPECT_GT(cloned.node_bytes, cloned.cubes() * sizeof(Cube));
+
+    // The block of a clone is freed once all of its cubes have been destroyed, so removing some keeps its memory.
+    (*clone)[0]->set_type(Cube::Type::SOLID);
+    const MemoryStatistics edited = collect_memory_statistics(*clone);
+    EXPECT_EQ(edited.cubes(), cloned.cubes() - Cube::SUB_CUBES);
+    EXPECT_EQ(edited.node_bytes, cloned.node_bytes);
+
+    MemoryStatistics both = shared;
+    both += cloned;
+    EXPECT_EQ(both.cubes(), 2 * statistics.cubes());
+    EXPECT_EQ(both.cubes_per_level[1], (std::array<std::size_t, CUBE_TYPE_COUNT>{0, 0, 0, 16}));
+}
+
+} // namespace
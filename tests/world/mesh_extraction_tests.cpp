@@ -0,0 +1,188 @@
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/mesh_extraction.hpp>
+
+#include <glm/geometric.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+using namespace inexor::vulkan_renderer::octree;
+
+TEST(MeshExtraction, without_culling) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    const OctreeMesh mesh = extract_mesh(*world, {.cull_hidden_faces = false});
+
+    std::vector<Polygon> expected;
+    for (const auto &polygons : world->polygons(true)) {
+        expected.insert(expected.end(), polygons->begin(), polygons->end());
+    }
+    EXPECT_EQ(mesh.polygons, expected);
+    EXPECT_EQ(mesh.statistics.geometry_cubes, world->count_geometry_cubes());
+    EXPECT_EQ(mesh.statistics.emitted_triangles, expected.size());
+    EXPECT_EQ(mesh.statistics.culled_triangles, 0);
+}
+
+TEST(MeshExtraction, hidden_face_culling) {
+    const std::shared_ptr<Cube> world = std::make_shared<Cube>(2.0f, glm::vec3{0.0f, 0.0f, 0.0f});
+    world->set_type(Cube::Type::OCTANT);
+
+    // Two solid cubes of the same size which share a face.
+    world->children()[0]->set_type(Cube::Type::SOLID);
+    world->children()[4]->set_type(Cube::Type::SOLID);
+    OctreeMesh mesh = extract_mesh(*world);
+    EXPECT_EQ(mesh.statistics.emitted_triangles, 20);
+    EXPECT_EQ(mesh.statistics.culled_triangles, 4);
+    EXPECT_EQ(mesh.polygons.size(), 20);
+
+    // A normal cube never hides a face, but its own flat faces can be hidden.
+    world->children()[0]->set_type(Cube::Type::NORMAL);
+    mesh = extract_mesh(*world);
+    EXPECT_EQ(mesh.statistics.culled_triangles, 2);
+
+    // If the face is indented it does not lie on the side of the cube anymore.
+    world->children()[0]->indent(0, false, 1);
+    mesh = extract_mesh(*world);
+    EXPECT_EQ(mesh.statistics.culled_triangles, 0);
+
+    // A larger solid neighbor hides the face of a smaller cube, but not the other way round.
+    world->children()[0]->set_type(Cube::Type::OCTANT);
+    world->children()[0]->children()[5]->set_type(Cube::Type::SOLID);
+    mesh = extract_mesh(*world);
+    EXPECT_EQ(mesh.statistics.emitted_triangles, 22);
+    EXPECT_EQ(mesh.statistics.culled_triangles, 2);
+}
+
+TEST(MeshExtraction, statistics) {
+    const std::shared_ptr<Cube> world = create_random_world(3, {0.0f, 0.0f, 0.0f}, 42);
+    const OctreeMesh mesh = extract_mesh(*world);
+    EXPECT_EQ(mesh.statistics.geometry_cubes, world->count_geometry_cubes());
+    EXPECT_EQ(mesh.statistics.emitted_triangles + mesh.statistics.culled_triangles,
+              Cube::EDGES * world->count_geometry_cubes());
+    EXPECT_EQ(mesh.polygons.size(), mesh.statistics.emitted_triangles);
+    EXPECT_GT(mesh.statistics.culled_triangles, 0);
+}
+
+TEST(MeshExtraction, face_merging) {
+    // A floor of 4 x 4 solid cubes.
+    const std::shared_ptr<Cube> world = std::make_shared<Cube>(4.0f, glm::vec3{1.0f, 2.0f, 3.0f});
+    world->set_type(Cube::Type::OCTANT);
+    for (const auto &child : world->children()) {
+        child->set_type(Cube::Type::OCTANT);
+    }
+    for (std::size_t x = 0; x < 4; x++) {
+        for (std::size_t z = 0; z < 4; z++) {
+            const std::size_t child_idx = ((x / 2) << 2u) | (z / 2);
+            const std::size_t grandchild_idx = ((x % 2) << 2u) | (z % 2);
+            world->children()[child_idx]->children()[grandchild_idx]->set_type(Cube::Type::SOLID);
+        }
+    }
+    const OctreeMesh unmerged = extract_mesh(*world);
+    EXPECT_EQ(unmerged.statistics.emitted_triangles, 96);
+
+    const OctreeMesh mesh = extract_mesh(*world, {.merge_coplanar_faces = true});
+    // Every side of the floor becomes one rectangle.
+    EXPECT_EQ(mesh.statistics.emitted_triangles, 12);
+    EXPECT_EQ(mesh.statistics.merged_triangles, 84);
+    ASSERT_EQ(mesh.polygons.size(), 12);
+
+    // The merged triangles cover the same area and keep the winding order of the unmerged ones.
+    auto total_area = [](const std::vector<Polygon> &polygons) {
+        glm::vec3 area{0.0f, 0.0f, 0.0f};
+        for (const auto &[a, b, c] : polygons) {
+            area += glm::cross(b - a, c - a) / 2.0f;
+        }
+        return area;
+    };
+    std::vector<Polygon> bottom;
+    std::vector<Polygon> merged_bottom;
+    for (const auto &polygon : unmerged.polygons) {
+        if (polygon[0].y == 2.0f && polygon[1].y == 2.0f && polygon[2].y == 2.0f) {
+            bottom.push_back(polygon);
+        }
+    }
+    for (const auto &polygon : mesh.polygons) {
+        if (polygon[0].y == 2.0f && polygon[1].y == 2.0f && polygon[2].y == 2.0f) {
+            merged_bottom.push_back(polygon);
+        }
+    }
+    EXPECT_EQ(merged_bottom.size(), 2);
+    EXPECT_EQ(total_area(merged_bottom), total_area(bottom));
+    EXPECT_EQ(total_area(bottom), glm::vec3(0.0f, 16.0f, 0.0f));
+}
+
+TEST(MeshExtraction, level_of_detail) {
+    const std::shared_ptr<Cube> world = std::make_shared<Cube>(2.0f, glm::vec3{0.0f, 0.0f, 0.0f});
+    world->set_type(Cube::Type::OCTANT);
+    world->children()[1]->set_type(Cube::Type::SOLID);
+    // An octant which is filled by 5/8 and one which is filled by 3.5/8, which contains a normal cube which is half
+    // indented.
+    world->children()[0]->set_type(Cube::Type::OCTANT);
+    world->children()[4]->set_type(Cube::Type::OCTANT);
+    for (const std::size_t idx : {0, 1, 2, 3, 4}) {
+        world->children()[0]->children()[idx]->set_type(Cube::Type::SOLID);
+    }
+    for (const std::size_t idx : {0, 1, 2}) {
+        world->children()[4]->children()[idx]->set_type(Cube::Type::SOLID);
+    }
+    const auto &normal = world->children()[4]->children()[3];
+    normal->set_type(Cube::Type::NORMAL);
+    for (const std::uint8_t edge : {0, 3, 6, 9}) {
+        normal->set_indent(edge, Indentation(0, Indentation::MAX / 2));
+    }
+
+    EXPECT_EQ(extract_mesh(*world).statistics.collapsed_octants, 0);
+
+    // The first octant becomes a solid cube, which hides the face of its solid neighbor and the other way round. The
+    // second octant is dropped.
+    const OctreeMesh mesh = extract_mesh(*world, {.max_depth = 1});
+    EXPECT_EQ(mesh.statistics.collapsed_octants, 2);
+    EXPECT_EQ(mesh.statistics.geometry_cubes, 2);
+    EXPECT_EQ(mesh.statistics.emitted_triangles, 20);
+    EXPECT_EQ(mesh.statistics.culled_triangles, 4);
+
+    // With a lower fill ratio both octants become solid cubes.
+    EXPECT_EQ(extract_mesh(*world, {.max_depth = 1, .solid_fill_ratio = 0.4f}).statistics.emitted_triangles, 28);
+    EXPECT_EQ(extract_mesh(*world, {.max_depth = 1, .solid_fill_ratio = 0.43f}).statistics.emitted_triangles, 28);
+    EXPECT_EQ(extract_mesh(*world, {.max_depth = 1, .solid_fill_ratio = 0.44f}).statistics.emitted_triangles, 20);
+
+    // The whole world collapses into one cube on level 0.
+    const auto random_world = create_random_world(3, {0.0f, 0.0f, 0.0f}, 42);
+    const OctreeMesh root = extract_mesh(*random_world, {.max_depth = 0, .solid_fill_ratio = 0.0f});
+    EXPECT_EQ(root.statistics.collapsed_octants, 1);
+    EXPECT_EQ(root.polygons.size(), 12);
+
+    // Every level of detail has at most as many triangles as the previous one.
+    std::size_t triangles = extract_mesh(*random_world).statistics.emitted_triangles;
+    EXPECT_LT(extract_mesh(*random_world, {.max_depth = 2}).statistics.emitted_triangles, triangles);
+    for (std::size_t max_depth = 3; max_depth-- > 0;) {
+        const auto lod_triangles = extract_mesh(*random_world, {.max_depth = max_depth}).statistics.emitted_triangles;
+        EXPECT_LE(lod_triangles, triangles) << "max depth " << max_depth;
+        triangles = lod_triangles;
+    }
+}
+
+TEST(MeshExtraction, parallel) {
+    const auto world = create_random_world(4, {0.0f, 0.0f, 0.0f}, 42);
+    for (const MeshExtractionSettings &settings : {
+             MeshExtractionSettings{.cull_hidden_faces = false},
+             MeshExtractionSettings{},
+             MeshExtractionSettings{.merge_coplanar_faces = true},
+             MeshExtractionSettings{.max_depth = 2},
+             MeshExtractionSettings{.max_depth = 1, .solid_fill_ratio = 0.3f},
+         }) {
+        const OctreeMesh expected = extract_mesh(*world, settings);
+        for (const std::size_t split_depth : {0, 1, 2, 3}) {
+            MeshExtractionSettings parallel_settings = settings;
+            parallel_settings.thread_count = 3;
+            parallel_settings.split_depth = split_depth;
+            const OctreeMesh mesh = extract_mesh(*world, parallel_settings);
+            EXPECT_EQ(mesh.polygons, expected.polygons) << "split depth " << split_depth;
+            EXPECT_EQ(mesh.statistics.emitted_triangles, expected.statistics.emitted_triangles);
+            EXPECT_EQ(mesh.statistics.culled_triangles, expected.statistics.culled_triangles);
+            EXPECT_EQ(mesh.statistics.merged_triangles, expected.statistics.merged_triangles);
+            EXPECT_EQ(mesh.statistics.collapsed_octants, expected.statistics.collapsed_octants);
+            EXPECT_EQ(mesh.statistics.geometry_cubes, expected.statistics.geometry_cubes);
+        }
+    }
+}
+
+} // namespace
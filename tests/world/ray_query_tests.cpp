@@ -0,0 +1,268 @@
+#include <inexor/vulkan-renderer/octree/compact_octree.hpp>
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/ray_query.hpp>
+
+#include <glm/geometric.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <random>
+#include <stdexcept>
+
+namespace {
+using namespace inexor::vulkan_renderer::octree;
+
+/// The ray parameter at which a ray enters a box, computed with the slab test.
+std::optional<float> ray_box_entry(const std::array<glm::vec3, 2> &box, const glm::vec3 &origin,
+                                   const glm::vec3 &direction) {
+    float t_min = 0.0f;
+    float t_max = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; axis++) {
+        if (direction[axis] == 0.0f) {
+            if (origin[axis] < box[0][axis] || origin[axis] > box[1][axis]) {
+                return std::nullopt;
+            }
+            continue;
+        }
+        const float t_near = (box[0][axis] - origin[axis]) / direction[axis];
+        const float t_far = (box[1][axis] - origin[axis]) / direction[axis];
+        t_min = std::max(t_min, std::min(t_near, t_far));
+        t_max = std::min(t_max, std::max(t_near, t_far));
+    }
+    if (t_min > t_max) {
+        return std::nullopt;
+    }
+    return t_min;
+}
+
+/// The ray parameter at which a ray hits a triangle, computed through the plane of the triangle.
+std::optional<float> ray_triangle_entry(const Polygon &triangle, const glm::vec3 &origin, const glm::vec3 &direction) {
+    const glm::vec3 normal = glm::cross(triangle[1] - triangle[0], triangle[2] - triangle[0]);
+    const float denominator = glm::dot(normal, direction);
+    if (denominator == 0.0f) {
+        return std::nullopt;
+    }
+    const float t = glm::dot(normal, triangle[0] - origin) / denominator;
+    if (t < 0.0f) {
+        return std::nullopt;
+    }
+    const glm::vec3 point = origin + t * direction;
+    for (std::size_t corner = 0; corner < 3; corner++) {
+        const glm::vec3 edge = triangle[(corner + 1) % 3] - triangle[corner];
+        if (glm::dot(glm::cross(edge, point - triangle[corner]), normal) < 0.0f) {
+            return std::nullopt;
+        }
+    }
+    return t;
+}
+
+/// Find the first hit by testing every solid cube and every triangle of the normal cubes.
+std::optional<float> brute_force_hit(const Cube &cube, const glm::vec3 &origin, const glm::vec3 &direction) {
+    if (cube.type() == Cube::Type::SOLID) {
+        return ray_box_entry(cube.bounding_box(), origin, direction);
+    }
+    std::optional<float> nearest;
+    if (cube.type() == Cube::Type::NORMAL) {
+        for (const auto &triangle : *cube.polygons(true).front()) {
+            const auto hit = ray_triangle_entry(triangle, origin, direction);
+            if (hit && (!nearest || *hit < *nearest)) {
+                nearest = hit;
+            }
+        }
+    }
+    if (cube.type() == Cube::Type::OCTANT) {
+        for (const auto &child : cube.children()) {
+            const auto hit = brute_force_hit(*child, origin, direction);
+            if (hit && (!nearest || *hit < *nearest)) {
+                nearest = hit;
+            }
+        }
+    }
+    return nearest;
+}
+
+TEST(RayQuery, first_hit) {
+    // Two solid cubes on the x axis, the ray must hit the one which it passes through first from either side.
+    Cube world(2.0f, {0.0f, 0.0f, 0.0f});
+    world.set_type(Cube::Type::OCTANT);
+    world.children()[0]->set_type(Cube::Type::SOLID);
+    world.children()[4]->set_type(Cube::Type::SOLID);
+    const RayQuery query(world);
+
+    const auto from_left = query.cast({-5.0f, 0.5f, 0.5f}, {1.0f, 0.0f, 0.0f});
+    ASSERT_TRUE(from_left);
+    EXPECT_EQ(from_left->cube, world.children()[0].get());
+    EXPECT_FLOAT_EQ(from_left->t, 5.0f);
+    EXPECT_EQ(from_left->normal, glm::vec3(-1.0f, 0.0f, 0.0f));
+    EXPECT_EQ(from_left->level, 1);
+
+    const auto from_right = query.cast({7.0f, 0.5f, 0.5f}, {-2.0f, 0.0f, 0.0f});
+    ASSERT_TRUE(from_right);
+    EXPECT_EQ(from_right->cube, world.children()[4].get());
+    EXPECT_FLOAT_EQ(from_right->t, 2.5f);
+    EXPECT_EQ(from_right->normal, glm::vec3(1.0f, 0.0f, 0.0f));
+
+    // The other children are empty.
+    EXPECT_FALSE(query.cast({0.5f, 5.0f, 1.5f}, {0.0f, -1.0f, 0.0f}));
+    EXPECT_FALSE(query.cast({-5.0f, 0.5f, 0.5f}, {-1.0f, 0.0f, 0.0f}));
+    EXPECT_FALSE(query.cast({-5.0f, 0.5f, 0.5f}, {0.0f, 0.0f, 0.0f}));
+    EXPECT_FALSE(query.cast({-5.0f, 0.5f, 0.5f}, {1.0f, 0.0f, 0.0f}, 4.0f));
+
+    // A ray which starts inside of a cube hits it immediately.
+    const auto inside = query.cast({0.5f, 0.5f, 0.5f}, {0.0f, 1.0f, 0.0f});
+    ASSERT_TRUE(inside);
+    EXPECT_EQ(inside->t, 0.0f);
+    EXPECT_EQ(inside->normal, glm::vec3(0.0f, 0.0f, 0.0f));
+
+    // Rays along the planes of the cubes belong to the cubes on the upper side of the planes.
+    const auto lower_edge = query.cast({0.0f, 0.0f, 10.0f}, {0.0f, 0.0f, -1.0f});
+    ASSERT_TRUE(lower_edge);
+    EXPECT_EQ(lower_edge->cube, world.children()[0].get());
+    const auto center_plane = query.cast({1.0f, 0.5f, 10.0f}, {0.0f, 0.0f, -1.0f});
+    ASSERT_TRUE(center_plane);
+    EXPECT_EQ(center_plane->cube, world.children()[4].get());
+    EXPECT_FALSE(query.cast({2.0f, 0.5f, 10.0f}, {0.0f, 0.0f, -1.0f}));
+}
+
+TEST(RayQuery, max_depth) {
+    Cube world(2.0f, {0.0f, 0.0f, 0.0f});
+    world.set_type(Cube::Type::OCTANT);
+    world.children()[0]->set_type(Cube::Type::OCTANT);
+    world.children()[0]->children()[7]->set_type(Cube::Type::SOLID);
+
+    const auto hit = RayQuery(world).cast({-5.0f, 0.75f, 0.75f}, {1.0f, 0.0f, 0.0f});
+    ASSERT_TRUE(hit);
+    EXPECT_EQ(hit->cube, world.children()[0]->children()[7].get());
+    EXPECT_FLOAT_EQ(hit->t, 5.5f);
+    EXPECT_EQ(hit->level, 2);
+
+    const auto limited = RayQuery(world, 1).cast({-5.0f, 0.75f, 0.75f}, {1.0f, 0.0f, 0.0f});
+    ASSERT_TRUE(limited);
+    EXPECT_EQ(limited->cube, world.children()[0].get());
+    EXPECT_FLOAT_EQ(limited->t, 5.0f);
+    EXPECT_EQ(limited->level, 1);
+}
+
+TEST(RayQuery, normal_cube) {
+    // The upper x side of a normal cube is indented by half of the cube, a ray must only hit the remaining geometry.
+    Cube world(2.0f, {0.0f, 0.0f, 0.0f});
+    world.set_type(Cube::Type::OCTANT);
+    const auto &normal_cube = world.children()[4];
+    normal_cube->set_type(Cube::Type::NORMAL);
+    for (const std::uint8_t edge : {0, 3, 6, 9}) {
+        normal_cube->set_indent(edge, Indentation(0, Indentation::MAX / 2));
+    }
+    world.children()[0]->set_type(Cube::Type::SOLID);
+    const CompactOctree compact_octree(world);
+
+    for (const auto &hit : {RayQuery(world).cast({5.0f, 0.5f, 0.5f}, {-1.0f, 0.0f, 0.0f}),
+                            RayQuery(compact_octree).cast({5.0f, 0.5f, 0.5f}, {-1.0f, 0.0f, 0.0f})}) {
+        ASSERT_TRUE(hit);
+        EXPECT_TRUE(hit->cube == normal_cube.get() || hit->node != CompactOctree::INVALID_NODE);
+        EXPECT_FLOAT_EQ(hit->t, 3.5f);
+        EXPECT_NEAR(hit->normal.x, 1.0f, 1e-6f);
+        EXPECT_NEAR(hit->normal.y, 0.0f, 1e-6f);
+        EXPECT_NEAR(hit->normal.z, 0.0f, 1e-6f);
+        EXPECT_EQ(hit->level, 1);
+    }
+
+    const auto top = RayQuery(world).cast({1.25f, 5.0f, 0.5f}, {0.0f, -1.0f, 0.0f});
+    ASSERT_TRUE(top);
+    EXPECT_EQ(top->cube, normal_cube.get());
+    EXPECT_FLOAT_EQ(top->t, 4.0f);
+    EXPECT_NEAR(top->normal.y, 1.0f, 1e-6f);
+
+    // The ray passes through the bounding box of the normal cube, but not through its geometry.
+    EXPECT_FALSE(RayQuery(world).cast({1.75f, 5.0f, 0.5f}, {0.0f, -1.0f, 0.0f}));
+    // Behind the indented part, the ray continues to the next cube.
+    const auto behind = RayQuery(world).cast({1.75f, 0.5f, 0.5f}, {-1.0f, 0.0f, 0.0f});
+    ASSERT_TRUE(behind);
+    EXPECT_EQ(behind->cube, normal_cube.get());
+    EXPECT_FLOAT_EQ(behind->t, 0.25f);
+    const auto through = RayQuery(world).cast({1.75f, 0.5f, 5.0f}, {-0.25f, 0.0f, -1.0f});
+    ASSERT_TRUE(through);
+    EXPECT_EQ(through->cube, world.children()[0].get());
+}
+
+TEST(RayQuery, random_rays) {
+    const auto world = create_random_world(3, {1.0f, -2.0f, 3.0f}, 42);
+    const RayQuery query(*world);
+    const glm::vec3 center = world->center();
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (std::size_t ray = 0; ray < 1000; ray++) {
+        // Rays from outside and inside of the world, which point roughly towards its center.
+        const glm::vec3 origin =
+            center + glm::vec3(distribution(generator), distribution(generator), distribution(generator)) *
+                         (ray % 2 == 0 ? 10.0f : 1.5f);
+        const glm::vec3 target =
+            center + glm::vec3(distribution(generator), distribution(generator), distribution(generator)) * 2.0f;
+        const glm::vec3 direction = target - origin;
+
+        const auto expected = brute_force_hit(*world, origin, direction);
+        const auto hit = query.cast(origin, direction);
+        ASSERT_EQ(hit.has_value(), expected.has_value()) << "ray " << ray;
+        if (hit) {
+            EXPECT_NEAR(hit->t, *expected, 1e-4f) << "ray " << ray;
+            EXPECT_NE(hit->cube->type(), Cube::Type::EMPTY);
+        }
+    }
+}
+
+TEST(RayQuery, batch) {
+    const auto world = create_random_world(3, {1.0f, -2.0f, 3.0f}, 42);
+    const CompactOctree compact_octree(*world);
+    const glm::vec3 center = world->center();
+
+    // The number of rays is not a multiple of the packet size, so some packets are only partially filled.
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    RayBatch rays;
+    for (std::size_t ray = 0; ray < 2003; ray++) {
+        const glm::vec3 origin =
+            center + glm::vec3(distribution(generator), distribution(generator), distribution(generator)) *
+                         (ray % 2 == 0 ? 10.0f : 1.5f);
+        const glm::vec3 target =
+            center + glm::vec3(distribution(generator), distribution(generator), distribution(generator)) * 2.0f;
+        rays.add(origin, target - origin);
+    }
+    // Rays along the axes and rays which miss the world.
+    rays.add(center - glm::vec3(10.0f, 0.0f, 0.0f), {1.0f, 0.0f, 0.0f});
+    rays.add(center + glm::vec3(0.0f, 10.0f, 0.0f), {0.0f, -1.0f, 0.0f});
+    rays.add(center + glm::vec3(0.0f, 10.0f, 0.0f), {0.0f, 1.0f, 0.0f});
+
+    for (const std::size_t thread_count : {std::size_t{1}, std::size_t{4}}) {
+        const RayQuery query(*world);
+        const RayQuery compact_query(compact_octree, 2);
+        const auto hits = query.cast(rays, 20.0f, thread_count);
+        const auto compact_hits = compact_query.cast(rays, 20.0f, thread_count);
+        ASSERT_EQ(hits.size(), rays.size());
+        ASSERT_EQ(compact_hits.size(), rays.size());
+        for (std::size_t ray = 0; ray < rays.size(); ray++) {
+            const glm::vec3 origin{rays.origin_x[ray], rays.origin_y[ray], rays.origin_z[ray]};
+            const glm::vec3 direction{rays.direction_x[ray], rays.direction_y[ray], rays.direction_z[ray]};
+            const auto expected = query.cast(origin, direction, 20.0f);
+            ASSERT_EQ(hits[ray].has_value(), expected.has_value()) << "ray " << ray;
+            if (expected) {
+                EXPECT_EQ(hits[ray]->cube, expected->cube) << "ray " << ray;
+                EXPECT_NEAR(hits[ray]->t, expected->t, 1e-4f) << "ray " << ray;
+                EXPECT_EQ(hits[ray]->normal, expected->normal) << "ray " << ray;
+                EXPECT_EQ(hits[ray]->level, expected->level) << "ray " << ray;
+            }
+            const auto compact_expected = compact_query.cast(origin, direction, 20.0f);
+            ASSERT_EQ(compact_hits[ray].has_value(), compact_expected.has_value()) << "ray " << ray;
+            if (compact_expected) {
+                EXPECT_EQ(compact_hits[ray]->node, compact_expected->node) << "ray " << ray;
+            }
+        }
+    }
+
+    EXPECT_TRUE(RayQuery(*world).cast(RayBatch{}).empty());
+    rays.direction_z.pop_back();
+    EXPECT_THROW((void)RayQuery(*world).cast(rays), std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,154 @@
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/shape_query.hpp>
+
+#include <glm/geometric.hpp>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <random>
+
+namespace {
+using namespace inexor::vulkan_renderer::octree;
+
+/// A solid cube in [0, 1]^3 and a normal cube in [1, 2] x [0, 1]^2 whose upper x side is indented by half, so its
+/// geometry is [1, 1.5] x [0, 1]^2.
+std::shared_ptr<Cube> create_world() {
+    auto world = std::make_shared<Cube>(2.0f, glm::vec3(0.0f, 0.0f, 0.0f));
+    world->set_type(Cube::Type::OCTANT);
+    world->children()[0]->set_type(Cube::Type::SOLID);
+    world->children()[4]->set_type(Cube::Type::NORMAL);
+    for (const std::uint8_t edge : {0, 3, 6, 9}) {
+        world->children()[4]->set_indent(edge, Indentation(0, Indentation::MAX / 2));
+    }
+    return world;
+}
+
+void expect_vec3_near(const glm::vec3 &actual, const glm::vec3 &expected) {
+    for (int axis = 0; axis < 3; axis++) {
+        EXPECT_NEAR(actual[axis], expected[axis], 1e-4f) << "axis " << axis;
+    }
+}
+
+TEST(ShapeQuery, overlap_box) {
+    const auto world = create_world();
+    const ShapeQuery query(*world);
+    std::array<ShapeContact, 4> contacts;
+
+    ASSERT_EQ(query.overlap_box({glm::vec3(0.8f, 0.2f, 0.2f), glm::vec3(1.2f, 0.4f, 0.4f)}, contacts), 2);
+    EXPECT_EQ(contacts[0].cube, world->children()[0].get());
+    expect_vec3_near(contacts[0].normal, {1.0f, 0.0f, 0.0f});
+    EXPECT_NEAR(contacts[0].depth, 0.2f, 1e-5f);
+    expect_vec3_near(contacts[0].point, {0.9f, 0.3f, 0.3f});
+    EXPECT_EQ(contacts[1].cube, world->children()[4].get());
+    expect_vec3_near(contacts[1].normal, {-1.0f, 0.0f, 0.0f});
+    EXPECT_NEAR(contacts[1].depth, 0.2f, 1e-5f);
+
+    // Contacts which do not fit are counted.
+    EXPECT_EQ(query.overlap_box({glm::vec3(0.8f, 0.2f, 0.2f), glm::vec3(1.2f, 0.4f, 0.4f)},
+                                std::span<ShapeContact>(contacts.data(), 1)),
+              2);
+
+    // The indented part of the normal cube is empty and boxes which only touch the geometry do not overlap it.
+    EXPECT_EQ(query.overlap_box({glm::vec3(1.6f, 0.2f, 0.2f), glm::vec3(1.9f, 0.4f, 0.4f)}, contacts), 0);
+    EXPECT_EQ(query.overlap_box({glm::vec3(1.5f, 0.2f, 0.2f), glm::vec3(1.9f, 0.4f, 0.4f)}, contacts), 0);
+    EXPECT_EQ(query.overlap_box({glm::vec3(0.2f, 1.0f, 0.2f), glm::vec3(0.4f, 1.5f, 0.4f)}, contacts), 0);
+}
+
+TEST(ShapeQuery, overlap_sphere) {
+    const auto world = create_world();
+    const ShapeQuery query(*world);
+    std::array<ShapeContact, 4> contacts;
+
+    // A sphere on top of the solid cube.
+    ASSERT_EQ(query.overlap_sphere({0.5f, 1.4f, 0.5f}, 0.5f, contacts), 1);
+    EXPECT_EQ(contacts[0].cube, world->children()[0].get());
+    expect_vec3_near(contacts[0].point, {0.5f, 1.0f, 0.5f});
+    expect_vec3_near(contacts[0].normal, {0.0f, 1.0f, 0.0f});
+    EXPECT_NEAR(contacts[0].depth, 0.1f, 1e-5f);
+    EXPECT_EQ(query.overlap_sphere({0.5f, 1.5f, 0.5f}, 0.5f, contacts), 0);
+
+    // Points inside of the solid cube are pushed out through the closest side.
+    ASSERT_EQ(query.overlap_sphere({0.5f, 0.5f, 0.1f}, 0.0f, contacts), 1);
+    expect_vec3_near(contacts[0].normal, {0.0f, 0.0f, -1.0f});
+    EXPECT_NEAR(contacts[0].depth, 0.1f, 1e-5f);
+
+    // The normal cube only collides with its indented geometry.
+    EXPECT_EQ(query.overlap_sphere({1.75f, 0.5f, 0.5f}, 0.0f, contacts), 0);
+    ASSERT_EQ(query.overlap_sphere({1.75f, 0.5f, 0.5f}, 0.3f, contacts), 1);
+    EXPECT_EQ(contacts[0].cube, world->children()[4].get());
+    expect_vec3_near(contacts[0].point, {1.5f, 0.5f, 0.5f});
+    expect_vec3_near(contacts[0].normal, {1.0f, 0.0f, 0.0f});
+    EXPECT_NEAR(contacts[0].depth, 0.05f, 1e-5f);
+    ASSERT_EQ(query.overlap_sphere({1.4f, 0.5f, 0.5f}, 0.0f, contacts), 1);
+    expect_vec3_near(contacts[0].normal, {1.0f, 0.0f, 0.0f});
+    EXPECT_NEAR(contacts[0].depth, 0.1f, 1e-5f);
+}
+
+TEST(ShapeQuery, sweep_sphere) {
+    const auto world = create_world();
+    const ShapeQuery query(*world);
+
+    // Falling onto the solid cube.
+    const auto fall = query.sweep_sphere({0.2f, 3.0f, 0.5f}, 0.5f, {0.0f, -3.0f, 0.0f});
+    ASSERT_TRUE(fall);
+    EXPECT_EQ(fall->cube, world->children()[0].get());
+    EXPECT_NEAR(fall->t, 0.5f, 1e-3f);
+    expect_vec3_near(fall->point, {0.2f, 1.0f, 0.5f});
+    expect_vec3_near(fall->normal, {0.0f, 1.0f, 0.0f});
+
+    // Moving into the indented side of the normal cube.
+    const auto wall = query.sweep_sphere({3.0f, 0.5f, 0.5f}, 0.25f, {-2.0f, 0.0f, 0.0f});
+    ASSERT_TRUE(wall);
+    EXPECT_EQ(wall->cube, world->children()[4].get());
+    EXPECT_NEAR(wall->t, 0.625f, 1e-3f);
+    expect_vec3_near(wall->normal, {1.0f, 0.0f, 0.0f});
+
+    // Sliding along the top of the cubes and moving away from them is not stopped.
+    EXPECT_FALSE(query.sweep_sphere({0.2f, 1.501f, 0.5f}, 0.5f, {1.0f, 0.0f, 0.0f}));
+    EXPECT_FALSE(query.sweep_sphere({0.2f, 1.501f, 0.5f}, 0.5f, {0.0f, 1.0f, 0.0f}));
+    EXPECT_FALSE(query.sweep_sphere(glm::vec3(0.2f, 3.0f, 0.5f) + fall->t * glm::vec3(0.0f, -3.0f, 0.0f), 0.5f,
+                                    {1.0f, 0.0f, 0.0f}));
+    EXPECT_FALSE(query.sweep_sphere({0.5f, 3.0f, 0.5f}, 0.5f, {0.0f, -1.0f, 0.0f}));
+    EXPECT_FALSE(query.sweep_sphere({0.5f, 3.0f, 0.5f}, 0.5f, {0.0f, 0.0f, 0.0f}));
+
+    // A capsule is tested by sweeping a sphere from one end to the other.
+    EXPECT_TRUE(query.sweep_sphere({1.75f, 0.5f, -1.0f}, 0.3f, {0.0f, 0.0f, 3.0f}));
+    EXPECT_FALSE(query.sweep_sphere({1.85f, 0.5f, -1.0f}, 0.3f, {0.0f, 0.0f, 3.0f}));
+}
+
+TEST(ShapeQuery, random_sweeps) {
+    const auto world = create_random_world(3, {0.0f, 0.0f, 0.0f}, 42);
+    const ShapeQuery query(*world);
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::array<ShapeContact, 64> contacts;
+
+    std::size_t hits = 0;
+    for (std::size_t sweep = 0; sweep < 200; sweep++) {
+        // Spheres from outside of the world, which move into it.
+        const glm::vec3 direction =
+            glm::normalize(glm::vec3(distribution(generator), distribution(generator), distribution(generator)));
+        const glm::vec3 center = world->center() - direction * 4.0f;
+        const float radius = 0.05f + 0.1f * (distribution(generator) + 1.0f);
+        const glm::vec3 motion = direction * 4.0f;
+        ASSERT_EQ(query.overlap_sphere(center, radius, contacts), 0);
+
+        // The sphere must never move into the geometry.
+        const auto hit = query.sweep_sphere(center, radius, motion);
+        const float t = hit ? hit->t : 1.0f;
+        EXPECT_EQ(query.overlap_sphere(center + t * motion, radius - 2.0f * ShapeQuery::SWEEP_TOLERANCE, contacts), 0)
+            << "sweep " << sweep;
+        if (hit) {
+            hits++;
+            EXPECT_NE(hit->cube->type(), Cube::Type::EMPTY);
+            EXPECT_NEAR(glm::length(center + t * motion - hit->point), radius, 2.0f * ShapeQuery::SWEEP_TOLERANCE)
+                << "sweep " << sweep;
+            EXPECT_LT(glm::dot(hit->normal, motion), 0.0f);
+        }
+    }
+    // Almost every sphere which moves to the center of the world hits something.
+    EXPECT_GT(hits, 150);
+}
+
+} // namespace
@@ -0,0 +1,37 @@
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/indexed_mesh_builder.hpp>
+#include <inexor/vulkan-renderer/octree/mesh_extraction.hpp>
+#include <inexor/vulkan-renderer/octree/vertex_quantization.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+namespace {
+using namespace inexor::vulkan_renderer::octree;
+
+TEST(VertexQuantization, lossless) {
+    const std::shared_ptr<Cube> world = create_random_world(3, {10.0f, -4.0f, 0.5f}, 42);
+    const QuantizationGrid grid = QuantizationGrid::from_octree(*world);
+    EXPECT_EQ(grid.origin(), world->position());
+    EXPECT_EQ(grid.step(), world->size() / 16 / Indentation::MAX);
+    EXPECT_TRUE(grid.fits(world->bounding_box()[0], world->bounding_box()[1]));
+
+    IndexedMeshBuilder builder;
+    static_cast<void>(extract_mesh(*world, builder));
+    for (const auto &vertex : builder.mesh().vertices) {
+        EXPECT_EQ(grid.dequantize(grid.quantize(vertex)), vertex);
+    }
+}
+
+TEST(VertexQuantization, range) {
+    const QuantizationGrid grid({1.0f, 2.0f, 3.0f}, 0.5f);
+    EXPECT_EQ(grid.quantize({1.0f, 2.5f, 4.0f}), (std::array<std::uint16_t, 3>{0, 1, 2}));
+    EXPECT_EQ(grid.quantize({1.0f, 2.0f, 3.0f + 0.5f * 65535}), (std::array<std::uint16_t, 3>{0, 0, 65535}));
+    EXPECT_THROW(static_cast<void>(grid.quantize({0.0f, 2.0f, 3.0f})), std::out_of_range);
+    EXPECT_THROW(static_cast<void>(grid.quantize({1.0f, 2.0f, 3.0f + 0.5f * 65536})), std::out_of_range);
+    EXPECT_FALSE(grid.fits({1.0f, 2.0f, 3.0f}, {1.0f, 2.0f, 40000.0f}));
+    EXPECT_THROW(QuantizationGrid({0.0f, 0.0f, 0.0f}, 0.0f), std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,192 @@
+#include <inexor/vulkan-renderer/octree/cube.hpp>
+#include <inexor/vulkan-renderer/octree/world_editor.hpp>
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace {
+using namespace inexor::vulkan_renderer::octree;
+
+/// The types and indentations of a cube and all of its children in pre-order.
+std::string describe(const Cube &cube) {
+    std::string description(1, static_cast<char>('0' + static_cast<int>(cube.type())));
+    if (cube.type() == Cube::Type::NORMAL) {
+        for (const auto &indentation : cube.indentations()) {
+            description += static_cast<char>('A' + indentation.uid());
+        }
+    } else if (cube.type() == Cube::Type::OCTANT) {
+        for (const auto &child : cube.children()) {
+            description += describe(*child);
+        }
+    }
+    return description;
+}
+
+TEST(WorldEditor, fill) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    static_cast<void>(world->take_dirty_cubes());
+    const std::string original = describe(*world);
+    const std::string outside = describe(*world->children()[0]->children()[4]->children()[1]);
+    WorldEditor editor(world);
+
+    // The box contains the octants 4 to 7 of the root and cuts through the octants 0 to 3.
+    const std::array<glm::vec3, 2> box{glm::vec3{1.3f, 0.0f, 0.0f}, glm::vec3{4.0f, 4.0f, 4.0f}};
+    const EditStatistics filled = editor.fill(box, 3, Cube::Type::SOLID);
+    EXPECT_GT(filled.written_cubes, 0);
+    EXPECT_GT(filled.journal_bytes, 0);
+    EXPECT_EQ(editor.journal_usage(), filled.journal_bytes);
+    for (std::size_t idx = 4; idx < Cube::SUB_CUBES; idx++) {
+        EXPECT_EQ(world->children()[idx]->type(), Cube::Type::SOLID);
+    }
+    // The cubes of the finest level are filled if their center is inside of the box.
+    const Cube *inside = world->find(LocationalCode().child(0).child(4).child(5));
+    EXPECT_EQ(inside->type(), Cube::Type::SOLID);
+    EXPECT_EQ(inside->size(), 0.5f);
+    EXPECT_EQ(describe(*world->children()[0]->children()[4]->children()[1]), outside);
+    EXPECT_EQ(world->take_dirty_cubes().size(), filled.dirty_cubes);
+
+    // Filling again does not change anything.
+    EXPECT_EQ(editor.fill(box, 3, Cube::Type::SOLID).written_cubes, 0);
+
+    const std::string edited = describe(*world);
+    ASSERT_TRUE(editor.can_undo());
+    const EditStatistics undone = editor.undo();
+    EXPECT_EQ(undone.collapsed_octants, 0);
+    EXPECT_EQ(describe(*world), original);
+    EXPECT_EQ(world->take_dirty_cubes().size(), undone.dirty_cubes);
+    EXPECT_FALSE(editor.can_undo());
+
+    ASSERT_TRUE(editor.can_redo());
+    static_cast<void>(editor.redo());
+    EXPECT_EQ(describe(*world), edited);
+    static_cast<void>(editor.undo());
+    EXPECT_EQ(describe(*world), original);
+
+    EXPECT_THROW(static_cast<void>(editor.fill({}, 3, Cube::Type::NORMAL)), std::invalid_argument);
+}
+
+TEST(WorldEditor, collapse) {
+    const auto world = std::make_shared<Cube>(2.0f, glm::vec3{0.0f, 0.0f, 0.0f});
+    world->set_type(Cube::Type::OCTANT);
+    world->children()[3]->set_type(Cube::Type::SOLID);
+    WorldEditor editor(world);
+
+    // Subdividing the solid cube and emptying one of its children keeps the other children solid.
+    const std::array<CubeEdit, 1> carve{{{LocationalCode().child(3).child(6), Cube::Type::EMPTY}}};
+    static_cast<void>(editor.apply(carve));
+    ASSERT_EQ(world->children()[3]->type(), Cube::Type::OCTANT);
+    EXPECT_EQ(world->children()[3]->children()[6]->type(), Cube::Type::EMPTY);
+    EXPECT_EQ(world->children()[3]->children()[7]->type(), Cube::Type::SOLID);
+
+    // Emptying the rest of the solid cube collapses the whole world into a single empty cube.
+    CubeEdit normal{LocationalCode().child(3).child(0), Cube::Type::NORMAL};
+    normal.indentations[0] = Indentation(1, 7);
+    const std::array<CubeEdit, 2> clear{{normal, {LocationalCode().child(3), Cube::Type::EMPTY}}};
+    const EditStatistics cleared = editor.apply(clear);
+    EXPECT_EQ(world->type(), Cube::Type::EMPTY);
+    EXPECT_EQ(cleared.collapsed_octants, 1);
+    EXPECT_EQ(cleared.dirty_cubes, 1);
+
+    static_cast<void>(editor.undo());
+    ASSERT_EQ(world->type(), Cube::Type::OCTANT);
+    EXPECT_EQ(world->children()[3]->children()[6]->type(), Cube::Type::EMPTY);
+    EXPECT_EQ(world->children()[3]->children()[0]->type(), Cube::Type::SOLID);
+    static_cast<void>(editor.undo());
+    EXPECT_EQ(world->children()[3]->type(), Cube::Type::SOLID);
+
+    const std::array<CubeEdit, 1> octant{{{LocationalCode(), Cube::Type::OCTANT}}};
+    EXPECT_THROW(static_cast<void>(editor.apply(octant)), std::invalid_argument);
+}
+
+TEST(WorldEditor, paste) {
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    const std::string original = describe(*world);
+    WorldEditor editor(world);
+
+    const std::shared_ptr<Cube> source = create_random_world(1, {0.0f, 0.0f, 0.0f}, 7);
+    static_cast<void>(editor.paste(*source, LocationalCode().child(5)));
+    EXPECT_EQ(describe(*world->children()[5]), describe(*source));
+    EXPECT_EQ(world->children()[5]->children()[2]->size(), 1.0f);
+
+    static_cast<void>(editor.paste(*world->children()[0], LocationalCode().child(1)));
+    EXPECT_EQ(describe(*world->children()[1]), describe(*world->children()[0]));
+    static_cast<void>(editor.undo());
+    static_cast<void>(editor.undo());
+    EXPECT_EQ(describe(*world), original);
+
+    // A batch which exceeds the journal budget cannot be undone.
+    WorldEditor small_editor(world, 16);
+    static_cast<void>(small_editor.paste(*source, LocationalCode().child(5)));
+    EXPECT_FALSE(small_editor.can_undo());
+    EXPECT_EQ(small_editor.journal_usage(), 0);
+}
+
+TEST(WorldEditor, journal_budget) {
+    const std::array<glm::vec3, 2> box{glm::vec3{0.0f, 0.0f, 0.0f}, glm::vec3{2.0f, 2.0f, 2.0f}};
+    const std::shared_ptr<Cube> source = create_random_world(2, {0.0f, 0.0f, 0.0f}, 7);
+    const LocationalCode target = LocationalCode().child(0);
+    auto edit = [&](WorldEditor &editor) {
+        const std::size_t fill_bytes = editor.fill(box, 1, Cube::Type::SOLID).journal_bytes;
+        const std::size_t paste_bytes = editor.paste(*source, target).journal_bytes;
+        return std::array{fill_bytes, paste_bytes};
+    };
+
+    // Replacing the detailed octant with a solid cube and pasting detailed geometry into it fits into the budget.
+    const std::shared_ptr<Cube> world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    WorldEditor editor(world, std::numeric_limits<std::size_t>::max());
+    const auto [fill_bytes, paste_bytes] = edit(editor);
+    const std::string edited = describe(*world);
+    const std::size_t undo_paste_bytes = editor.undo().journal_bytes;
+    ASSERT_GT(undo_paste_bytes, fill_bytes + paste_bytes);
+
+    // Undoing the paste journals the pasted geometry, which does not fit next to the detailed octant which has been
+    // replaced by the fill, so the fill cannot be undone anymore.
+    const std::shared_ptr<Cube> budget_world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+    WorldEditor budget_editor(budget_world, undo_paste_bytes);
+    edit(budget_editor);
+    EXPECT_EQ(budget_editor.journal_usage(), fill_bytes + paste_bytes);
+    static_cast<void>(budget_editor.undo());
+    EXPECT_FALSE(budget_editor.can_undo());
+    EXPECT_EQ(budget_editor.journal_usage(), undo_paste_bytes);
+    static_cast<void>(budget_editor.redo());
+    EXPECT_TRUE(budget_editor.can_undo());
+    EXPECT_EQ(budget_editor.journal_usage(), paste_bytes);
+    EXPECT_EQ(describe(*budget_world), edited);
+
+    // The journal never exceeds its budget, whichever records have to be dropped for it.
+    for (std::size_t budget = 0; budget <= fill_bytes + undo_paste_bytes; budget += 7) {
+        const std::shared_ptr<Cube> small_world = create_random_world(2, {0.0f, 0.0f, 0.0f}, 42);
+        WorldEditor small_editor(small_world, budget);
+        edit(small_editor);
+        EXPECT_LE(small_editor.journal_usage(), budget);
+        for (auto step : {&WorldEditor::undo, &WorldEditor::undo, &WorldEditor::redo, &WorldEditor::redo}) {
+            static_cast<void>((small_editor.*step)());
+            EXPECT_LE(small_editor.journal_usage(), budget);
+        }
+    }
+}
+
+TEST(WorldEditor, paste_too_deep) {
+    const std::shared_ptr<Cube> world = create_random_world(1, {0.0f, 0.0f, 0.0f}, 42);
+    const std::string original = describe(*world);
+    WorldEditor editor(world);
+    LocationalCode target;
+    while (target.level() + 1 < LocationalCode::MAX_LEVEL) {
+        target = target.child(3);
+    }
+    // The source has two levels of octants, so its leaves would be below the maximum level.
+    const std::shared_ptr<Cube> source = create_random_world(1, {0.0f, 0.0f, 0.0f}, 7);
+    EXPECT_THROW(static_cast<void>(editor.paste(*source, target)), std::invalid_argument);
+    EXPECT_EQ(describe(*world), original);
+    EXPECT_FALSE(editor.can_undo());
+
+    const std::shared_ptr<Cube> leaf = create_random_world(0, {0.0f, 0.0f, 0.0f}, 7)->children()[0];
+    ASSERT_NE(leaf->type(), Cube::Type::OCTANT);
+    static_cast<void>(editor.paste(*leaf, target.child(0)));
+    EXPECT_TRUE(editor.can_undo());
+}
+
+} // namespace